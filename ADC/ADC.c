@@ -9,42 +9,178 @@
  */
 
 #include "adc.h"
+#include "adc_cal.h"
+#include "adc_filter.h"
+#include "config.h" /* FCY */
+#include "irq.h"
+#include "critical.h"
 #include <xc.h>    /* registros específicos del dispositivo (XC16) */
 
-/* Ajustes por defecto: puedes cambiarlos según necesidades */
-#define ADC_SAMPLE_TIME    4   /* SAMC (Tad cycles) */
-#define ADC_ADCS           4   /* ADCS => Tad = (ADCS+1) * Tcy */
+/* Límites de temporización (datasheet dsPIC33FJ32MC204, parámetros AD) */
+#define ADC_TAD_MIN_NS_12BIT   118u  /* Tad mínimo 117.6 ns en 12-bit      */
+#define ADC_TAD_MIN_NS_10BIT    76u  /* Tad mínimo 76 ns en 10-bit         */
+#define ADC_CONV_TAD_12BIT      14u  /* conversión = 14 Tad en 12-bit      */
+#define ADC_CONV_TAD_10BIT      12u  /* conversión = 12 Tad en 10-bit      */
+#define ADC_SAMC_MIN_12BIT       3u  /* muestreo mínimo 3 Tad en 12-bit    */
+#define ADC_SAMC_MIN_10BIT       2u  /* muestreo mínimo 2 Tad en 10-bit    */
+#define ADC_ADCS_MAX            63u
+#define ADC_SAMC_MAX            31u
+
+/* Modelo RC del sample&hold: Rs + Ric + Rss cargando Chold */
+#define ADC_CHOLD_PF            18u
+#define ADC_RIC_OHMS           250u
+#define ADC_RSS_OHMS          3000u
+#define ADC_LN2_MILLI          693u  /* ln(2) * 1000 */
+
+/* Ciclos aproximados por vuelta de los bucles de espera acotada */
+#define ADC_WAIT_LOOP_CYCLES     8u
+#define ADC_WAIT_MIN_US         10u
 
 /* Internals */
 static volatile uint16_t adc_last_result = 0;
+static ADC_Timing_t adc_timing;
+static ADC_Mode_t adc_mode = (ADC_RESOLUTION_BITS == 10u) ? ADC_MODE_10BIT : ADC_MODE_12BIT;
+static uint16_t adc_max_value = (ADC_RESOLUTION_BITS == 10u) ? ADC_MAX_VALUE_10BIT : ADC_MAX_VALUE_12BIT;
+static ADC_Callback_t adc_callback = 0;
+static uint8_t adc_channels[ADC_SIM_CHANNELS]; /* ANx de CH0..CH3 (para calibración) */
+static uint8_t adc_block_len = 1;              /* resultados por interrupción (SMPI+1) */
 
-/* Inicializa ADC (modo manual: SAMP controla muestreo, luego SAMP=0 lanza conversión) */
-void ADC_Init(void)
+/* Propiedad del conversor (API de peticiones) */
+static volatile ADC_Handle_t adc_owner = ADC_HANDLE_NONE;  /* dueño actual     */
+static ADC_Handle_t adc_handle_gen = ADC_HANDLE_NONE;      /* último emitido   */
+static ADC_Handle_t adc_legacy_handle = ADC_HANDLE_NONE;   /* API sin handle   */
+static volatile bool adc_trigger_active = false;           /* PWM / Timer3     */
+static volatile ADC_Status_t adc_last_error = ADC_OK;
+static volatile uint16_t adc_overruns = 0;
+
+/* Registra qué ANx llega a cada S&H: CH0 = ch0, CH1..CH3 = AN0..2 / AN3..5 */
+static void adc_set_channels(uint8_t ch0, ADC_Ch123_t group)
+{
+    uint8_t base = (group == ADC_CH123_AN3_AN5) ? 3u : 0u;
+    adc_channels[0] = ch0;
+    adc_channels[1] = base;
+    adc_channels[2] = base + 1u;
+    adc_channels[3] = base + 2u;
+}
+
+/* Calcula ADCS/SAMC mínimos (ver adc.h) */
+bool ADC_ComputeTiming(uint32_t fcy, uint8_t res_bits, uint32_t source_ohms, ADC_Timing_t *t)
 {
+    uint32_t fcy_khz = fcy / 1000UL;
+    uint32_t tad_min_ns, samc_min, conv_tad;
+    uint32_t tau_ns, tacq_ns, adcs, samc, tad_ns;
+    bool ok = true;
+
+    if (t == 0 || fcy_khz == 0) return false;
+
+    if (res_bits <= 10u) {
+        res_bits   = 10u;
+        tad_min_ns = ADC_TAD_MIN_NS_10BIT;
+        samc_min   = ADC_SAMC_MIN_10BIT;
+        conv_tad   = ADC_CONV_TAD_10BIT;
+    } else {
+        res_bits   = 12u;
+        tad_min_ns = ADC_TAD_MIN_NS_12BIT;
+        samc_min   = ADC_SAMC_MIN_12BIT;
+        conv_tad   = ADC_CONV_TAD_12BIT;
+    }
+
+    /* Tiempo de adquisición para asentar a 1/2 LSB: tau * ln(2^(N+1)).
+       ohm * pF = ps -> se pasa a ns redondeando hacia arriba. */
+    if (source_ohms > 1000000UL) source_ohms = 1000000UL;
+    tau_ns  = ((source_ohms + ADC_RIC_OHMS + ADC_RSS_OHMS) * ADC_CHOLD_PF + 999UL) / 1000UL;
+    tacq_ns = (tau_ns * ((uint32_t)(res_bits + 1u) * ADC_LN2_MILLI) + 999UL) / 1000UL;
+
+    /* Tad más pequeño legal: (ADCS+1) * Tcy >= Tad_min */
+    adcs = (tad_min_ns * fcy_khz + 999999UL) / 1000000UL;
+    adcs = (adcs > 0u) ? adcs - 1u : 0u;
+
+    for (;;) {
+        tad_ns = ((adcs + 1u) * 1000000UL + fcy_khz - 1u) / fcy_khz;
+        samc = (tacq_ns + tad_ns - 1u) / tad_ns;
+        if (samc < samc_min) samc = samc_min;
+        if (samc <= ADC_SAMC_MAX) break;
+        /* La adquisición no cabe en 31 Tad: alargar Tad */
+        if (adcs >= ADC_ADCS_MAX) {
+            samc = ADC_SAMC_MAX;
+            ok = false;
+            break;
+        }
+        adcs++;
+    }
+
+    if (adcs > ADC_ADCS_MAX) {
+        adcs = ADC_ADCS_MAX;
+        tad_ns = ((adcs + 1u) * 1000000UL + fcy_khz - 1u) / fcy_khz;
+        ok = false;
+    }
+
+    t->adcs        = (uint8_t)adcs;
+    t->samc        = (uint8_t)samc;
+    t->tad_ns      = (uint16_t)tad_ns;
+    t->tsamp_ns    = samc * tad_ns;
+    t->sample_rate = fcy / ((adcs + 1u) * (samc + conv_tad));
+    return ok;
+}
+
+void ADC_GetTiming(ADC_Timing_t *t)
+{
+    if (t) *t = adc_timing;
+}
+
+/* Programa el ADC para 'adc_mode' (ADC apagado durante la configuración) */
+static bool adc_configure(void)
+{
+    uint8_t bits = (adc_mode == ADC_MODE_12BIT) ? 12u : 10u;
+    bool ok = ADC_ComputeTiming(FCY, bits, ADC_SOURCE_IMPEDANCE_OHMS, &adc_timing);
+
+    /* Reconfigurar invalida cualquier petición en curso */
+    adc_owner = ADC_HANDLE_NONE;
+    adc_trigger_active = false;
+
+    adc_max_value = (bits == 12u) ? ADC_MAX_VALUE_12BIT : ADC_MAX_VALUE_10BIT;
+
+    /* En SIM4 se convierten 4 canales por secuencia (12 Tad cada uno) */
+    if (adc_mode == ADC_MODE_10BIT_SIM4) {
+        adc_timing.sample_rate = FCY / ((uint32_t)(adc_timing.adcs + 1u) *
+                                 (adc_timing.samc + ADC_SIM_CHANNELS * ADC_CONV_TAD_10BIT));
+    }
+
     /* Apagar ADC mientras configuramos */
     #ifdef AD1CON1
     AD1CON1bits.ADON = 0;
     #endif
 
-    /* AD1CON1: FORM=00 Integer, SSRC=000 manual, ASAM=0 */
+    /* AD1CON1: FORM=00 Integer, SSRC=111 auto-convert, ASAM=0 */
     #ifdef AD1CON1
     AD1CON1 = 0;
+    AD1CON1bits.AD12B = (bits == 12u) ? 1 : 0;
     AD1CON1bits.FORM = 0;   /* Integer */
-    AD1CON1bits.SSRC = 0;   /* Conversion triggered by SAMP->0 */
+    AD1CON1bits.SSRC = 7;   /* El contador SAMC termina el muestreo y convierte */
     AD1CON1bits.ASAM = 0;   /* Auto sampling disabled */
+    AD1CON1bits.SIMSAM = (adc_mode == ADC_MODE_10BIT_SIM4) ? 1 : 0;
     #endif
 
-    /* AD1CON2: SMPI = 0 -> interrupt at every sample (no scanning) */
+    /* AD1CON2: CHPS = canales convertidos por secuencia.
+       SMPI cuenta secuencias de muestreo/conversión (no conversiones): con
+       SMPI=0 AD1IF salta al terminar cada secuencia, también en SIM4 donde
+       una secuencia escribe CH0..CH3 en ADC1BUF0..3 */
     #ifdef AD1CON2
     AD1CON2 = 0;
-    AD1CON2bits.SMPI = 0;
+    if (adc_mode == ADC_MODE_10BIT_SIM4) {
+        AD1CON2bits.CHPS = 2;                       /* CH0..CH3 */
+        AD1CON2bits.SMPI = 0;
+    } else {
+        AD1CON2bits.CHPS = 0;                       /* solo CH0 */
+        AD1CON2bits.SMPI = 0;
+    }
     #endif
 
     /* AD1CON3: SAMC, ADCS */
     #ifdef AD1CON3
     AD1CON3 = 0;
-    AD1CON3bits.SAMC = ADC_SAMPLE_TIME; /* tiempo de sample en Tad */
-    AD1CON3bits.ADCS = ADC_ADCS;        /* Tad = (ADCS+1)*Tcy */
+    AD1CON3bits.SAMC = adc_timing.samc; /* tiempo de sample en Tad */
+    AD1CON3bits.ADCS = adc_timing.adcs; /* Tad = (ADCS+1)*Tcy */
     #endif
 
     /* AD1CHS0: seleccionar canal por defecto AN0 (si existe) */
@@ -52,58 +188,235 @@ void ADC_Init(void)
     AD1CHS0 = 0;
     #endif
 
+    /* AD1CHS123: CH1..CH3 = AN0..AN2, entrada negativa Vref- */
+    #ifdef AD1CHS123
+    AD1CHS123 = 0;
+    #endif
+
     /* Vaciar buffer si existe */
     #ifdef ADC1BUF0
     volatile uint16_t tmp = ADC1BUF0;
     (void)tmp;
     #endif
 
+    #ifdef IFS0bits
+    IFS0bits.AD1IF = 0;
+    #endif
+
     /* Encender ADC */
     #ifdef AD1CON1
     AD1CON1bits.ADON = 1;
     #endif
+
+    return ok;
 }
 
-/* Inicia muestreo y conversión en el canal 'channel' (ANx). No bloqueante. */
-void ADC_StartSingle(uint8_t channel)
+/* Inicializa ADC (SAMP=1 inicia muestreo; tras SAMC Tad arranca la conversión) */
+void ADC_Init(void)
+{
+    adc_mode = (ADC_RESOLUTION_BITS == 10u) ? ADC_MODE_10BIT : ADC_MODE_12BIT;
+    (void)adc_configure();
+}
+
+/* Cambia el modo de operación en tiempo de ejecución */
+bool ADC_SetMode(ADC_Mode_t mode)
+{
+    if (mode > ADC_MODE_10BIT_SIM4) return false;
+    adc_mode = mode;
+    return adc_configure();
+}
+
+ADC_Mode_t ADC_GetMode(void)
+{
+    return adc_mode;
+}
+
+uint8_t ADC_GetResolutionBits(void)
+{
+    return (adc_mode == ADC_MODE_12BIT) ? 12u : 10u;
+}
+
+uint16_t ADC_GetMaxValue(void)
+{
+    return adc_max_value;
+}
+
+/* Reserva el conversor: ADC_OK y handle nuevo, o BUSY / INVALID */
+static ADC_Status_t adc_claim(ADC_Handle_t *handle)
 {
+    ADC_Handle_t h;
+    CRIT_State_t crit;
+
+    /* Sección corta: DISI en lugar de subir el IPL */
+    crit = CRIT_DisiEnter();
+    if (adc_trigger_active) {
+        CRIT_DisiExit(crit);
+        return ADC_ERR_INVALID;
+    }
+    if (adc_owner != ADC_HANDLE_NONE) {
+        CRIT_DisiExit(crit);
+        return ADC_ERR_BUSY;
+    }
+    h = (ADC_Handle_t)(adc_handle_gen + 1u);
+    if (h == ADC_HANDLE_NONE) h = 1u;
+    adc_handle_gen = h;
+    adc_owner = h;
+    CRIT_DisiExit(crit);
+
+    *handle = h;
+    return ADC_OK;
+}
+
+/* Libera el conversor si 'h' es el dueño */
+static void adc_release(ADC_Handle_t h)
+{
+    CRIT_State_t crit = CRIT_DisiEnter();
+    if (h != ADC_HANDLE_NONE && adc_owner == h) adc_owner = ADC_HANDLE_NONE;
+    CRIT_DisiExit(crit);
+}
+
+/* Vueltas de espera equivalentes a 'timeout_us' */
+static uint32_t adc_spins(uint32_t timeout_us)
+{
+    return (uint32_t)(((uint64_t)FCY * timeout_us) / (1000000ULL * ADC_WAIT_LOOP_CYCLES)) + 1u;
+}
+
+/* Timeout por defecto: 4 veces la secuencia esperada (muestreo + conversión) */
+static uint32_t adc_default_timeout_us(void)
+{
+    uint32_t t = (adc_timing.sample_rate > 0u) ? (4000000UL / adc_timing.sample_rate) : 0u;
+    return (t < ADC_WAIT_MIN_US) ? ADC_WAIT_MIN_US : t;
+}
+
+/* Lanza muestreo + conversión de CH0 sobre 'channel' */
+static void adc_start_conversion(uint8_t channel)
+{
+    adc_channels[0] = channel;
+
     /* Selecciona canal positivo (CH0SA) si existe */
     #ifdef AD1CHS0
     AD1CHS0bits.CH0SA = channel; /* asigna AN channel al MUX + */
     #endif
 
-    /* Empezar muestreo */
+    /* Empezar muestreo: el hardware convierte tras SAMC Tad (SSRC=111),
+       sin espera por software */
     #ifdef AD1CON1
+    AD1CON1bits.DONE = 0;
     AD1CON1bits.SAMP = 1;
     #endif
+}
+
+/* Lee ADC1BUF0 (enmascarado y calibrado) */
+static uint16_t adc_read_result(void)
+{
+    uint16_t r = 0;
+    #ifdef ADC1BUF0
+    r = ADC1BUF0;
+    #endif
+    r &= adc_max_value;
+    if (ADC_Cal_IsEnabled()) ADC_Cal_ApplyBlock(adc_channels[0], &r, 1u);
+    adc_last_result = r;
+    return r;
+}
+
+/* ------------------------------------------------------------------------- */
+/* API de peticiones con handle                                               */
+/* ------------------------------------------------------------------------- */
+
+ADC_Status_t ADC_Request(uint8_t channel, ADC_Handle_t *handle)
+{
+    ADC_Status_t st;
 
-    /* pequeña espera para adquisición */
-    for (volatile int i = 0; i < 60; ++i) { __builtin_nop(); }
+    if (handle == 0) return ADC_ERR_INVALID;
+    *handle = ADC_HANDLE_NONE;
+
+    st = adc_claim(handle);
+    if (st != ADC_OK) {
+        adc_last_error = st;
+        return st;
+    }
+    adc_start_conversion(channel);
+    return ADC_OK;
+}
+
+ADC_Status_t ADC_Poll(ADC_Handle_t handle, uint16_t *result)
+{
+    if (handle == ADC_HANDLE_NONE || handle != adc_owner) return ADC_ERR_INVALID;
 
-    /* Parar muestreo -> comienza conversión */
     #ifdef AD1CON1
-    AD1CON1bits.SAMP = 0;
+    if (!AD1CON1bits.DONE) return ADC_PENDING;
     #endif
+
+    if (result) *result = adc_read_result();
+    else (void)adc_read_result();
+    adc_release(handle);
+    return ADC_OK;
 }
 
-/* Espera a que la conversión termine y devuelve el resultado (bloqueante) */
-uint16_t ADC_ReadSingleBlocking(uint8_t channel)
+ADC_Status_t ADC_Wait(ADC_Handle_t handle, uint16_t *result, uint32_t timeout_us)
 {
-    ADC_StartSingle(channel);
+    uint32_t spins = adc_spins(timeout_us);
+    ADC_Status_t st;
 
-    /* Esperar DONE */
+    do {
+        st = ADC_Poll(handle, result);
+        if (st != ADC_PENDING) return st;
+    } while (--spins);
+
+    /* DONE no llegó: abortar y liberar en lugar de colgarse */
+    ADC_Cancel(handle);
+    adc_last_error = ADC_ERR_TIMEOUT;
+    return ADC_ERR_TIMEOUT;
+}
+
+void ADC_Cancel(ADC_Handle_t handle)
+{
+    if (handle == ADC_HANDLE_NONE || handle != adc_owner) return;
     #ifdef AD1CON1
-    while (!AD1CON1bits.DONE) { /* espera activa */ }
+    AD1CON1bits.SAMP = 0;
     #endif
+    adc_release(handle);
+}
 
-    /* Leer buffer */
-    uint16_t r = 0;
-    #ifdef ADC1BUF0
-    r = ADC1BUF0;
-    #endif
+ADC_Status_t ADC_GetLastError(void)
+{
+    ADC_Status_t st = adc_last_error;
+    adc_last_error = ADC_OK;
+    return st;
+}
 
-    adc_last_result = r & ADC_MAX_VALUE;
-    return adc_last_result;
+uint16_t ADC_GetOverrunCount(void)
+{
+    return adc_overruns;
+}
+
+/* ------------------------------------------------------------------------- */
+/* API sin handle (usa un handle interno)                                     */
+/* ------------------------------------------------------------------------- */
+
+/* Inicia muestreo y conversión en el canal 'channel' (ANx). No bloqueante.
+   Si el conversor está ocupado no hace nada (ver ADC_GetLastError). */
+void ADC_StartSingle(uint8_t channel)
+{
+    /* Una petición anterior sin recoger se descarta */
+    ADC_Cancel(adc_legacy_handle);
+    (void)ADC_Request(channel, &adc_legacy_handle);
+}
+
+/* Espera (acotada) a que la conversión termine y deja el resultado en
+   'result'. Devuelve ADC_ERR_BUSY / ADC_ERR_INVALID si no pudo reservar el
+   conversor o ADC_ERR_TIMEOUT; en ese caso 'result' no se modifica. */
+ADC_Status_t ADC_ReadSingleBlocking(uint8_t channel, uint16_t *result)
+{
+    ADC_Handle_t h;
+    ADC_Status_t st;
+    uint16_t r;
+
+    st = ADC_Request(channel, &h);
+    if (st != ADC_OK) return st;
+    st = ADC_Wait(h, &r, adc_default_timeout_us());
+    if (st == ADC_OK && result) *result = r;
+    return st;
 }
 
 /* Indica si la conversión actual terminó */
@@ -116,13 +429,263 @@ bool ADC_IsConversionDone(void)
     #endif
 }
 
-/* Devuelve el resultado del último muestreo (raw value) */
+/* Devuelve el resultado de la última conversión iniciada con ADC_StartSingle
+   (o el último resultado conocido si aún no terminó) */
 uint16_t ADC_GetResult(void)
 {
-    uint16_t r = 0;
+    uint16_t r;
+    if (ADC_Poll(adc_legacy_handle, &r) == ADC_OK) return r;
+    return adc_last_result;
+}
+
+/* Inicia muestreo simultáneo de CH0..CH3. No bloqueante. */
+void ADC_StartSimultaneous(uint8_t ch0_channel, ADC_Ch123_t group)
+{
+    ADC_Cancel(adc_legacy_handle);
+    if (adc_claim(&adc_legacy_handle) != ADC_OK) {
+        adc_last_error = ADC_ERR_BUSY;
+        return;
+    }
+
+    adc_set_channels(ch0_channel, group);
+
+    #ifdef AD1CHS0
+    AD1CHS0bits.CH0SA = ch0_channel;
+    #endif
+    #ifdef AD1CHS123
+    AD1CHS123bits.CH123SA = (uint8_t)group;
+    #endif
+
+    /* AD1IF se activa al terminar la secuencia (SMPI=0): CH0..CH3 convertidos */
+    #ifdef IFS0bits
+    IFS0bits.AD1IF = 0;
+    #endif
+    #ifdef AD1CON1
+    AD1CON1bits.DONE = 0;
+    AD1CON1bits.SAMP = 1;
+    #endif
+}
+
+/* Copia CH0..CH3 (ADC1BUF0..3) si la secuencia terminó */
+bool ADC_GetSimultaneous(uint16_t out[ADC_SIM_CHANNELS])
+{
+    if (adc_legacy_handle == ADC_HANDLE_NONE || adc_legacy_handle != adc_owner) return false;
+
+    #ifdef IFS0bits
+    if (!IFS0bits.AD1IF) return false;
+    IFS0bits.AD1IF = 0;
+    #endif
+
     #ifdef ADC1BUF0
-    r = ADC1BUF0;
+    out[0] = ADC1BUF0 & adc_max_value;
+    out[1] = ADC1BUF1 & adc_max_value;
+    out[2] = ADC1BUF2 & adc_max_value;
+    out[3] = ADC1BUF3 & adc_max_value;
+    #else
+    out[0] = out[1] = out[2] = out[3] = 0;
     #endif
-    adc_last_result = r & ADC_MAX_VALUE;
-    return adc_last_result;
-}
\ No newline at end of file
+    if (ADC_Cal_IsEnabled()) ADC_Cal_ApplyInterleaved(adc_channels, ADC_SIM_CHANNELS, out, ADC_SIM_CHANNELS);
+    adc_last_result = out[0];
+    adc_release(adc_legacy_handle);
+    return true;
+}
+
+/* Muestreo simultáneo con espera acotada */
+ADC_Status_t ADC_ReadSimultaneousBlocking(uint8_t ch0_channel, ADC_Ch123_t group, uint16_t out[ADC_SIM_CHANNELS])
+{
+    uint32_t spins = adc_spins(adc_default_timeout_us());
+
+    ADC_StartSimultaneous(ch0_channel, group);
+    if (adc_legacy_handle != adc_owner) return ADC_ERR_BUSY;
+
+    do {
+        if (ADC_GetSimultaneous(out)) return ADC_OK;
+    } while (--spins);
+
+    ADC_Cancel(adc_legacy_handle);
+    adc_last_error = ADC_ERR_TIMEOUT;
+    return ADC_ERR_TIMEOUT;
+}
+
+/* Conversión disparada por el evento especial del MCPWM */
+void ADC_EnablePwmTrigger(uint8_t ch0_channel, ADC_Ch123_t group, ADC_Callback_t callback)
+{
+    /* El disparo por hardware toma el conversor: las peticiones en curso
+       quedan invalidadas y las nuevas devuelven ADC_ERR_INVALID */
+    adc_owner = ADC_HANDLE_NONE;
+    adc_trigger_active = true;
+    adc_callback = callback;
+    adc_set_channels(ch0_channel, group);
+
+    #ifdef AD1CON1
+    AD1CON1bits.ADON = 0;
+    #endif
+
+    #ifdef AD1CHS0
+    AD1CHS0bits.CH0SA = ch0_channel;
+    #endif
+    #ifdef AD1CHS123
+    AD1CHS123bits.CH123SA = (uint8_t)group;
+    #else
+    (void)group;
+    #endif
+
+    /* SSRC=011: SEVTCMP termina el muestreo y lanza la conversión.
+       ASAM=1: el muestreo se reanuda solo tras cada conversión. */
+    #ifdef AD1CON1
+    AD1CON1bits.SSRC = 3;
+    AD1CON1bits.ASAM = 1;
+    #endif
+
+    /* Una interrupción por evento: SMPI=0 también en SIM4 (SMPI cuenta
+       secuencias, no conversiones) */
+    #ifdef AD1CON2
+    AD1CON2bits.SMPI = 0;
+    #endif
+    adc_block_len = (adc_mode == ADC_MODE_10BIT_SIM4) ? ADC_SIM_CHANNELS : 1u;
+
+    #ifdef IFS0bits
+    IFS0bits.AD1IF = 0;
+    IRQ_SetPriority(IRQ_SRC_AD1);
+    IEC0bits.AD1IE = (callback != 0) ? 1 : 0;
+    #endif
+
+    #ifdef AD1CON1
+    AD1CON1bits.ADON = 1;
+    #endif
+}
+
+/* Vuelve al modo de conversión por software */
+void ADC_DisablePwmTrigger(void)
+{
+    #ifdef IEC0bits
+    IEC0bits.AD1IE = 0;
+    #endif
+    adc_callback = 0;
+    adc_block_len = 1;
+    (void)adc_configure();
+}
+
+/* Conversión periódica disparada por Timer3 en bloques de ADC_BLOCK_LEN */
+bool ADC_EnableTimerTrigger(uint8_t ch0_channel, uint32_t period_us, ADC_Callback_t callback)
+{
+    static const uint16_t prescalers[4] = { 1u, 8u, 64u, 256u };
+    uint32_t ticks = 0;
+    uint8_t tckps;
+
+    /* Cuentas de Tcy por muestra; prescaler más pequeño que cabe en PR3 */
+    for (tckps = 0; tckps < 4u; tckps++) {
+        ticks = (uint32_t)(((uint64_t)FCY * period_us) / (1000000ULL * prescalers[tckps]));
+        if (ticks <= 0x10000UL) break;
+    }
+    if (tckps == 4u || ticks < 2u) return false;
+
+    adc_owner = ADC_HANDLE_NONE;
+    adc_trigger_active = true;
+    adc_callback = callback;
+    adc_set_channels(ch0_channel, ADC_CH123_AN0_AN2);
+
+    #ifdef AD1CON1
+    AD1CON1bits.ADON = 0;
+    #endif
+
+    #ifdef T3CON
+    T3CON = 0;
+    T3CONbits.TCKPS = tckps;
+    TMR3 = 0;
+    PR3 = (uint16_t)(ticks - 1u);
+    #endif
+
+    #ifdef AD1CHS0
+    AD1CHS0bits.CH0SA = ch0_channel;
+    #endif
+    #ifdef AD1CHS123
+    AD1CHS123bits.CH123SA = 0;
+    #endif
+
+    /* SSRC=010: el periodo de Timer3 termina el muestreo; ASAM=1.
+       SMPI cuenta secuencias: SMPI+1 secuencias llenan ADC1BUF0..F.
+       Solo CH0: 16 secuencias de 1 conversión (SMPI=15).
+       ADC_MODE_10BIT_SIM4: 4 secuencias CH0..CH3 de 4 conversiones (SMPI=3). */
+    #ifdef AD1CON1
+    AD1CON1bits.SSRC = 2;
+    AD1CON1bits.ASAM = 1;
+    #endif
+    #ifdef AD1CON2
+    AD1CON2bits.SMPI = (adc_mode == ADC_MODE_10BIT_SIM4)
+                       ? (ADC_BLOCK_LEN / ADC_SIM_CHANNELS) - 1u
+                       : ADC_BLOCK_LEN - 1u;
+    #endif
+    adc_block_len = ADC_BLOCK_LEN;
+
+    #ifdef IFS0bits
+    IFS0bits.AD1IF = 0;
+    IRQ_SetPriority(IRQ_SRC_AD1);
+    IEC0bits.AD1IE = (callback != 0) ? 1 : 0;
+    #endif
+
+    #ifdef AD1CON1
+    AD1CON1bits.ADON = 1;
+    #endif
+    #ifdef T3CON
+    T3CONbits.TON = 1;
+    #endif
+
+    return true;
+}
+
+void ADC_DisableTimerTrigger(void)
+{
+    #ifdef T3CON
+    T3CONbits.TON = 0;
+    #endif
+    ADC_DisablePwmTrigger();
+}
+
+/* Handler de interrupción: entrega el bloque convertido al callback */
+void ADC_ISR_Handler(void)
+{
+    uint16_t results[ADC_BLOCK_LEN];
+    uint8_t count = adc_block_len;
+    uint8_t seq = (adc_mode == ADC_MODE_10BIT_SIM4) ? ADC_SIM_CHANNELS : 1u;
+    uint8_t i;
+
+    /* ADC1BUF0..ADC1BUFF son registros consecutivos */
+    #ifdef ADC1BUF0
+    volatile uint16_t *buf = &ADC1BUF0;
+    for (i = 0; i < count; i++) {
+        results[i] = buf[i] & adc_max_value;
+    }
+    #else
+    for (i = 0; i < count; i++) {
+        results[i] = 0;
+    }
+    #endif
+
+    #ifdef IFS0bits
+    IFS0bits.AD1IF = 0;
+    #endif
+
+    /* Corrección de offset/ganancia una vez por bloque, antes del consumidor:
+       un recorrido por canal (paso 'seq' en SIM4) */
+    if (ADC_Cal_IsEnabled()) {
+        ADC_Cal_ApplyInterleaved(adc_channels, seq, results, count);
+    }
+
+    /* Filtros por canal (adc_filter.h); los canales sin slot no cambian */
+    for (i = 0; i < seq; i++) {
+        ADC_Filt_Process(adc_channels[i], &results[i], (uint16_t)(count / seq), seq);
+    }
+
+    adc_last_result = results[0];
+    if (adc_callback) adc_callback(results, count);
+
+    /* Si el siguiente bloque ya terminó mientras se procesaba éste, el
+       hardware está sobrescribiendo ADC1BUFx: overrun */
+    #ifdef IFS0bits
+    if (IFS0bits.AD1IF) {
+        adc_overruns++;
+        adc_last_error = ADC_ERR_OVERRUN;
+    }
+    #endif
+}
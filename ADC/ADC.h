@@ -5,14 +5,27 @@
  *
  * API:
  *   void ADC_Init(void);
- *   uint16_t ADC_ReadSingleBlocking(uint8_t channel); // bloqueante, devuelve resultado (0..4095 si 12-bit)
+ *   ADC_Status_t ADC_ReadSingleBlocking(ch, &result); // espera acotada; OK / BUSY / TIMEOUT
  *   void ADC_StartSingle(uint8_t channel);           // inicia conversión (no bloqueante)
  *   bool ADC_IsConversionDone(void);                 // comprueba si terminó
  *   uint16_t ADC_GetResult(void);                    // devuelve resultado del último muestreo
+ *   ADC_Status_t ADC_Request(ch, &handle);           // reserva el conversor y lanza una conversión
+ *   ADC_Status_t ADC_Poll(handle, &result);          // PENDING / OK (libera) / error
+ *   ADC_Status_t ADC_Wait(handle, &result, us);      // espera acotada; TIMEOUT libera el conversor
+ *   bool ADC_ComputeTiming(fcy, bits, ohms, &t);     // calcula ADCS/SAMC mínimos legales
+ *   void ADC_GetTiming(ADC_Timing_t *t);             // temporización aplicada por ADC_Init
+ *   bool ADC_SetMode(ADC_Mode_t mode);               // 12-bit / 10-bit / 10-bit CH0..CH3 simultáneo
+ *   void ADC_StartSimultaneous(ch0, group);          // muestreo simultáneo CH0..CH3 (no bloqueante)
+ *   bool ADC_GetSimultaneous(uint16_t out[4]);       // resultados CH0..CH3 si terminó
+ *   void ADC_EnablePwmTrigger(ch0, group, cb);       // conversión disparada por SEVTCMP del MCPWM
+ *   bool ADC_EnableTimerTrigger(ch0, period_us, cb); // muestreo periódico por Timer3, bloques de 16
+ *   void ADC_ISR_Handler(void);                      // llamar desde _ADC1Interrupt
  *
  * Nota:
  * - Configura los pines como analógicos (ANx) en tu main antes de usar el ADC.
- * - Ajusta AD1CON3.ADCS y AD1CON3.SAMC en adc.c para tiempos de adquisición/Tad
+ * - AD1CON3.ADCS y AD1CON3.SAMC se calculan en ADC_Init a partir de FCY
+ *   (config.h), la resolución y ADC_SOURCE_IMPEDANCE_OHMS. Define esta
+ *   macro en el proyecto con la impedancia real de tu fuente.
  */
 
 #ifndef ADC_H
@@ -25,19 +38,126 @@
 extern "C" {
 #endif
 
+/* Resultado de las operaciones del ADC */
+typedef enum {
+    ADC_OK = 0,
+    ADC_PENDING,        /* conversión en curso                                */
+    ADC_ERR_BUSY,       /* conversor reservado por otra petición              */
+    ADC_ERR_TIMEOUT,    /* DONE no llegó en el tiempo pedido (petición abortada) */
+    ADC_ERR_OVERRUN,    /* un bloque disparado por hardware se sobrescribió    */
+    ADC_ERR_INVALID     /* handle caducado/ajeno o conversor en modo disparo   */
+} ADC_Status_t;
+
+/* Identifica al dueño de una conversión en curso (0 = ninguno) */
+typedef uint8_t ADC_Handle_t;
+#define ADC_HANDLE_NONE 0u
+
+/* Impedancia de la fuente conectada a ANx (ohmios). Un potenciómetro de 10k
+   en su punto medio presenta ~2.5k; ajusta según tu hardware. */
+#ifndef ADC_SOURCE_IMPEDANCE_OHMS
+#define ADC_SOURCE_IMPEDANCE_OHMS 2500u
+#endif
+
+/* Modos de operación. En 12-bit el dsPIC33F solo dispone del S&H de CH0;
+   en 10-bit se pueden muestrear CH0..CH3 en el mismo instante (SIMSAM) */
+typedef enum {
+    ADC_MODE_12BIT = 0,     /* 12-bit, solo CH0 (AD12B=1)                 */
+    ADC_MODE_10BIT,         /* 10-bit, solo CH0 (hasta 1.1 Msps)          */
+    ADC_MODE_10BIT_SIM4     /* 10-bit, CH0..CH3 muestreo simultáneo        */
+} ADC_Mode_t;
+
+/* Entradas de CH1..CH3 (AD1CHS123.CH123SA) */
+typedef enum {
+    ADC_CH123_AN0_AN2 = 0,  /* CH1=AN0, CH2=AN1, CH3=AN2 */
+    ADC_CH123_AN3_AN5 = 1   /* CH1=AN3, CH2=AN4, CH3=AN5 */
+} ADC_Ch123_t;
+
+#define ADC_SIM_CHANNELS 4u
+#define ADC_BLOCK_LEN    16u  /* ADC1BUF0..ADC1BUFF */
+
+/* Callback con los resultados de una secuencia o bloque disparado por
+   hardware (1 resultado en modo CH0, 4 en ADC_MODE_10BIT_SIM4, ADC_BLOCK_LEN
+   con disparo por Timer3), ya calibrados (adc_cal.h) y filtrados
+   (adc_filter.h). Se ejecuta en la ISR. */
+typedef void (*ADC_Callback_t)(const uint16_t *results, uint8_t count);
+
+/* Resultado del cálculo de temporización (AD1CON3) */
+typedef struct {
+    uint8_t  adcs;         /* AD1CON3.ADCS: Tad = (ADCS+1) * Tcy          */
+    uint8_t  samc;         /* AD1CON3.SAMC: muestreo en Tad               */
+    uint16_t tad_ns;       /* Tad resultante (ns)                         */
+    uint32_t tsamp_ns;     /* tiempo de muestreo resultante (ns)          */
+    uint32_t sample_rate;  /* secuencias/s con SAMC + conversión (todos los canales) */
+} ADC_Timing_t;
+
 void ADC_Init(void);
 
-/* Lee un canal (ANx) de forma bloqueante. 'channel' es el número AN (e.g., 0 para AN0, 1 para AN1, ...). */
-uint16_t ADC_ReadSingleBlocking(uint8_t channel);
+/* Lee un canal (ANx) de forma bloqueante. 'channel' es el número AN (e.g., 0 para AN0, 1 para AN1, ...).
+   El resultado (0..4095 en 12-bit) solo es válido si devuelve ADC_OK. */
+ADC_Status_t ADC_ReadSingleBlocking(uint8_t channel, uint16_t *result);
 
 /* API no bloqueante */
 void ADC_StartSingle(uint8_t channel); /* inicia muestreo/conversión en channel */
 bool ADC_IsConversionDone(void);       /* true si DONE */
 uint16_t ADC_GetResult(void);          /* resultado del último muestreo (raw) */
 
-/* Resolución en bits (definir según AD1CON1.FORM y AD1CON3 configuración) */
+/* API de peticiones con handle. Segura desde ISR y bucle principal: solo
+   una petición es dueña del conversor a la vez; el resto recibe
+   ADC_ERR_BUSY. ADC_SetMode y los modos de disparo invalidan los handles. */
+ADC_Status_t ADC_Request(uint8_t channel, ADC_Handle_t *handle);
+ADC_Status_t ADC_Poll(ADC_Handle_t handle, uint16_t *result);
+ADC_Status_t ADC_Wait(ADC_Handle_t handle, uint16_t *result, uint32_t timeout_us);
+void ADC_Cancel(ADC_Handle_t handle);
+
+/* Último error registrado (se limpia al leerlo) y overruns acumulados */
+ADC_Status_t ADC_GetLastError(void);
+uint16_t ADC_GetOverrunCount(void);
+
+/* Calcula el Tad y el tiempo de adquisición mínimos legales para 'fcy' (Hz),
+   resolución 'res_bits' (10 o 12) y la impedancia de fuente 'source_ohms'.
+   Devuelve false si no hay combinación ADCS/SAMC que cumpla (en ese caso 't'
+   contiene la más lenta posible). */
+bool ADC_ComputeTiming(uint32_t fcy, uint8_t res_bits, uint32_t source_ohms, ADC_Timing_t *t);
+
+/* Copia la temporización aplicada por ADC_Init / ADC_SetMode */
+void ADC_GetTiming(ADC_Timing_t *t);
+
+/* Cambia el modo en tiempo de ejecución: apaga el ADC, reprograma AD12B,
+   CHPS/SIMSAM y recalcula ADCS/SAMC para la nueva resolución. */
+bool ADC_SetMode(ADC_Mode_t mode);
+ADC_Mode_t ADC_GetMode(void);
+uint8_t ADC_GetResolutionBits(void);
+uint16_t ADC_GetMaxValue(void);
+
+/* Muestreo simultáneo (solo ADC_MODE_10BIT_SIM4): CH0 = AN'ch0_channel',
+   CH1..CH3 según 'group'. Los cuatro S&H se congelan en el mismo instante. */
+void ADC_StartSimultaneous(uint8_t ch0_channel, ADC_Ch123_t group);
+bool ADC_GetSimultaneous(uint16_t out[ADC_SIM_CHANNELS]); /* out = {CH0, CH1, CH2, CH3} */
+ADC_Status_t ADC_ReadSimultaneousBlocking(uint8_t ch0_channel, ADC_Ch123_t group, uint16_t out[ADC_SIM_CHANNELS]);
+
+/* Disparo por el evento especial del PWM de control de motores (SSRC=011,
+   ASAM=1): el S&H muestrea continuamente y la conversión arranca en
+   SEVTCMP sin latencia software. Los resultados llegan por 'callback'. */
+void ADC_EnablePwmTrigger(uint8_t ch0_channel, ADC_Ch123_t group, ADC_Callback_t callback);
+void ADC_DisablePwmTrigger(void);
+
+/* Muestreo periódico disparado por Timer3 (SSRC=010): una secuencia cada
+   'period_us' y una interrupción cada ADC_BLOCK_LEN resultados (16
+   secuencias de CH0, o 4 secuencias CH0..CH3 en ADC_MODE_10BIT_SIM4). La CPU
+   no interviene entre bloques. Devuelve false si el periodo no cabe en PR3. */
+bool ADC_EnableTimerTrigger(uint8_t ch0_channel, uint32_t period_us, ADC_Callback_t callback);
+void ADC_DisableTimerTrigger(void);
+
+/* Handler de interrupción del ADC: llamar desde _ADC1Interrupt */
+void ADC_ISR_Handler(void);
+
+/* Resolución por defecto tras ADC_Init (12 o 10) */
+#ifndef ADC_RESOLUTION_BITS
 #define ADC_RESOLUTION_BITS 12u
-#define ADC_MAX_VALUE       ((1u << ADC_RESOLUTION_BITS) - 1u)
+#endif
+#define ADC_MAX_VALUE_12BIT 4095u
+#define ADC_MAX_VALUE_10BIT 1023u
+/* El fondo de escala del modo activo lo da ADC_GetMaxValue() */
 
 #ifdef __cplusplus
 }
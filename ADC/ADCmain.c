@@ -7,94 +7,210 @@
  * Descripción:
  *  - Usa config.h / config.c y el driver ADC (adc.h / adc.c).
  *  - Potenciómetro conectado a AN0 (RA0). LEDS en RB0..RB7 muestran los
- *    8 bits más significativos del resultado ADC (12-bit -> usamos bits [11:4]).
+ *    8 bits más significativos del resultado ADC según la resolución activa
+ *    (ADC_GetResolutionBits: bits [11:4] en 12-bit, [9:2] en 10-bit).
+ *  - Timer3 dispara el ADC cada SAMPLE_PERIOD_US; cada bloque de 16 muestras
+ *    pasa por una mediana de 3 (quita picos aislados) y por un comparador de
+ *    ventana que solo avisa cuando el valor sale del escalón de LED actual.
+ *    El bucle principal duerme (Idle) entre avisos.
+ *  - El arranque se perfila con boot.h: la impresión de configuración y el
+ *    informe de tiempos se difieren hasta que el muestreo ya está en marcha.
+ *  - Las estadísticas de AN0 (adc_stats.h) se sirven como esclavo I2C en
+ *    STATS_I2C_ADDRESS: 16 bytes big-endian según ADC_STATS_REG_xxx.
+ *  - Watchdog (wdt.h): el fin de bloque ADC marca el ritmo de WDT_Service
+ *    (un bloque = WDT_SERVICE_PERIOD_MS) y cada etapa, adquisición y
+ *    publicación I2C, hace su propio check-in.
  *
  * Requisitos:
- *  - Asegúrate de haber añadido config.h, config.c, adc.h y adc.c al proyecto.
+ *  - Asegúrate de haber añadido config.h, config.c, irq.h, irq.c,
+ *    critical.h, adc.h, adc.c, adc_cal.h, adc_cal.c, adc_filter.h,
+ *    adc_filter.c, adc_window.h, adc_window.c, adc_stats.h, adc_stats.c,
+ *    i2c.h, i2c.c, boot.h, boot.c, wdt.h, wdt.c, pins.h, pins.c, pps.h,
+ *    pps.c, board.h y board.c al proyecto (SYSTEM_Initialize aplica la
+ *    tabla PPS de board.c).
  *  - Ajusta los mapeos de pines si tu encapsulado no dispone de RB0..RB7.
  *
  * Nota:
  *  - config.h define FCY y la macro DELAY_MS(ms) usando libpic30.
- *  - Este main intenta ser robusto frente a distintas definiciones de registros
- *    (AD1PCFGL / AD1PCFG, ANSELAbits, etc.) usando #ifdef.
+ *  - Los pines se describen en board.c; este main solo elige la variante.
  */
 
 #include "config.h"
 #include "adc.h"
+#include "adc_filter.h"
+#include "adc_window.h"
+#include "adc_stats.h"
+#include "i2c.h"
+#include "i2c_isr.h"
+#include "boot.h"
+#include "board.h"
+#include "wdt.h"
 #include <xc.h>
 #include <stdint.h>
+#include <stdbool.h>
 
-/* Tiempo entre lecturas (ms) */
-#define SAMPLE_PERIOD_MS 50u
+/* Periodo de muestreo por Timer3 (us): un bloque de 16 cada 10 ms */
+#define SAMPLE_PERIOD_US 625u
 
-static void board_pins_init(void)
+#if (ADC_BLOCK_LEN * SAMPLE_PERIOD_US) != (WDT_SERVICE_PERIOD_MS * 1000u)
+#error "El bloque ADC debe durar WDT_SERVICE_PERIOD_MS: ajusta SAMPLE_PERIOD_US"
+#endif
+
+/* Plazos del supervisor: adquisición (ISR) y publicación I2C (bucle) */
+#define WDT_ADC_DEADLINE_MS    50u
+#define WDT_STATS_DEADLINE_MS  500u
+
+static uint8_t wdt_adc, wdt_stats;
+static volatile bool wdt_tick = false;
+
+/* Estadísticas de AN0: ventana de 256 muestras servida por I2C */
+#define STATS_WINDOW      256u
+#define STATS_I2C_ADDRESS 0x42u
+
+/* Imagen de ADC_Stats_Export y mapa que lee el maestro I2C */
+static uint8_t stats_image[ADC_STATS_REG_STRIDE];
+static uint8_t stats_regs[ADC_STATS_REG_STRIDE];
+static volatile bool stats_ready = false;
+
+/* Último valor que cruzó la ventana (lo escribe la ISR del ADC) */
+static volatile uint16_t led_value = 0;
+static volatile bool led_update = false;
+
+/* Centra la ventana de AN0 en 'value' con un escalón de LED a cada lado */
+static void window_track(uint16_t value)
+{
+    uint16_t full = ADC_GetMaxValue();
+    uint16_t step = (uint16_t)((full + 1u) >> 8);  /* 1 LSB de los LEDs */
+    uint16_t low = (value > step) ? (uint16_t)(value - step) : 0u;
+    uint16_t high = (value < full - step) ? (uint16_t)(value + step) : full;
+
+    ADC_Win_Configure(0, low, high, (uint16_t)(step >> 2));
+}
+
+/* Cruce de ventana: publicar el valor y seguirlo (contexto ISR) */
+static void window_event(uint8_t channel, ADC_WinState_t state, uint16_t value)
+{
+    (void)channel;
+    (void)state;
+    led_value = value;
+    led_update = true;
+    window_track(value);
+}
+
+/* Bloque de 16 muestras de AN0 (contexto ISR) */
+static void adc_block(const uint16_t *results, uint8_t count)
 {
-    /* --- Configurar AN0 (RA0) como analógico --- */
-    /* Si existe AD1PCFGL / AD1PCFG -> clear PCFG0 bit para AN0 analog */
-    #if defined(AD1PCFGL)
-        AD1PCFGL &= ~(1u << 0);    /* PCFG0 = 0 -> AN0 analógico */
-    #elif defined(AD1PCFG)
-        AD1PCFG &= ~(1u << 0);
-    #endif
-
-    /* Si existe ANSELA, marcar ANSA0 como analógico */
-    #ifdef ANSELAbits
-        ANSELAbits.ANSA0 = 1;
-    #endif
-
-    /* Asegurar RA0 como entrada */
-    #ifdef TRISAbits
-        TRISAbits.TRISA0 = 1;
-    #elif defined(TRISA)
-        TRISA |= (1u << 0);
-    #endif
-
-    /* --- Configurar RB0..RB7 como salidas para LEDs --- */
-    #ifdef LATB
-        LATB &= 0xFF00; /* limpiar LSB antes de configurar TRISB para evitar glitches */
-    #endif
-
-    #ifdef TRISBbits
-        TRISBbits.TRISB0 = 0;
-        TRISBbits.TRISB1 = 0;
-        TRISBbits.TRISB2 = 0;
-        TRISBbits.TRISB3 = 0;
-        TRISBbits.TRISB4 = 0;
-        TRISBbits.TRISB5 = 0;
-        TRISBbits.TRISB6 = 0;
-        TRISBbits.TRISB7 = 0;
-    #elif defined(TRISB)
-        /* Poner 8 LSB como salida (0) */
-        TRISB &= (uint16_t)~0x00FF;
-    #endif
+    ADC_Win_Process(0, results, count, 1u);
+    ADC_Stats_Update(0, results, count, 1u);
+    stats_ready = true;
+    WDT_Checkin(wdt_adc);
+    wdt_tick = true;
+}
+
+/* WDT_Service una vez por bloque ADC (WDT_SERVICE_PERIOD_MS) */
+static void wdt_poll(void)
+{
+    if (wdt_tick)
+    {
+        wdt_tick = false;
+        (void)WDT_Service();
+    }
+}
+
+/* Publica la última ventana en el mapa I2C. Devuelve false si el maestro
+   está en mitad de una transacción: se reintenta en la siguiente vuelta. */
+static bool stats_publish(void)
+{
+    (void)ADC_Stats_Export(0, stats_image, sizeof(stats_image));
+    return I2C_SlaveBankUpdate(I2C_MODULE_1, 0, 0, stats_image, sizeof(stats_image));
 }
 
 /* Función principal */
 int main(void)
 {
+    I2C_Config_t i2c = I2C_CONFIG_DEFAULT_SLAVE;
     uint16_t adc_value;
     uint8_t leds;
 
+    /* Perfilado del arranque: t = 0 */
+    BOOT_Start();
+
     /* Inicialización del sistema (puertos, gestión básica) */
     SYSTEM_Initialize();
+    BOOT_Mark("system");
 
-    /* Inicialización de pines específica para esta aplicación */
-    board_pins_init();
+    /* Supervisor: una tarea por etapa del pipeline */
+    WDT_Init();
+    wdt_adc = WDT_Register(WDT_ADC_DEADLINE_MS);
+    wdt_stats = WDT_Register(WDT_STATS_DEADLINE_MS);
 
-    /* Imprimir configuración (si stdout está redirigido a UART) */
-    SYSTEM_PrintConfiguration();
+    /* Pines de esta aplicación: AN0 analógico, LEDs en RB0..RB7 e I2C1 en
+       RB8/RB9 (board.c) */
+    BOARD_PinsInit(BOARD_VARIANT_ADC_DEMO | BOARD_GROUP_I2C1);
+    BOOT_Mark("pins");
+
+    /* Esclavo I2C con el mapa de estadísticas */
+    ADC_Stats_Init(STATS_WINDOW);
+    i2c.slave_address = STATS_I2C_ADDRESS;
+    i2c.general_call_enable = false;
+    I2C_Init(&i2c);
+    I2C_SlaveAttachMap(I2C_MODULE_1, stats_regs, sizeof(stats_regs));
 
     /* Inicializar ADC */
     ADC_Init();
+    BOOT_Mark("adc");
 
-    /* Bucle principal: leer AN0 y mostrar 8 MSB en RB0..RB7 */
+    /* Lectura inicial para encender los LEDs y centrar la ventana */
+    if (ADC_ReadSingleBlocking(0, &adc_value) != ADC_OK)
+    {
+        adc_value = 0;
+    }
+    BOOT_FirstSample();
+    led_value = adc_value;
+    led_update = true;
+    ADC_Win_Init(window_event);
+    window_track(adc_value);
+
+    /* Mediana de 3 en AN0: el driver la aplica a cada bloque antes de
+       adc_block, así un pico aislado no mueve la ventana ni los LEDs */
+    ADC_Filt_Init();
+    (void)ADC_Filt_Configure(0, ADC_FILT_MEDIAN3, 0);
+
+    /* A partir de aquí el hardware muestrea solo */
+    ADC_EnableTimerTrigger(0, SAMPLE_PERIOD_US, adc_block);
+    BOOT_Mark("pipeline");
+
+    /* Trabajo no crítico: se ejecuta desde el bucle ya en servicio.
+     * La configuración (si stdout está redirigido a UART) solo tras POR. */
+    BOOT_Defer(SYSTEM_PrintConfiguration, "print", BOOT_DEFER_COLD_ONLY);
+    BOOT_Defer(BOOT_PrintReport, "report", BOOT_DEFER_ALWAYS);
+
+    /* Bucle principal: actualizar LEDs solo cuando hay un cruce */
     while (1)
     {
-        /* Lectura bloqueante en canal AN0 (canal = 0) */
-        adc_value = ADC_ReadSingleBlocking(0);
-
-        /* Tomamos bits [11:4] de la lectura 12-bit para obtener 8 niveles */
-        leds = (uint8_t)((adc_value >> 4) & 0xFFu);
+        while (!led_update)
+        {
+            wdt_poll();
+
+            /* Estadísticas al mapa I2C tras cada bloque */
+            if (stats_ready && stats_publish())
+            {
+                stats_ready = false;
+                WDT_Checkin(wdt_stats);
+            }
+
+            /* Tareas de arranque diferidas; sin ellas, dormir hasta la
+             * siguiente interrupción (fin de bloque ADC) */
+            if (!BOOT_RunDeferred())
+            {
+                Idle();
+            }
+        }
+        led_update = false;
+        adc_value = led_value;
+
+        /* Tomamos los 8 MSB de la lectura (bits [11:4] en 12-bit, [9:2] en 10-bit) */
+        leds = (uint8_t)((adc_value >> (ADC_GetResolutionBits() - 8u)) & 0xFFu);
 
         /* Escribir en LATB (preservar bits altos si existen) */
         #ifdef LATB
@@ -103,10 +219,19 @@ int main(void)
             PORTB = (PORTB & 0xFF00) | leds;
         #endif
 
-        /* Esperar antes de la siguiente lectura para que los LEDs sean visibles */
-        DELAY_MS(SAMPLE_PERIOD_MS);
+        /* Con cruces seguidos el bucle interno no llega a ejecutarse */
+        wdt_poll();
     }
 
     /* no debería llegar aquí */
     return 0;
-}
\ No newline at end of file
+}
+
+/* Interrupción del ADC: fin de bloque disparado por Timer3 */
+void __attribute__((interrupt, no_auto_psv)) _ADC1Interrupt(void)
+{
+    ADC_ISR_Handler();
+}
+
+/* Esclavo I2C1: sirve stats_regs sin llamar a ninguna función */
+I2C1_VECTOR_SLAVE_MAP()
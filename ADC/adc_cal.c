@@ -0,0 +1,188 @@
+/*
+ * adc_cal.c
+ *
+ * Implementación de la calibración por canal del ADC (ver adc_cal.h).
+ *
+ * Uso:
+ *  - ADC_Init(); ADC_Cal_Init();
+ *  - En el arranque, con las entradas en reposo: ADC_Cal_NullOffset(ch, 6);
+ *  - Opcional: ADC_Cal_TwoPoint(...) con dos referencias conocidas.
+ *  - ADC_Cal_Enable(true);
+ */
+
+#include "adc_cal.h"
+#include "adc.h"
+
+/* Internals */
+static ADC_Cal_t adc_cal_table[ADC_CAL_CHANNELS];
+static bool adc_cal_enabled = false;
+static uint16_t adc_cal_bipolar = 0;   /* bit n = ANn con salida con signo */
+
+/* (x * gain) >> 14 con x con signo y gain sin signo */
+static inline int32_t adc_cal_scale(int16_t x, uint16_t gain)
+{
+#ifdef __XC16__
+    return __builtin_mulsu(x, gain) >> 14;
+#else
+    return ((int32_t)x * (int32_t)gain) >> 14;
+#endif
+}
+
+void ADC_Cal_Init(void)
+{
+    uint8_t i;
+    for (i = 0; i < ADC_CAL_CHANNELS; i++) {
+        adc_cal_table[i].offset = 0;
+        adc_cal_table[i].gain = ADC_CAL_GAIN_ONE;
+    }
+    adc_cal_enabled = false;
+    adc_cal_bipolar = 0;
+}
+
+void ADC_Cal_Enable(bool enable)
+{
+    adc_cal_enabled = enable;
+}
+
+bool ADC_Cal_IsEnabled(void)
+{
+    return adc_cal_enabled;
+}
+
+void ADC_Cal_Set(uint8_t channel, const ADC_Cal_t *cal)
+{
+    if (channel >= ADC_CAL_CHANNELS || cal == 0) return;
+    adc_cal_table[channel] = *cal;
+}
+
+void ADC_Cal_Get(uint8_t channel, ADC_Cal_t *cal)
+{
+    if (channel >= ADC_CAL_CHANNELS || cal == 0) return;
+    *cal = adc_cal_table[channel];
+}
+
+int16_t ADC_Cal_NullOffset(uint8_t channel, uint8_t log2_samples)
+{
+    bool was_enabled = adc_cal_enabled;
+    uint32_t acc = 0;
+    uint16_t n, i, raw = 0;
+    ADC_Status_t st = ADC_OK;
+
+    if (channel >= ADC_CAL_CHANNELS) return 0;
+    if (log2_samples > 10u) log2_samples = 10u;
+    n = (uint16_t)(1u << log2_samples);
+
+    /* Medir en crudo */
+    adc_cal_enabled = false;
+    for (i = 0; i < n && st == ADC_OK; i++) {
+        st = ADC_ReadSingleBlocking(channel, &raw);
+        acc += raw;
+    }
+    adc_cal_enabled = was_enabled;
+
+    /* Una lectura fallida (ocupado, timeout) no debe pasar por un cero */
+    if (st != ADC_OK) return adc_cal_table[channel].offset;
+
+    adc_cal_table[channel].offset = (int16_t)((acc + (n >> 1)) >> log2_samples);
+    return adc_cal_table[channel].offset;
+}
+
+bool ADC_Cal_TwoPoint(uint8_t channel, uint16_t raw_lo, uint16_t ref_lo,
+                      uint16_t raw_hi, uint16_t ref_hi)
+{
+    uint32_t gain;
+
+    if (channel >= ADC_CAL_CHANNELS) return false;
+    if (raw_hi <= raw_lo || ref_hi <= ref_lo) return false;
+
+    /* gain = (ref_hi - ref_lo) / (raw_hi - raw_lo) en Q14 */
+    gain = (((uint32_t)(ref_hi - ref_lo) << 14) + ((raw_hi - raw_lo) >> 1)) /
+           (uint32_t)(raw_hi - raw_lo);
+    if (gain == 0u || gain > 0xFFFFu) return false;
+
+    /* offset tal que (raw_lo - offset) * gain = ref_lo */
+    adc_cal_table[channel].gain = (uint16_t)gain;
+    adc_cal_table[channel].offset = (int16_t)((int32_t)raw_lo -
+        (int32_t)((((uint32_t)ref_lo << 14) + (gain >> 1)) / gain));
+    return true;
+}
+
+/* Corrige in-place n muestras de 'channel' separadas 'stride' posiciones.
+   Los coeficientes y el límite se cargan una vez por llamada. */
+static void adc_cal_apply(uint8_t channel, uint16_t *buf, uint16_t n, uint8_t stride)
+{
+    int16_t offset;
+    uint16_t gain, max;
+    int32_t y;
+    uint16_t i;
+
+    if (channel >= ADC_CAL_CHANNELS || buf == 0) return;
+    /* Los canales bipolares se entregan en crudo (ver ADC_Cal_ApplySigned) */
+    if (adc_cal_bipolar & (1u << channel)) return;
+
+    offset = adc_cal_table[channel].offset;
+    gain = adc_cal_table[channel].gain;
+    max = ADC_GetMaxValue();
+
+    if (gain == ADC_CAL_GAIN_ONE) {
+        /* Solo offset: resta y recorte */
+        for (i = 0; i < n; i++, buf += stride) {
+            y = (int32_t)*buf - offset;
+            *buf = (y < 0) ? 0u : (y > max) ? max : (uint16_t)y;
+        }
+        return;
+    }
+
+    for (i = 0; i < n; i++, buf += stride) {
+        y = adc_cal_scale((int16_t)((int16_t)*buf - offset), gain);
+        *buf = (y < 0) ? 0u : (y > max) ? max : (uint16_t)y;
+    }
+}
+
+void ADC_Cal_ApplyBlock(uint8_t channel, uint16_t *buf, uint16_t n)
+{
+    adc_cal_apply(channel, buf, n, 1u);
+}
+
+void ADC_Cal_ApplyInterleaved(const uint8_t *channels, uint8_t nch, uint16_t *buf, uint16_t n)
+{
+    uint8_t c;
+
+    if (channels == 0 || buf == 0 || nch == 0u) return;
+    if (nch == 1u) {
+        adc_cal_apply(channels[0], buf, n, 1u);
+        return;
+    }
+
+    /* buf = {ch0, ch1, .., ch0, ch1, ..}: un recorrido con paso nch por canal */
+    for (c = 0; c < nch && c < n; c++) {
+        adc_cal_apply(channels[c], &buf[c], (uint16_t)((n - c + nch - 1u) / nch), nch);
+    }
+}
+
+void ADC_Cal_SetBipolar(uint8_t channel, bool bipolar)
+{
+    if (channel >= ADC_CAL_CHANNELS) return;
+    if (bipolar) adc_cal_bipolar |= (uint16_t)(1u << channel);
+    else         adc_cal_bipolar &= (uint16_t)~(1u << channel);
+}
+
+void ADC_Cal_ApplySigned(uint8_t channel, const uint16_t *raw, int16_t *out, uint16_t n)
+{
+    int16_t offset;
+    uint16_t gain;
+    int32_t y;
+    uint16_t i;
+
+    if (channel >= ADC_CAL_CHANNELS || raw == 0 || out == 0) return;
+
+    offset = adc_cal_table[channel].offset;
+    gain = adc_cal_table[channel].gain;
+
+    /* Sin recorte en cero: (raw - offset) conserva el signo. Con 12 bits y
+       ganancia < 4.0 el resultado cabe en int16_t. */
+    for (i = 0; i < n; i++) {
+        y = adc_cal_scale((int16_t)((int16_t)raw[i] - offset), gain);
+        out[i] = (y > 32767) ? 32767 : (y < -32768) ? -32768 : (int16_t)y;
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * adc_cal.h
+ *
+ * Calibración por canal (offset y ganancia) para el driver ADC
+ *
+ * API:
+ *   void ADC_Cal_Init(void);                                   // tabla identidad, corrección deshabilitada
+ *   void ADC_Cal_Enable(bool enable);                          // aplica la tabla en el camino de adquisición
+ *   int16_t ADC_Cal_NullOffset(uint8_t channel, uint8_t log2_samples); // offset con entrada a cero (arranque)
+ *   bool ADC_Cal_TwoPoint(channel, raw_lo, ref_lo, raw_hi, ref_hi);    // offset + ganancia desde dos puntos
+ *   void ADC_Cal_ApplyBlock(uint8_t channel, uint16_t *buf, uint16_t n); // corrección por bloque (in-place)
+ *   void ADC_Cal_ApplyInterleaved(chs, nch, buf, n);           // bloque SIM4 CH0..CH3 entrelazado
+ *   void ADC_Cal_ApplySigned(channel, raw, out, n);            // canal bipolar (sensor a media escala)
+ *
+ * Corrección: y = ((raw - offset) * gain) >> 14, recortada a 0..ADC_GetMaxValue().
+ * gain en Q14 sin signo (16384 = 1.0, rango 0..3.99).
+ *
+ * Nota:
+ * - Con la corrección habilitada, ADC_ISR_Handler, ADC_GetSimultaneous y las
+ *   lecturas simples entregan valores ya corregidos: los consumidores no
+ *   compensan a mano.
+ * - El camino in-place es unipolar: recorta en 0. En un sensor de corriente
+ *   a media escala (offset ~ (max+1)/2) eso pierde una polaridad; marca el
+ *   canal con ADC_Cal_SetBipolar: el driver lo entrega en crudo y el
+ *   consumidor obtiene la corriente con signo con ADC_Cal_ApplySigned.
+ * - La tabla es RAM; guárdala/restáurala con ADC_Cal_Get/ADC_Cal_Set si la
+ *   persistes (EEPROM externa, flash).
+ */
+
+#ifndef ADC_CAL_H
+#define ADC_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_CAL_CHANNELS   9u      /* AN0..AN8 en el encapsulado de 44 pines */
+#define ADC_CAL_GAIN_ONE   16384u  /* 1.0 en Q14 */
+
+typedef struct {
+    int16_t  offset;   /* cuentas restadas antes de la ganancia */
+    uint16_t gain;     /* Q14 */
+} ADC_Cal_t;
+
+void ADC_Cal_Init(void);
+void ADC_Cal_Enable(bool enable);
+bool ADC_Cal_IsEnabled(void);
+
+void ADC_Cal_Set(uint8_t channel, const ADC_Cal_t *cal);
+void ADC_Cal_Get(uint8_t channel, ADC_Cal_t *cal);
+
+/* Promedia 2^log2_samples lecturas con la entrada en reposo (corriente nula,
+   referencia a tierra...) y guarda el resultado como offset del canal. Si
+   alguna lectura falla (ADC_ReadSingleBlocking != ADC_OK) el offset no
+   cambia. */
+int16_t ADC_Cal_NullOffset(uint8_t channel, uint8_t log2_samples);
+
+/* Calcula offset y ganancia para que raw_lo -> ref_lo y raw_hi -> ref_hi.
+   Devuelve false si los puntos no son válidos o la ganancia no cabe en Q14. */
+bool ADC_Cal_TwoPoint(uint8_t channel, uint16_t raw_lo, uint16_t ref_lo,
+                      uint16_t raw_hi, uint16_t ref_hi);
+
+/* Corrige in-place 'n' muestras de un mismo canal */
+void ADC_Cal_ApplyBlock(uint8_t channel, uint16_t *buf, uint16_t n);
+
+/* Corrige in-place 'n' muestras entrelazadas donde buf[i] procede de
+   channels[i % nch] (p. ej. secuencias CH0..CH3 en ADC_MODE_10BIT_SIM4).
+   Carga los coeficientes una vez por canal y bloque. */
+void ADC_Cal_ApplyInterleaved(const uint8_t *channels, uint8_t nch, uint16_t *buf, uint16_t n);
+
+/* Canal bipolar: el camino in-place (ApplyBlock/ApplyInterleaved y el
+   driver) lo deja en crudo en lugar de recortar los negativos a 0 */
+void ADC_Cal_SetBipolar(uint8_t channel, bool bipolar);
+
+/* Corrección con signo, y = ((raw - offset) * gain) >> 14 sin recorte en
+   cero. 'raw' y 'out' pueden no solaparse. */
+void ADC_Cal_ApplySigned(uint8_t channel, const uint16_t *raw, int16_t *out, uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_CAL_H */
@@ -0,0 +1,165 @@
+/*
+ * adc_filter.c
+ *
+ * Implementación de los filtros de media móvil y mediana (ver adc_filter.h).
+ *
+ * Cada slot guarda un anillo con las últimas muestras. La primera muestra
+ * tras configurar rellena el anillo para que la salida arranque sin
+ * transitorio desde cero.
+ */
+
+#include "adc_filter.h"
+
+typedef struct {
+    uint16_t ring[ADC_FILT_MAX_LEN];
+    uint16_t sum;        /* suma del anillo (media móvil): 16 * 4095 cabe */
+    uint8_t idx;
+    uint8_t log2_len;
+    uint8_t channel;
+    ADC_FiltType_t type;
+    bool primed;
+} ADC_FiltSlot_t;
+
+/* Internals */
+static ADC_FiltSlot_t adc_filt_slots[ADC_FILT_SLOTS];
+
+/* Ordena a <= b */
+#define ADC_FILT_SORT2(a, b) do { if ((a) > (b)) { uint16_t t_ = (a); (a) = (b); (b) = t_; } } while (0)
+
+static inline uint16_t adc_filt_median3(uint16_t a, uint16_t b, uint16_t c)
+{
+    ADC_FILT_SORT2(a, b);
+    ADC_FILT_SORT2(b, c);
+    ADC_FILT_SORT2(a, b);
+    return b;
+}
+
+/* Red de 7 intercambios que deja la mediana en c. Las cuatro primeras solo
+   tocan a, b, d, e: el menor y el mayor de esos cuatro no pueden ser la
+   mediana de los cinco, que queda como mediana de (b, c, d). */
+static inline uint16_t adc_filt_median5(uint16_t a, uint16_t b, uint16_t c,
+                                        uint16_t d, uint16_t e)
+{
+    ADC_FILT_SORT2(a, b);
+    ADC_FILT_SORT2(d, e);
+    ADC_FILT_SORT2(a, d);   /* a = mínimo de {a, b, d, e}: descartado */
+    ADC_FILT_SORT2(b, e);   /* e = máximo de {a, b, d, e}: descartado */
+    ADC_FILT_SORT2(b, c);
+    ADC_FILT_SORT2(c, d);
+    ADC_FILT_SORT2(b, c);
+    (void)a; (void)e;
+    return c;
+}
+
+static ADC_FiltSlot_t *adc_filt_find(uint8_t channel)
+{
+    uint8_t i;
+    for (i = 0; i < ADC_FILT_SLOTS; i++) {
+        if (adc_filt_slots[i].type != ADC_FILT_NONE && adc_filt_slots[i].channel == channel) {
+            return &adc_filt_slots[i];
+        }
+    }
+    return 0;
+}
+
+void ADC_Filt_Init(void)
+{
+    uint8_t i;
+    for (i = 0; i < ADC_FILT_SLOTS; i++) {
+        adc_filt_slots[i].type = ADC_FILT_NONE;
+    }
+}
+
+bool ADC_Filt_Configure(uint8_t channel, ADC_FiltType_t type, uint8_t log2_len)
+{
+    ADC_FiltSlot_t *s = adc_filt_find(channel);
+    uint8_t i;
+
+    if (type == ADC_FILT_NONE) {
+        if (s) s->type = ADC_FILT_NONE;
+        return true;
+    }
+    if (type == ADC_FILT_MOVAVG && log2_len > ADC_FILT_MAX_LOG2) return false;
+
+    if (s == 0) {
+        for (i = 0; i < ADC_FILT_SLOTS && s == 0; i++) {
+            if (adc_filt_slots[i].type == ADC_FILT_NONE) s = &adc_filt_slots[i];
+        }
+        if (s == 0) return false;
+    }
+
+    s->channel = channel;
+    s->log2_len = (type == ADC_FILT_MOVAVG) ? log2_len : 0u;
+    s->idx = 0;
+    s->sum = 0;
+    s->primed = false;
+    s->type = type;
+    return true;
+}
+
+void ADC_Filt_Process(uint8_t channel, uint16_t *buf, uint16_t n, uint8_t stride)
+{
+    ADC_FiltSlot_t *s = adc_filt_find(channel);
+    uint16_t *r;
+    uint16_t x, sum;
+    uint8_t idx, mask, k, i;
+
+    if (s == 0 || buf == 0 || n == 0u) return;
+    if (stride == 0u) stride = 1u;
+    r = s->ring;
+
+    if (!s->primed) {
+        for (i = 0; i < ADC_FILT_MAX_LEN; i++) r[i] = buf[0];
+        s->sum = (uint16_t)(buf[0] << s->log2_len);
+        s->primed = true;
+    }
+
+    /* Estado a registros durante el bloque */
+    idx = s->idx;
+    sum = s->sum;
+    k = s->log2_len;
+
+    switch (s->type) {
+        case ADC_FILT_MOVAVG:
+            mask = (uint8_t)((1u << k) - 1u);
+            while (n--) {
+                x = *buf;
+                sum = (uint16_t)(sum + x - r[idx]);  /* integrador - peine */
+                r[idx] = x;
+                idx = (uint8_t)((idx + 1u) & mask);
+                *buf = (uint16_t)(sum >> k);
+                buf += stride;
+            }
+            break;
+
+        case ADC_FILT_MEDIAN3:
+            /* r[0..1] = dos muestras anteriores */
+            while (n--) {
+                x = *buf;
+                *buf = adc_filt_median3(r[0], r[1], x);
+                r[0] = r[1];
+                r[1] = x;
+                buf += stride;
+            }
+            break;
+
+        case ADC_FILT_MEDIAN5:
+            /* r[0..3] = cuatro muestras anteriores */
+            while (n--) {
+                x = *buf;
+                *buf = adc_filt_median5(r[0], r[1], r[2], r[3], x);
+                r[0] = r[1];
+                r[1] = r[2];
+                r[2] = r[3];
+                r[3] = x;
+                buf += stride;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    s->idx = idx;
+    s->sum = sum;
+}
@@ -0,0 +1,63 @@
+/*
+ * adc_filter.h
+ *
+ * Filtros de pre-procesado por canal sobre bloques ADC: media móvil y mediana
+ *
+ * API:
+ *   void ADC_Filt_Init(void);                                          // libera todos los slots
+ *   bool ADC_Filt_Configure(uint8_t ch, ADC_FiltType_t type, uint8_t log2_len);
+ *   void ADC_Filt_Process(uint8_t ch, uint16_t *buf, uint16_t n, uint8_t stride); // in-place
+ *
+ * Filtros:
+ * - ADC_FILT_MOVAVG : media de 2^log2_len muestras (hasta ADC_FILT_MAX_LEN).
+ *                     Suma corriente estilo CIC (integrador + peine): O(1)
+ *                     por muestra, sin divisiones.
+ * - ADC_FILT_MEDIAN3/5: mediana de 3 o 5 muestras; elimina picos aislados
+ *                     sin suavizar flancos.
+ *
+ * Nota:
+ * - El historial ocupa RAM; solo hay ADC_FILT_SLOTS canales filtrados a la
+ *   vez. Los canales sin slot pasan sin modificar.
+ * - ADC_ISR_Handler aplica los filtros configurados a cada bloque disparado
+ *   por hardware, tras la calibración y antes del callback.
+ * - Deja el FIR de 75 coeficientes (FILTROFIR) para donde realmente se
+ *   necesita respuesta en frecuencia.
+ */
+
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ADC_FILT_SLOTS
+#define ADC_FILT_SLOTS      4u
+#endif
+#define ADC_FILT_MAX_LOG2   4u
+#define ADC_FILT_MAX_LEN    (1u << ADC_FILT_MAX_LOG2)
+
+typedef enum {
+    ADC_FILT_NONE = 0,
+    ADC_FILT_MOVAVG,
+    ADC_FILT_MEDIAN3,
+    ADC_FILT_MEDIAN5
+} ADC_FiltType_t;
+
+void ADC_Filt_Init(void);
+
+/* Asigna (o libera con ADC_FILT_NONE) un slot al canal. log2_len solo se usa
+   en ADC_FILT_MOVAVG. Devuelve false si no quedan slots o el largo no cabe. */
+bool ADC_Filt_Configure(uint8_t channel, ADC_FiltType_t type, uint8_t log2_len);
+
+/* Filtra in-place buf[0], buf[stride], ... (n muestras) del canal */
+void ADC_Filt_Process(uint8_t channel, uint16_t *buf, uint16_t n, uint8_t stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_FILTER_H */
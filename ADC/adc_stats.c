@@ -0,0 +1,216 @@
+/*
+ * adc_stats.c
+ *
+ * Implementación de las estadísticas por canal (ver adc_stats.h).
+ *
+ * Uso típico desde el callback del ADC:
+ *   ADC_Stats_Update(0, results, count, 1);
+ * y desde el bucle principal:
+ *   ADC_Stats_Get(0, &st);
+ *   ADC_Stats_Export(0, image, sizeof(image));   // imagen para el I2C esclavo
+ */
+
+#include "adc_stats.h"
+#include "irq.h"
+#include "critical.h"
+
+/* Acumuladores de la ventana en curso */
+typedef struct {
+    uint32_t sum;
+    uint64_t sumsq;
+    uint32_t count;
+    uint16_t min;
+    uint16_t max;
+} ADC_StatsAcc_t;
+
+/* Internals */
+static ADC_StatsAcc_t adc_stats_acc[ADC_STATS_CHANNELS];
+static ADC_Stats_t adc_stats_out[ADC_STATS_CHANNELS];
+static bool adc_stats_valid[ADC_STATS_CHANNELS];
+static uint32_t adc_stats_window = 0;
+
+/* Raíz cuadrada entera (redondeo hacia abajo) */
+static uint16_t adc_stats_isqrt(uint32_t x)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > x) bit >>= 2;
+    while (bit != 0u) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+static void adc_stats_clear(ADC_StatsAcc_t *a)
+{
+    a->sum = 0;
+    a->sumsq = 0;
+    a->count = 0;
+    a->min = 0xFFFFu;
+    a->max = 0;
+}
+
+void ADC_Stats_Init(uint32_t window)
+{
+    uint8_t i;
+    adc_stats_window = window;
+    for (i = 0; i < ADC_STATS_CHANNELS; i++) {
+        adc_stats_clear(&adc_stats_acc[i]);
+        adc_stats_valid[i] = false;
+    }
+}
+
+/* Cierra la ventana de 'channel' (ya validado). Se llama desde la ISR
+   del ADC (ADC_Stats_Update) o con ella bloqueada (ADC_Stats_Latch) */
+static bool adc_stats_latch(uint8_t channel)
+{
+    ADC_StatsAcc_t *a;
+    ADC_Stats_t *o;
+    uint32_t mean_sq, msq;
+
+    a = &adc_stats_acc[channel];
+    if (a->count == 0u) return false;
+
+    o = &adc_stats_out[channel];
+    o->count = a->count;
+    o->min = a->min;
+    o->max = a->max;
+    o->mean = (uint16_t)((a->sum + (a->count >> 1)) / a->count);
+
+    /* E[x^2] y var = E[x^2] - E[x]^2 (con media sin redondear) */
+    msq = (uint32_t)(a->sumsq / a->count);
+    mean_sq = (uint32_t)(((uint64_t)a->sum * a->sum) / ((uint64_t)a->count * a->count));
+    o->variance = (msq > mean_sq) ? (msq - mean_sq) : 0u;
+    o->rms = adc_stats_isqrt(msq);
+
+    adc_stats_valid[channel] = true;
+    adc_stats_clear(a);
+    return true;
+}
+
+/* Reset y Latch se llaman desde main: bloquean la ISR del ADC para no
+   leer ni borrar los acumuladores mientras ADC_Stats_Update los suma */
+void ADC_Stats_Reset(uint8_t channel)
+{
+    CRIT_State_t crit;
+
+    if (channel >= ADC_STATS_CHANNELS) return;
+    crit = CRIT_Enter(IRQ_PRIO_ADC);
+    adc_stats_clear(&adc_stats_acc[channel]);
+    CRIT_Exit(crit);
+}
+
+bool ADC_Stats_Latch(uint8_t channel)
+{
+    CRIT_State_t crit;
+    bool latched;
+
+    if (channel >= ADC_STATS_CHANNELS) return false;
+    crit = CRIT_Enter(IRQ_PRIO_ADC);
+    latched = adc_stats_latch(channel);
+    CRIT_Exit(crit);
+    return latched;
+}
+
+void ADC_Stats_Update(uint8_t channel, const uint16_t *buf, uint16_t n, uint8_t stride)
+{
+    ADC_StatsAcc_t *a;
+    uint32_t sum, sumsq;
+    uint16_t lo, hi, x, chunk;
+
+    if (channel >= ADC_STATS_CHANNELS || buf == 0) return;
+    if (stride == 0u) stride = 1u;
+    a = &adc_stats_acc[channel];
+
+    while (n > 0u) {
+        chunk = (n > ADC_STATS_MAX_BLOCK) ? ADC_STATS_MAX_BLOCK : n;
+        if (adc_stats_window != 0u && a->count + chunk > adc_stats_window) {
+            chunk = (uint16_t)(adc_stats_window - a->count);
+        }
+        n -= chunk;
+
+        /* Acumuladores locales de 32 bits: el bucle queda en registros */
+        sum = 0;
+        sumsq = 0;
+        lo = a->min;
+        hi = a->max;
+        a->count += chunk;
+        while (chunk--) {
+            x = *buf;
+            buf += stride;
+            sum += x;
+#ifdef __XC16__
+            sumsq += __builtin_muluu(x, x);
+#else
+            sumsq += (uint32_t)x * x;
+#endif
+            if (x < lo) lo = x;
+            if (x > hi) hi = x;
+        }
+        a->sum += sum;
+        a->sumsq += sumsq;
+        a->min = lo;
+        a->max = hi;
+
+        if (adc_stats_window != 0u && a->count >= adc_stats_window) {
+            (void)adc_stats_latch(channel);
+        }
+    }
+}
+
+bool ADC_Stats_Get(uint8_t channel, ADC_Stats_t *out)
+{
+    CRIT_State_t crit;
+    bool valid;
+
+    if (channel >= ADC_STATS_CHANNELS || out == 0) return false;
+    crit = CRIT_Enter(IRQ_PRIO_ADC);
+    valid = adc_stats_valid[channel];
+    if (valid) *out = adc_stats_out[channel];
+    CRIT_Exit(crit);
+    return valid;
+}
+
+/* Escribe 'v' big-endian en 'n' bytes */
+static void adc_stats_put_be(uint8_t *p, uint32_t v, uint8_t n)
+{
+    while (n--) {
+        p[n] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+uint8_t ADC_Stats_Export(uint8_t first, uint8_t *regs, uint8_t size)
+{
+    ADC_Stats_t snap;
+    CRIT_State_t crit;
+    uint8_t ch, n = 0;
+
+    if (regs == 0) return 0;
+
+    for (ch = first; ch < ADC_STATS_CHANNELS &&
+                     (uint16_t)(n + 1u) * ADC_STATS_REG_STRIDE <= size; ch++, n++) {
+        uint8_t *r = &regs[n * ADC_STATS_REG_STRIDE];
+
+        /* Copia de la ventana con la ISR del ADC bloqueada: ADC_Stats_Latch
+           corre en ella y podría reescribir los campos a medias */
+        crit = CRIT_Enter(IRQ_PRIO_ADC);
+        snap = adc_stats_out[ch];
+        CRIT_Exit(crit);
+
+        adc_stats_put_be(&r[ADC_STATS_REG_MEAN], snap.mean, 2u);
+        adc_stats_put_be(&r[ADC_STATS_REG_RMS], snap.rms, 2u);
+        adc_stats_put_be(&r[ADC_STATS_REG_MIN], snap.min, 2u);
+        adc_stats_put_be(&r[ADC_STATS_REG_MAX], snap.max, 2u);
+        adc_stats_put_be(&r[ADC_STATS_REG_VARIANCE], snap.variance, 4u);
+        adc_stats_put_be(&r[ADC_STATS_REG_COUNT], snap.count, 4u);
+    }
+    return n;
+}
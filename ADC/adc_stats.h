@@ -0,0 +1,74 @@
+/*
+ * adc_stats.h
+ *
+ * Estadísticas por canal sobre bloques ADC: media, RMS, mínimo, máximo y varianza
+ *
+ * API:
+ *   void ADC_Stats_Init(uint32_t window);                         // ventana en muestras (0 = manual)
+ *   void ADC_Stats_Update(uint8_t ch, const uint16_t *buf, uint16_t n, uint8_t stride);
+ *   void ADC_Stats_Reset(uint8_t ch);                             // reinicia la ventana en curso
+ *   bool ADC_Stats_Latch(uint8_t ch);                             // cierra la ventana manualmente
+ *   bool ADC_Stats_Get(uint8_t ch, ADC_Stats_t *out);             // última ventana cerrada
+ *   uint8_t ADC_Stats_Export(first, regs, size);                  // imagen del mapa de registros
+ *
+ * Nota:
+ * - El bucle por muestra no llama a funciones: acumula en 32 bits dentro
+ *   del bloque (hasta 256 muestras de 12 bits sin desbordar la suma de
+ *   cuadrados) y vuelca a los acumuladores de 64 bits una vez por bloque.
+ * - Media, varianza y RMS se calculan solo al cerrar la ventana.
+ * - ADC_Stats_Reset y ADC_Stats_Latch bloquean la ISR del ADC mientras
+ *   tocan los acumuladores: se pueden llamar desde main.
+ * - ADC_Stats_Export copia cada ventana con la ISR del ADC bloqueada y
+ *   escribe la imagen fuera de ella: publícala en el I2C esclavo con
+ *   I2C_SlaveBankUpdate, que no la cambia en mitad de una lectura.
+ */
+
+#ifndef ADC_STATS_H
+#define ADC_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_STATS_CHANNELS   9u    /* AN0..AN8 */
+#define ADC_STATS_MAX_BLOCK  256u  /* muestras por llamada a ADC_Stats_Update */
+
+/* Resultado de una ventana cerrada */
+typedef struct {
+    uint16_t mean;      /* cuentas, redondeada        */
+    uint16_t rms;       /* cuentas                    */
+    uint16_t min;
+    uint16_t max;
+    uint32_t variance;  /* cuentas^2                  */
+    uint32_t count;     /* muestras en la ventana     */
+} ADC_Stats_t;
+
+/* Mapa de registros: ADC_STATS_REG_STRIDE bytes por canal, big-endian,
+   en el orden de ADC_Stats_t (ver ADC_Stats_Export) */
+#define ADC_STATS_REG_MEAN      0x00u
+#define ADC_STATS_REG_RMS       0x02u
+#define ADC_STATS_REG_MIN       0x04u
+#define ADC_STATS_REG_MAX       0x06u
+#define ADC_STATS_REG_VARIANCE  0x08u
+#define ADC_STATS_REG_COUNT     0x0Cu
+#define ADC_STATS_REG_STRIDE    0x10u
+
+void ADC_Stats_Init(uint32_t window);
+void ADC_Stats_Update(uint8_t channel, const uint16_t *buf, uint16_t n, uint8_t stride);
+void ADC_Stats_Reset(uint8_t channel);
+bool ADC_Stats_Latch(uint8_t channel);
+bool ADC_Stats_Get(uint8_t channel, ADC_Stats_t *out);
+
+/* Serializa las últimas ventanas de los canales first, first+1, ... en
+   'regs' (ADC_STATS_REG_STRIDE bytes cada uno, mientras quepan en 'size').
+   Devuelve el número de canales escritos. */
+uint8_t ADC_Stats_Export(uint8_t first, uint8_t *regs, uint8_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_STATS_H */
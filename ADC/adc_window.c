@@ -0,0 +1,140 @@
+/*
+ * adc_window.c
+ *
+ * Implementación del comparador de ventana (ver adc_window.h).
+ *
+ * El bucle interno solo hace dos comparaciones por muestra contra los
+ * umbrales de salida del estado actual; los umbrales se recalculan
+ * únicamente cuando hay un cruce.
+ */
+
+#include "adc_window.h"
+
+typedef struct {
+    uint16_t low;
+    uint16_t high;
+    uint16_t hyst;
+    uint16_t exit_lo;   /* x < exit_lo  -> sale del estado actual */
+    uint16_t exit_hi;   /* x > exit_hi  -> sale del estado actual */
+    ADC_WinState_t state;
+    bool enabled;
+} ADC_Window_t;
+
+/* Internals */
+static ADC_Window_t adc_windows[ADC_WIN_CHANNELS];
+static ADC_WinCallback_t adc_win_callback = 0;
+static volatile uint16_t adc_win_pending = 0;
+
+/* Umbrales de salida del estado actual: BELOW sale con x >= low + hyst,
+   ABOVE con x <= high - hyst (ver adc_window.h) */
+static void adc_win_set_exits(ADC_Window_t *w)
+{
+    switch (w->state) {
+        case ADC_WIN_BELOW:
+            w->exit_lo = 0;
+            w->exit_hi = (uint16_t)(w->low + w->hyst - 1u);
+            break;
+        case ADC_WIN_ABOVE:
+            w->exit_lo = (w->high > w->hyst) ? (uint16_t)(w->high - w->hyst + 1u) : 0u;
+            w->exit_hi = 0xFFFFu;
+            break;
+        default:
+            w->exit_lo = w->low;
+            w->exit_hi = w->high;
+            break;
+    }
+}
+
+/* Estado que corresponde a 'x' al salir del estado actual */
+static ADC_WinState_t adc_win_classify(const ADC_Window_t *w, uint16_t x)
+{
+    if (x < w->low)  return ADC_WIN_BELOW;
+    if (x > w->high) return ADC_WIN_ABOVE;
+    return ADC_WIN_INSIDE;
+}
+
+void ADC_Win_Init(ADC_WinCallback_t callback)
+{
+    uint8_t i;
+    for (i = 0; i < ADC_WIN_CHANNELS; i++) {
+        adc_windows[i].enabled = false;
+    }
+    adc_win_callback = callback;
+    adc_win_pending = 0;
+}
+
+void ADC_Win_Configure(uint8_t channel, uint16_t low, uint16_t high, uint16_t hysteresis)
+{
+    ADC_Window_t *w;
+
+    if (channel >= ADC_WIN_CHANNELS || high < low) return;
+    w = &adc_windows[channel];
+
+    /* La histéresis no puede cruzar al otro lado de la ventana */
+    if (hysteresis > (uint16_t)(high - low)) hysteresis = (uint16_t)(high - low);
+    if (hysteresis == 0u) hysteresis = 1u;
+
+    w->low = low;
+    w->high = high;
+    w->hyst = hysteresis;
+    w->state = ADC_WIN_INSIDE;
+    adc_win_set_exits(w);
+    w->enabled = true;
+}
+
+void ADC_Win_Disable(uint8_t channel)
+{
+    if (channel < ADC_WIN_CHANNELS) adc_windows[channel].enabled = false;
+}
+
+ADC_WinState_t ADC_Win_GetState(uint8_t channel)
+{
+    return (channel < ADC_WIN_CHANNELS) ? adc_windows[channel].state : ADC_WIN_INSIDE;
+}
+
+uint8_t ADC_Win_Process(uint8_t channel, const uint16_t *buf, uint16_t n, uint8_t stride)
+{
+    ADC_Window_t *w;
+    uint16_t lo, hi, x;
+    uint8_t events = 0;
+    ADC_WinState_t next;
+
+    if (channel >= ADC_WIN_CHANNELS || buf == 0) return 0;
+    w = &adc_windows[channel];
+    if (!w->enabled) return 0;
+    if (stride == 0u) stride = 1u;
+
+    lo = w->exit_lo;
+    hi = w->exit_hi;
+
+    while (n--) {
+        x = *buf;
+        buf += stride;
+        if (x >= lo && x <= hi) continue;   /* caso común: sin cruce */
+
+        next = adc_win_classify(w, x);
+        if (next == w->state) continue;
+
+        w->state = next;
+        adc_win_set_exits(w);
+        events++;
+
+        adc_win_pending |= (uint16_t)(1u << channel);
+        if (adc_win_callback) adc_win_callback(channel, next, x);
+
+        /* El callback puede haber reconfigurado la ventana */
+        lo = w->exit_lo;
+        hi = w->exit_hi;
+    }
+
+    return events;
+}
+
+/* AND sobre memoria en una instrucción: no pierde bits que la ISR
+   marque entre la lectura y el borrado */
+uint16_t ADC_Win_TakePending(void)
+{
+    uint16_t p = adc_win_pending;
+    adc_win_pending &= (uint16_t)~p;
+    return p;
+}
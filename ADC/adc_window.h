@@ -0,0 +1,60 @@
+/*
+ * adc_window.h
+ *
+ * Comparador de ventana con histéresis sobre bloques ADC
+ *
+ * API:
+ *   void ADC_Win_Init(ADC_WinCallback_t cb);                      // todas las ventanas deshabilitadas
+ *   void ADC_Win_Configure(uint8_t ch, uint16_t low, uint16_t high, uint16_t hyst);
+ *   void ADC_Win_Disable(uint8_t ch);
+ *   uint8_t ADC_Win_Process(uint8_t ch, const uint16_t *buf, uint16_t n, uint8_t stride);
+ *   uint16_t ADC_Win_TakePending(void);                           // máscara de canales con evento
+ *
+ * Estados: INSIDE (low <= x <= high), BELOW (x < low), ABOVE (x > high).
+ * Para salir de BELOW hay que llegar a low + hyst (x >= low + hyst); para
+ * salir de ABOVE, bajar hasta high - hyst (x <= high - hyst). Solo se
+ * notifica al cambiar de estado. Comprobación en el PC: adc_window_check.c.
+ *
+ * Nota:
+ * - Pensado para llamarse desde el callback del ADC (ISR) con el bloque
+ *   recién convertido: sin sondeo por muestra desde el bucle principal.
+ */
+
+#ifndef ADC_WINDOW_H
+#define ADC_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_WIN_CHANNELS 9u   /* AN0..AN8 */
+
+typedef enum {
+    ADC_WIN_INSIDE = 0,
+    ADC_WIN_BELOW,
+    ADC_WIN_ABOVE
+} ADC_WinState_t;
+
+/* Se invoca en cada cruce, desde el contexto que llama a ADC_Win_Process */
+typedef void (*ADC_WinCallback_t)(uint8_t channel, ADC_WinState_t state, uint16_t value);
+
+void ADC_Win_Init(ADC_WinCallback_t callback);
+void ADC_Win_Configure(uint8_t channel, uint16_t low, uint16_t high, uint16_t hysteresis);
+void ADC_Win_Disable(uint8_t channel);
+ADC_WinState_t ADC_Win_GetState(uint8_t channel);
+
+/* Recorre buf[0], buf[stride], ... (n muestras) del canal 'channel'.
+   Devuelve el número de cruces detectados. */
+uint8_t ADC_Win_Process(uint8_t channel, const uint16_t *buf, uint16_t n, uint8_t stride);
+
+/* Devuelve y limpia la máscara de canales con cruces pendientes (bit n = ANn) */
+uint16_t ADC_Win_TakePending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_WINDOW_H */
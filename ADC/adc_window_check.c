@@ -0,0 +1,104 @@
+/*
+ * adc_window_check.c - Comprueba los umbrales del comparador de ventana (PC/Linux)
+ *
+ * Descripción:
+ *  Alimenta ADC_Win_Process con secuencias de muestras que caen justo en
+ *  los bordes de la histéresis (low + hyst - 1, low + hyst, high - hyst + 1,
+ *  high - hyst) y comprueba el estado y los eventos resultantes. No forma
+ *  parte del firmware.
+ *
+ * Compilar:
+ *   gcc -std=c99 -O2 -Wall -Wextra -o adc_window_check adc_window_check.c adc_window.c
+ *
+ * Uso:
+ *   adc_window_check
+ *
+ *  Devuelve 0 si todas las comprobaciones pasan.
+ *
+ ******************************************************************************/
+
+#include "adc_window.h"
+#include <stdio.h>
+
+#define CH      0u
+#define LOW     100u
+#define HIGH    200u
+#define HYST    10u
+
+static int errors = 0;
+static uint8_t cb_count = 0;
+static ADC_WinState_t cb_state = ADC_WIN_INSIDE;
+static uint16_t cb_value = 0;
+
+static void on_cross(uint8_t channel, ADC_WinState_t state, uint16_t value)
+{
+    (void)channel;
+    cb_count++;
+    cb_state = state;
+    cb_value = value;
+}
+
+static void check(int cond, const char *what)
+{
+    printf("%-52s %s\n", what, cond ? "OK" : "FALLO");
+    if (!cond) errors++;
+}
+
+/* Una muestra; devuelve el número de cruces */
+static uint8_t feed(uint16_t x)
+{
+    return ADC_Win_Process(CH, &x, 1, 1);
+}
+
+int main(void)
+{
+    static const uint16_t block[] = { 150, 99, 0, 150, 99, 0, 110, 0 };
+    uint8_t n;
+
+    ADC_Win_Init(on_cross);
+    ADC_Win_Configure(CH, LOW, HIGH, HYST);
+    check(ADC_Win_GetState(CH) == ADC_WIN_INSIDE, "estado inicial INSIDE");
+
+    /* Bordes de la ventana: low y high son INSIDE */
+    check(feed(LOW) == 0 && feed(HIGH) == 0, "x = low y x = high no cruzan");
+
+    /* BELOW: sale exactamente al llegar a low + hyst */
+    check(feed(LOW - 1u) == 1 && cb_state == ADC_WIN_BELOW, "x = low - 1 -> BELOW");
+    check(feed(LOW) == 0, "BELOW: x = low no sale");
+    check(feed(LOW + HYST - 1u) == 0 && ADC_Win_GetState(CH) == ADC_WIN_BELOW,
+          "BELOW: x = low + hyst - 1 no sale");
+    n = feed(LOW + HYST);
+    check(n == 1 && cb_state == ADC_WIN_INSIDE && cb_value == LOW + HYST,
+          "BELOW: x = low + hyst -> INSIDE");
+
+    /* ABOVE: sale exactamente al bajar a high - hyst */
+    check(feed(HIGH + 1u) == 1 && cb_state == ADC_WIN_ABOVE, "x = high + 1 -> ABOVE");
+    check(feed(HIGH) == 0, "ABOVE: x = high no sale");
+    check(feed(HIGH - HYST + 1u) == 0 && ADC_Win_GetState(CH) == ADC_WIN_ABOVE,
+          "ABOVE: x = high - hyst + 1 no sale");
+    n = feed(HIGH - HYST);
+    check(n == 1 && cb_state == ADC_WIN_INSIDE && cb_value == HIGH - HYST,
+          "ABOVE: x = high - hyst -> INSIDE");
+
+    /* Salto directo de BELOW a ABOVE sin pasar por INSIDE */
+    check(feed(LOW - 1u) == 1 && feed(HIGH + 1u) == 1 && cb_state == ADC_WIN_ABOVE,
+          "BELOW -> ABOVE en una muestra");
+    check(feed(LOW) == 1 && cb_state == ADC_WIN_INSIDE, "ABOVE -> INSIDE");
+
+    /* Bloque intercalado (stride 2): solo cuentan las muestras pares */
+    cb_count = 0;
+    n = ADC_Win_Process(CH, block, 4, 2);
+    check(n == 2 && cb_count == 2 && ADC_Win_GetState(CH) == ADC_WIN_INSIDE,
+          "stride 2: 150, 0, 99, 110 -> dos cruces");
+
+    /* Histéresis mayor que la ventana: se recorta a high - low */
+    ADC_Win_Configure(CH, LOW, LOW + 5u, 50u);
+    check(feed(LOW - 1u) == 1 && feed(LOW + 4u) == 0 && feed(LOW + 5u) == 1,
+          "hyst recortada: sale de BELOW en high");
+
+    check(ADC_Win_TakePending() == (1u << CH) && ADC_Win_TakePending() == 0u,
+          "máscara de pendientes");
+
+    printf("%s (%d fallos)\n", errors ? "ERROR" : "OK", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * board.c - Tabla de pines de la placa (ver board.h)
+ *
+ ******************************************************************************/
+
+#include "board.h"
+#include <stddef.h>
+
+#define G_LEDS   0u
+#define G_POT    1u
+#define G_PHASE  2u
+#define G_I2C1   3u
+#define G_SPI1   4u
+
+const PIN_Desc_t BOARD_Pins[] = {
+    /* LEDs: RB0..RB7, apagados al arrancar */
+    PIN_DESC(PIN_PORT_B, 0, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 1, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 2, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 3, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 4, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 5, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 6, PIN_OUT, G_LEDS),
+    PIN_DESC(PIN_PORT_B, 7, PIN_OUT, G_LEDS),
+
+    /* Potenciómetro en AN0 */
+    PIN_DESC(PIN_PORT_A, 0, PIN_ANALOG, G_POT),
+
+    /* Control de motor: AN0..AN2 corrientes de fase, AN3 consigna */
+    PIN_DESC(PIN_PORT_A, 0, PIN_ANALOG, G_PHASE),
+    PIN_DESC(PIN_PORT_A, 1, PIN_ANALOG, G_PHASE),
+    PIN_DESC(PIN_PORT_B, 0, PIN_ANALOG, G_PHASE),
+    PIN_DESC(PIN_PORT_B, 1, PIN_ANALOG, G_PHASE),
+
+    /* I2C1: el módulo controla el open-drain; solo hace falta entrada digital */
+    PIN_DESC(PIN_PORT_B, 8, PIN_IN, G_I2C1),
+    PIN_DESC(PIN_PORT_B, 9, PIN_IN, G_I2C1),
+
+    /* SPI1 (remapeado por PPS) y chip select por GPIO, inactivo en alto */
+    PIN_DESC(PIN_PORT_C, 6, PIN_OUT, G_SPI1),
+    PIN_DESC(PIN_PORT_C, 7, PIN_OUT, G_SPI1),
+    PIN_DESC(PIN_PORT_C, 8, PIN_IN, G_SPI1),
+    PIN_DESC(PIN_PORT_C, 9, PIN_OUT | PIN_INIT_HIGH, G_SPI1),   /* ADC ext. */
+    PIN_DESC(PIN_PORT_A, 8, PIN_OUT | PIN_INIT_HIGH, G_SPI1),   /* DAC      */
+    PIN_DESC(PIN_PORT_C, 3, PIN_OUT | PIN_INIT_HIGH, G_SPI1),   /* flash    */
+};
+
+const uint8_t BOARD_PinCount = (uint8_t)(sizeof(BOARD_Pins) / sizeof(BOARD_Pins[0]));
+
+/* Tabla PPS completa: con IOL1WAY = ON no se puede ampliar tras bloquear */
+const PPS_Map_t BOARD_Pps[] = {
+    PPS_OUTPUT(PPS_OUT_U1TX, 20),     /* RC4: TX de la UART1 (printf) */
+    PPS_INPUT(PPS_IN_U1RX, 21),       /* RC5: RX de la UART1          */
+    PPS_OUTPUT(PPS_OUT_SCK1, 22),     /* RC6: SCK1 (maestro)          */
+    PPS_INPUT(PPS_IN_SCK1, 22),       /*      y su entrada, mismo pin */
+    PPS_OUTPUT(PPS_OUT_SDO1, 23),     /* RC7: SDO1                    */
+    PPS_INPUT(PPS_IN_SDI1, 24),       /* RC8: SDI1                    */
+};
+
+const uint8_t BOARD_PpsCount = (uint8_t)(sizeof(BOARD_Pps) / sizeof(BOARD_Pps[0]));
+
+PIN_Status_t BOARD_PinsInit(uint8_t groups)
+{
+    PIN_Status_t st = PIN_Validate(BOARD_Pins, BOARD_PinCount, groups, NULL);
+
+    if (st == PIN_OK) {
+        PIN_Apply(BOARD_Pins, BOARD_PinCount, groups);
+    }
+    return st;
+}
+
+PPS_Status_t BOARD_PpsInit(void)
+{
+    return PPS_Apply(BOARD_Pps, BOARD_PpsCount, true);
+}
@@ -0,0 +1,66 @@
+/*
+ * board.h - Descripción de pines de la placa (dsPIC33FJ32MC204, 44 pines)
+ *
+ * Descripción:
+ *  Tabla única de pines de la placa, agrupada por función. Cada programa
+ *  aplica la variante (combinación de grupos) que necesita con
+ *  BOARD_PinsInit(), que valida la selección y la aplica de una pasada.
+ *
+ *  Grupos:
+ *   - BOARD_GROUP_LEDS  : RB0..RB7 salidas (LEDs)
+ *   - BOARD_GROUP_POT   : RA0/AN0 potenciómetro
+ *   - BOARD_GROUP_PHASE : AN0..AN3 (RA0, RA1, RB0, RB1) corrientes/consigna
+ *   - BOARD_GROUP_I2C1  : RB8 (SCL1), RB9 (SDA1) digitales
+ *   - BOARD_GROUP_SPI1  : RC6..RC8 (SCK1/SDO1/SDI1) y los chip select RC9
+ *                         (ADC externo), RA8 (DAC) y RC3 (flash)
+ *
+ * Nota:
+ *  - PHASE y LEDS comparten RB0/RB1: no pueden ir en la misma variante
+ *    (PIN_Validate devuelve PIN_ERR_CONFLICT).
+ *  - Una variante nueva de placa = una máscara de grupos nueva.
+ *  - No depende de xc.h/config.h para poder validarse en el PC.
+ *
+ ******************************************************************************/
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "pins.h"
+#include "pps.h"
+
+#define BOARD_GROUP_LEDS    PIN_GROUP_MASK(0)
+#define BOARD_GROUP_POT     PIN_GROUP_MASK(1)
+#define BOARD_GROUP_PHASE   PIN_GROUP_MASK(2)
+#define BOARD_GROUP_I2C1    PIN_GROUP_MASK(3)
+#define BOARD_GROUP_SPI1    PIN_GROUP_MASK(4)
+
+/* Variantes */
+#define BOARD_VARIANT_ADC_DEMO  (BOARD_GROUP_LEDS | BOARD_GROUP_POT)
+#define BOARD_VARIANT_MOTOR     (BOARD_GROUP_PHASE)
+#define BOARD_VARIANT_I2C       (BOARD_GROUP_I2C1)
+#define BOARD_VARIANT_SPI       (BOARD_GROUP_SPI1)
+
+/* Chip select del dispositivo SPI de la placa (ADC externo) */
+#define BOARD_SPI_CS_PORT       PIN_PORT_C
+#define BOARD_SPI_CS_BIT        9u
+
+/* Chip select del DAC SPI: cada esclavo del bus necesita el suyo */
+#define BOARD_DAC_CS_PORT       PIN_PORT_A
+#define BOARD_DAC_CS_BIT        8u
+
+/* Chip select de la flash SPI de registro (LOG/) */
+#define BOARD_FLASH_CS_PORT     PIN_PORT_C
+#define BOARD_FLASH_CS_BIT      3u
+
+extern const PIN_Desc_t BOARD_Pins[];
+extern const uint8_t BOARD_PinCount;
+extern const PPS_Map_t BOARD_Pps[];
+extern const uint8_t BOARD_PpsCount;
+
+/* Valida y aplica los grupos indicados; si hay error no toca ningún pin */
+PIN_Status_t BOARD_PinsInit(uint8_t groups);
+
+/* Aplica y bloquea la tabla PPS completa (una vez por reset) */
+PPS_Status_t BOARD_PpsInit(void);
+
+#endif /* BOARD_H */
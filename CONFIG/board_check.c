@@ -0,0 +1,80 @@
+/*
+ * board_check.c - Validador de la tabla de pines en el PC
+ *
+ * Descripción:
+ *  Comprueba las variantes de board.h sin hardware. No forma parte del
+ *  firmware: se compila con el gcc del PC.
+ *
+ * Uso:
+ *   gcc -I. -o board_check board_check.c board.c pins.c pps.c && ./board_check
+ *
+ *  Devuelve 0 si todas las variantes y la tabla PPS son válidas. Avisa
+ *  (sin fallar) de los RP que comparten pin con una entrada ANx.
+ *
+ ******************************************************************************/
+
+#include "board.h"
+#include <stdio.h>
+
+typedef struct {
+    const char *name;
+    uint8_t groups;
+} Variant_t;
+
+static const Variant_t variants[] = {
+    { "leds",     BOARD_GROUP_LEDS },
+    { "adc_demo", BOARD_VARIANT_ADC_DEMO },
+    { "motor",    BOARD_VARIANT_MOTOR },
+    { "i2c",      BOARD_VARIANT_I2C },
+    { "spi",      BOARD_VARIANT_SPI },
+    /* Combinaciones que aplica cada programa (BOARD_PinsInit del main más
+       las de los drivers: I2C_Init aplica I2C1, SPI_Init aplica SPI1) */
+    { "ADCmain",  BOARD_VARIANT_ADC_DEMO | BOARD_GROUP_I2C1 },
+    { "flashlog", BOARD_GROUP_POT | BOARD_VARIANT_SPI },
+    { "pwmmain",  BOARD_VARIANT_MOTOR },
+    { "i2cmain",  BOARD_VARIANT_I2C | BOARD_GROUP_POT },
+    { "spimain",  BOARD_VARIANT_SPI },
+};
+
+int main(void)
+{
+    static const char port_name[PIN_PORT_COUNT] = { 'A', 'B', 'C' };
+    unsigned i;
+    int errors = 0;
+
+    for (i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        uint8_t bad = 0;
+        PIN_Status_t st = PIN_Validate(BOARD_Pins, BOARD_PinCount,
+                                       variants[i].groups, &bad);
+        if (st == PIN_OK) {
+            printf("%-10s OK\n", variants[i].name);
+        } else {
+            const PIN_Desc_t *d = &BOARD_Pins[bad];
+            printf("%-10s ERROR en entrada %u (R%c%u): %s\n", variants[i].name,
+                   bad, d->port < PIN_PORT_COUNT ? port_name[d->port] : '?',
+                   d->bit, PIN_StatusString(st));
+            errors++;
+        }
+    }
+    {
+        uint8_t bad = 0;
+        PPS_Status_t st = PPS_Validate(BOARD_Pps, BOARD_PpsCount, &bad);
+        if (st == PPS_OK) {
+            printf("%-10s OK\n", "pps");
+        } else {
+            printf("%-10s ERROR en entrada %u (RP%u): %s\n", "pps", bad,
+                   BOARD_Pps[bad].rp, PPS_StatusString(st));
+            errors++;
+        }
+        for (i = 0; i < BOARD_PpsCount; i++) {
+            uint8_t port, bit;
+            if (PPS_RpToPin(BOARD_Pps[i].rp, &port, &bit) &&
+                PIN_AnalogChannel(port, bit) >= 0) {
+                printf("  aviso: RP%u (R%c%u) es AN%d; declararlo digital\n",
+                       BOARD_Pps[i].rp, port_name[port], bit,
+                       PIN_AnalogChannel(port, bit));
+            }
+        }
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * boot.c - Implementación del perfilado de arranque (ver boot.h)
+ *
+ ******************************************************************************/
+
+#include "boot.h"
+#include "config.h"
+#include "wdt.h"
+#include <xc.h>
+#include <stdio.h>  /* usado opcionalmente por BOOT_PrintReport */
+
+#define BOOT_TIMER_PRESCALE   256UL
+#define BOOT_TCKPS_256        3u
+
+typedef struct {
+    const char *name;
+    uint32_t ticks;
+} BOOT_MarkEntry_t;
+
+typedef struct {
+    BOOT_Fn_t fn;
+    const char *name;
+    BOOT_DeferPolicy_t policy;
+} BOOT_DeferEntry_t;
+
+/* Internals */
+static BOOT_MarkEntry_t boot_marks[BOOT_MAX_MARKS];
+static uint8_t boot_mark_count = 0;
+static BOOT_DeferEntry_t boot_deferred[BOOT_MAX_DEFERRED];
+static uint8_t boot_defer_head = 0;
+static uint8_t boot_defer_count = 0;
+static uint32_t boot_overflow_ticks = 0;
+static uint32_t boot_first_sample = 0;
+static bool boot_first_sample_seen = false;
+static bool boot_warm = false;
+
+/* Cuentas de Timer1 desde BOOT_Start, extendidas a 32 bits */
+static uint32_t boot_now(void)
+{
+    #ifdef T1CON
+    uint16_t t = TMR1;
+    if (IFS0bits.T1IF) {
+        /* Desbordó desde la última lectura: releer para no mezclar */
+        IFS0bits.T1IF = 0;
+        boot_overflow_ticks += 0x10000UL;
+        t = TMR1;
+    }
+    return boot_overflow_ticks + t;
+    #else
+    return 0;
+    #endif
+}
+
+static uint32_t boot_ticks_to_us(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * BOOT_TIMER_PRESCALE * 1000000ULL) / FCY);
+}
+
+void BOOT_Start(void)
+{
+    /* Reset en caliente si no hay POR. WDT_LatchResetCause captura RCON y
+       limpia POR/BOR, así que el siguiente reset sin corte de tensión se ve
+       en caliente aunque la aplicación no use WDT_Init */
+    boot_warm = (WDT_LatchResetCause() & WDT_RESET_POR) == 0u;
+
+    #ifdef T1CON
+    T1CON = 0;
+    TMR1 = 0;
+    PR1 = 0xFFFF;
+    T1CONbits.TCKPS = BOOT_TCKPS_256;
+    IFS0bits.T1IF = 0;
+    T1CONbits.TON = 1;
+    #endif
+
+    boot_overflow_ticks = 0;
+    boot_mark_count = 0;
+    boot_defer_head = 0;
+    boot_defer_count = 0;
+    boot_first_sample_seen = false;
+}
+
+void BOOT_Mark(const char *phase)
+{
+    if (boot_mark_count >= BOOT_MAX_MARKS) return;
+    boot_marks[boot_mark_count].name = phase;
+    boot_marks[boot_mark_count].ticks = boot_now();
+    boot_mark_count++;
+}
+
+bool BOOT_IsWarmStart(void)
+{
+    return boot_warm;
+}
+
+bool BOOT_Defer(BOOT_Fn_t fn, const char *name, BOOT_DeferPolicy_t policy)
+{
+    uint8_t slot;
+
+    if (fn == 0) return false;
+    if (policy == BOOT_DEFER_COLD_ONLY && boot_warm) return true;  /* omitido */
+    if (boot_defer_count >= BOOT_MAX_DEFERRED) return false;
+
+    slot = (uint8_t)((boot_defer_head + boot_defer_count) % BOOT_MAX_DEFERRED);
+    boot_deferred[slot].fn = fn;
+    boot_deferred[slot].name = name;
+    boot_deferred[slot].policy = policy;
+    boot_defer_count++;
+    return true;
+}
+
+bool BOOT_RunDeferred(void)
+{
+    BOOT_DeferEntry_t e;
+
+    if (boot_defer_count == 0u) return false;
+    e = boot_deferred[boot_defer_head];
+    boot_defer_head = (uint8_t)((boot_defer_head + 1u) % BOOT_MAX_DEFERRED);
+    boot_defer_count--;
+
+    e.fn();
+    BOOT_Mark(e.name);
+    return true;
+}
+
+void BOOT_FirstSample(void)
+{
+    if (boot_first_sample_seen) return;
+    boot_first_sample = boot_now();
+    boot_first_sample_seen = true;
+}
+
+uint32_t BOOT_GetTimeToFirstSampleUs(void)
+{
+    return boot_first_sample_seen ? boot_ticks_to_us(boot_first_sample) : 0u;
+}
+
+uint32_t BOOT_GetElapsedUs(void)
+{
+    return boot_ticks_to_us(boot_now());
+}
+
+void BOOT_PrintReport(void)
+{
+    #ifdef __XC16__
+    uint32_t prev = 0;
+    uint8_t i;
+
+    printf("Boot (%s start):\r\n", boot_warm ? "warm" : "cold");
+    for (i = 0; i < boot_mark_count; i++) {
+        printf("  %-12s %8lu us (+%lu us)\r\n", boot_marks[i].name,
+               (unsigned long)boot_ticks_to_us(boot_marks[i].ticks),
+               (unsigned long)boot_ticks_to_us(boot_marks[i].ticks - prev));
+        prev = boot_marks[i].ticks;
+    }
+    printf("  First sample: %lu us\r\n", (unsigned long)BOOT_GetTimeToFirstSampleUs());
+    #endif
+}
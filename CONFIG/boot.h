@@ -0,0 +1,64 @@
+/*
+ * boot.h - Perfilado del arranque y trabajo diferido para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Marca con tiempo cada fase de inicialización, difiere el trabajo no
+ *  crítico (impresión de configuración, escaneo de bus...) hasta que el
+ *  pipeline principal ya está funcionando, e informa del tiempo hasta la
+ *  primera muestra.
+ *
+ * Uso:
+ *   BOOT_Start();                                  // lo primero en main
+ *   SYSTEM_Initialize();      BOOT_Mark("system");
+ *   ADC_Init();               BOOT_Mark("adc");
+ *   BOOT_Defer(SYSTEM_PrintConfiguration, "print", BOOT_DEFER_COLD_ONLY);
+ *   ... primera muestra:      BOOT_FirstSample();
+ *   ... bucle principal:      BOOT_RunDeferred();  // una tarea por llamada
+ *
+ * Nota:
+ *  - Base de tiempos: Timer1 a FCY/256 (6.4 us a 40 MIPS). El desborde se
+ *    acumula en cada BOOT_Mark, así que entre dos marcas no deben pasar más
+ *    de 65536 cuentas (~419 ms a 40 MIPS).
+ *  - Arranque en caliente (reset distinto de POR: BOR, WDT, MCLR...): las
+ *    tareas BOOT_DEFER_COLD_ONLY se descartan para volver antes al servicio.
+ *    BOOT_Start lee y limpia las banderas de RCON con WDT_LatchResetCause
+ *    (wdt.c), que comparte la captura con WDT_Init.
+ *
+ ******************************************************************************/
+
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_MAX_MARKS      12u
+#define BOOT_MAX_DEFERRED   8u
+
+typedef void (*BOOT_Fn_t)(void);
+
+typedef enum {
+    BOOT_DEFER_ALWAYS = 0,   /* se ejecuta siempre tras el arranque         */
+    BOOT_DEFER_COLD_ONLY     /* solo tras power-on (se omite en caliente)   */
+} BOOT_DeferPolicy_t;
+
+void BOOT_Start(void);
+void BOOT_Mark(const char *phase);
+bool BOOT_IsWarmStart(void);
+
+/* Encola trabajo no crítico; devuelve false si la cola está llena */
+bool BOOT_Defer(BOOT_Fn_t fn, const char *name, BOOT_DeferPolicy_t policy);
+
+/* Ejecuta la siguiente tarea diferida; devuelve false si no quedaba ninguna */
+bool BOOT_RunDeferred(void);
+
+/* Marca el tiempo hasta la primera muestra útil (solo la primera llamada) */
+void BOOT_FirstSample(void);
+uint32_t BOOT_GetTimeToFirstSampleUs(void);
+
+/* Tiempo desde BOOT_Start en microsegundos */
+uint32_t BOOT_GetElapsedUs(void);
+
+void BOOT_PrintReport(void);
+
+#endif /* BOOT_H */
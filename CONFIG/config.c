@@ -26,6 +26,9 @@
  */
 
 #include "config.h"
+#include "board.h"
+#include "irq.h"
+#include "critical.h"
 #include <xc.h>
 #include <stdint.h>
 #include <stdio.h>  /* usado opcionalmente por SYSTEM_PrintConfiguration */
@@ -38,35 +41,13 @@ static volatile System_State_t system_state = SYS_STATE_INIT;
 /* ------------------------------------------------------------------------- */
 static void ports_init(void)
 {
-    /* Inicializa LATx antes de configurar TRISx para evitar glitches */
-    #ifdef LATB
-    LATB = 0x0000;
-    #endif
+    /* Remapeos PPS de la placa: una sola secuencia unlock/lock por reset */
+    (void)BOARD_PpsInit();
 
-    /* PORTB: si está habilitado, ponemos RB0..RB7 como salidas para leds, si
-       no, dejamos los pines como entradas para ahorro (valor por defecto). */
-    #ifdef CONFIG_PORT_B_ENABLED
-        #ifdef TRISBbits
-            /* Si existen bits individuales, los definimos explícitamente */
-            /* Cuidado: modifica según qué pines estén disponibles en tu encapsulado */
-            TRISBbits.TRISB0 = 0;
-            TRISBbits.TRISB1 = 0;
-            TRISBbits.TRISB2 = 0;
-            TRISBbits.TRISB3 = 0;
-            TRISBbits.TRISB4 = 0;
-            TRISBbits.TRISB5 = 0;
-            TRISBbits.TRISB6 = 0;
-            TRISBbits.TRISB7 = 0;
-        #else
-            /* Si no hay bits individuales, configurar máscara: 0 -> output */
-            TRISB &= (uint16_t)~0x00FF;
-        #endif
-    #else
-        /* Puerto B no habilitado: poner pines como entradas (alta impedancia) */
-        #ifdef TRISB
-            TRISB |= 0x00FF; /* LSB como entradas */
-        #endif
-    #endif
+    /* Los pines no se tocan aquí: cada programa aplica su variante con
+       BOARD_PinsInit() (board.h). Aplicar LEDS por defecto dejaría RB0/RB1
+       como salidas en los programas que los usan como AN2/AN3 (MOTOR). Hasta
+       entonces quedan como entradas (valor de reset). */
 }
 
 /* ------------------------------------------------------------------------- */
@@ -75,20 +56,23 @@ static void ports_init(void)
 
 void SYSTEM_Initialize(void)
 {
-    /* Bloquear interrupciones mientras configuramos */
-    SYSTEM_DisableInterrupts();
+    /* Bloquear interrupciones mientras configuramos (se guarda el IPL) */
+    CRIT_State_t crit = CRIT_Enter(CRIT_LEVEL_ALL);
 
     /* Inicializaciones de puertos y periféricos dependientes de config.h */
     ports_init();
 
+    /* Plan de prioridades de interrupción (irq.c) */
+    IRQ_Init();
+
     /* Inicialización adicional (timers, ADC, UART...) puede hacerse desde
        otros módulos que llamen a sus init específicos. */
 
     /* Estado listo */
     system_state = SYS_STATE_READY;
 
-    /* Restaurar interrupciones si las teníamos activas */
-    SYSTEM_EnableInterrupts();
+    /* Restaurar el IPL de entrada: si venían deshabilitadas, siguen así */
+    CRIT_Exit(crit);
 }
 
 void SYSTEM_Deinitialize(void)
@@ -171,24 +155,16 @@ void SYSTEM_Reset(void)
 
 void SYSTEM_EnableInterrupts(void)
 {
-    /* Habilitar interrupciones globales */
-    /* XC16 built-in */
-    #ifdef __XC16__
-    __builtin_enable_interrupts();
-    #else
-    /* Fallback: set bit GIE si el registro existe */
-    #ifdef INTCON2
-    /* no todos los dispositivos exponen GIE en INTCON2; usar macro si existe */
-    #endif
-    #endif
+    /* Habilitar interrupciones globales: IPL de la CPU a 0.
+       El dsPIC33F no tiene GIE; para secciones críticas usa critical.h */
+    CRIT_Exit(0u);
 }
 
 void SYSTEM_DisableInterrupts(void)
 {
-    /* Deshabilitar interrupciones globales */
-    #ifdef __XC16__
-    __builtin_disable_interrupts();
-    #endif
+    /* Deshabilitar interrupciones globales (IPL 7). No anidable: para
+       secciones críticas usa CRIT_Enter/CRIT_Exit (critical.h) */
+    (void)CRIT_Enter(CRIT_LEVEL_ALL);
 }
 
 uint32_t SYSTEM_GetClockFrequency(void)
@@ -44,7 +44,13 @@
 /* OPCIÓN D: Oscilador externo sin PLL */
 // #define CONFIG_OSC_EXTERNO_SIMPLE
 
-/* 2. WATCHDOG TIMER */
+/* 2. WATCHDOG TIMER
+ *
+ * Nota: con FWDTEN = OFF en los pragmas, WDT_Init (wdt.h) activa el WDT por
+ * software (RCON.SWDTEN). El timeout lo fijan WDTPRE/WDTPOST (LPRC 32 kHz):
+ *  - NORMAL: WDTPRE = PR32,  WDTPOST = PS1024 -> ~1 s
+ *  - LONG  : WDTPRE = PR128, WDTPOST = PS2048 -> ~8 s
+ */
 #define CONFIG_WDT_OFF
 // #define CONFIG_WDT_ON_NORMAL
 // #define CONFIG_WDT_ON_LONG
@@ -71,9 +77,10 @@
 #define CONFIG_CLOCK_SWITCH_OFF
 // #define CONFIG_CLOCK_SWITCH_ON
 
-/* 8. PUERTOS (ahorro de energía / inicialización condicional) */
+/* 8. PUERTOS (ahorro de energía / inicialización condicional)
+   Los pines de la placa los aplica cada programa con BOARD_PinsInit(). */
  // #define CONFIG_PORT_A_ENABLED
-#define CONFIG_PORT_B_ENABLED
+ // #define CONFIG_PORT_B_ENABLED
  // #define CONFIG_PORT_C_ENABLED
  // #define CONFIG_PORT_D_ENABLED
  // #define CONFIG_PORT_E_ENABLED
@@ -165,6 +172,15 @@
 #error "FCY no definido. Revisa la sección de configuración de oscilador en config.h"
 #endif
 
+/* Timeout del watchdog según la opción elegida (ms, valor nominal) */
+#if defined(CONFIG_WDT_ON_NORMAL)
+    #define CONFIG_WDT_TIMEOUT_MS   1024u
+#elif defined(CONFIG_WDT_ON_LONG)
+    #define CONFIG_WDT_TIMEOUT_MS   8192u
+#else
+    #define CONFIG_WDT_TIMEOUT_MS   0u      /* WDT deshabilitado */
+#endif
+
 /* Incluir libpic30.h para usar __delay_ms y __delay_us.
  * Nota: libpic30.h requiere que FCY esté definido antes de incluirlo.
  */
@@ -0,0 +1,95 @@
+/*
+ * critical.h - Secciones críticas anidables para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Dos primitivas en lugar de deshabilitar todas las interrupciones:
+ *
+ *  - CRIT_Enter(nivel) / CRIT_Exit(estado): sube SR.IPL solo hasta el
+ *    nivel de la ISR con la que se comparte el dato (ver irq.h). Las
+ *    fuentes de prioridad mayor siguen entrando. Nunca baja el IPL, así
+ *    que se puede llamar desde una ISR o dentro de otra sección.
+ *
+ *  - CRIT_DisiEnter() / CRIT_DisiExit(estado): DISI bloquea los niveles
+ *    1..6 sin tocar el IPL. Para secuencias de pocas instrucciones; la
+ *    salida restaura la cuenta DISICNT de la entrada, así que un DISI
+ *    exterior (de cualquier longitud) sigue hasta su final.
+ *
+ *  Las secciones deben durar menos de IRQ_MAX_BLOCKING_CYCLES (irq.h),
+ *  que es el bloqueo que asume el simulador de latencia.
+ *
+ * Uso:
+ *   CRIT_State_t s = CRIT_Enter(IRQ_PRIO_SPI);
+ *   ... datos compartidos con la ISR de SPI1 ...
+ *   CRIT_Exit(s);
+ *
+ * Nota:
+ *  - El nivel 7 no lo bloquea DISI: los datos compartidos con una ISR de
+ *    prioridad 7 necesitan CRIT_Enter(CRIT_LEVEL_ALL).
+ *  - En el PC las primitivas no hacen nada (compilación de herramientas).
+ *
+ ******************************************************************************/
+
+#ifndef CRITICAL_H
+#define CRITICAL_H
+
+#include <stdint.h>
+#ifdef __XC16__
+#include <xc.h>
+#endif
+
+typedef uint16_t CRIT_State_t;
+
+/* Bloquea todas las fuentes enmascarables */
+#define CRIT_LEVEL_ALL      7u
+
+/* Sube el IPL a 'level' si está por debajo; devuelve el IPL anterior */
+static inline CRIT_State_t CRIT_Enter(uint8_t level)
+{
+    #ifdef __XC16__
+    CRIT_State_t saved = SRbits.IPL;
+    if (saved < level) {
+        SET_CPU_IPL(level);
+    }
+    return saved;
+    #else
+    (void)level;
+    return 0u;
+    #endif
+}
+
+/* Restaura el IPL guardado por CRIT_Enter */
+static inline void CRIT_Exit(CRIT_State_t saved)
+{
+    #ifdef __XC16__
+    RESTORE_CPU_IPL(saved);
+    #else
+    (void)saved;
+    #endif
+}
+
+/* DISI: bloquea prioridades 1..6; devuelve la cuenta DISICNT anterior
+   (0 si no había un DISI activo) */
+static inline CRIT_State_t CRIT_DisiEnter(void)
+{
+    #ifdef __XC16__
+    CRIT_State_t saved = DISICNT;
+    __builtin_disi(0x3FFF);
+    return saved;
+    #else
+    return 0u;
+    #endif
+}
+
+/* Restaura la cuenta guardada: 0 termina el DISI; si había uno exterior
+   (p. ej. un DISI #n corto) le devuelve lo que le quedaba, sin dejar 0x3FFF.
+   El exterior se alarga lo que duró esta sección: nunca se acorta. */
+static inline void CRIT_DisiExit(CRIT_State_t saved)
+{
+    #ifdef __XC16__
+    DISICNT = saved;
+    #else
+    (void)saved;
+    #endif
+}
+
+#endif /* CRITICAL_H */
@@ -0,0 +1,139 @@
+/*
+ * irq.c - Implementación del plan de prioridades de interrupción (ver irq.h)
+ *
+ ******************************************************************************/
+
+#include "irq.h"
+#include <stddef.h>
+#ifdef __XC16__
+#include <xc.h>
+#endif
+
+#ifndef __XC16__
+#define IRQ_HOST_ONLY   /* en el PC solo se usa la tabla */
+#endif
+
+/* Ciclos a 40 MIPS */
+#define IRQ_US(us)  ((uint32_t)(us) * 40u)
+
+/* Presupuestos: ISR con callbacks de la aplicación incluidos */
+const IRQ_Entry_t IRQ_Table[IRQ_SRC_COUNT] = {
+    /*                priority       ciclos periodo       plazo          */
+    [IRQ_SRC_INT0]  = { IRQ_PRIO_APP,  40,  IRQ_US(1000), IRQ_US(1000), "INT0"  },
+    [IRQ_SRC_T1]    = { IRQ_PRIO_APP,  60,  IRQ_US(1000), IRQ_US(1000), "T1"    },
+    [IRQ_SRC_T2]    = { IRQ_PRIO_APP,  60,  IRQ_US(1000), IRQ_US(1000), "T2"    },
+    [IRQ_SRC_T3]    = { IRQ_PRIO_APP,  60,  IRQ_US(1000), IRQ_US(1000), "T3"    },
+    [IRQ_SRC_SPI1E] = { IRQ_PRIO_SPI,  40,  IRQ_US(100),  0,            "SPI1E" },
+    [IRQ_SRC_SPI1]  = { IRQ_PRIO_SPI,  60,  IRQ_US(10),   0,            "SPI1"  },  /* 16 bits a 1.6 MHz */
+    [IRQ_SRC_U1RX]  = { IRQ_PRIO_UART, 50,  IRQ_US(87),   IRQ_US(348),  "U1RX"  },  /* 115200, FIFO 4    */
+    [IRQ_SRC_U1TX]  = { IRQ_PRIO_UART, 50,  IRQ_US(87),   0,            "U1TX"  },
+    [IRQ_SRC_AD1]   = { IRQ_PRIO_ADC,  400, IRQ_US(50),   IRQ_US(50),   "AD1"   },  /* PWM a 20 kHz      */
+    [IRQ_SRC_SI2C1] = { IRQ_PRIO_I2C,  120, IRQ_US(25),   IRQ_US(22),   "SI2C1" },  /* 1 byte a 400 kHz  */
+    [IRQ_SRC_MI2C1] = { IRQ_PRIO_I2C,  120, IRQ_US(25),   0,            "MI2C1" },
+    [IRQ_SRC_CN]    = { IRQ_PRIO_APP,  40,  IRQ_US(1000), IRQ_US(1000), "CN"    },
+    [IRQ_SRC_PWM1]  = { IRQ_PRIO_PWM,  80,  IRQ_US(50),   IRQ_US(50),   "PWM1"  },
+};
+
+/* Registros de cada fuente: IFSx/IECx (índice, bit) e IPCx (índice, campo) */
+typedef struct {
+    uint8_t ifs;
+    uint8_t bit;
+    uint8_t ipc;
+    uint8_t shift;
+} IRQ_Regs_t;
+
+#ifndef IRQ_HOST_ONLY
+static const IRQ_Regs_t irq_regs[IRQ_SRC_COUNT] = {
+    [IRQ_SRC_INT0]  = { 0, 0,  0,  0 },
+    [IRQ_SRC_T1]    = { 0, 3,  0,  12 },
+    [IRQ_SRC_T2]    = { 0, 7,  1,  12 },
+    [IRQ_SRC_T3]    = { 0, 8,  2,  0 },
+    [IRQ_SRC_SPI1E] = { 0, 9,  2,  4 },
+    [IRQ_SRC_SPI1]  = { 0, 10, 2,  8 },
+    [IRQ_SRC_U1RX]  = { 0, 11, 2,  12 },
+    [IRQ_SRC_U1TX]  = { 0, 12, 3,  0 },
+    [IRQ_SRC_AD1]   = { 0, 13, 3,  4 },
+    [IRQ_SRC_SI2C1] = { 1, 0,  4,  0 },
+    [IRQ_SRC_MI2C1] = { 1, 1,  4,  4 },
+    [IRQ_SRC_CN]    = { 1, 3,  4,  12 },
+    [IRQ_SRC_PWM1]  = { 3, 9,  14, 4 },
+};
+#endif
+
+/* Fuentes que comparten estado y deben ir al mismo nivel */
+static const uint8_t irq_same_level[][2] = {
+    { IRQ_SRC_SI2C1, IRQ_SRC_MI2C1 },   /* driver I2C1          */
+    { IRQ_SRC_SPI1,  IRQ_SRC_SPI1E },   /* cola SPI             */
+    { IRQ_SRC_U1RX,  IRQ_SRC_U1TX  },   /* buffers de la UART   */
+};
+
+void IRQ_Init(void)
+{
+    uint8_t i;
+
+    #ifdef INTCON1bits
+    INTCON1bits.NSTDIS = 0;     /* anidamiento por prioridad */
+    #endif
+    for (i = 0; i < IRQ_SRC_COUNT; i++) {
+        IRQ_SetPriority((IRQ_Source_t)i);
+    }
+}
+
+void IRQ_SetPriority(IRQ_Source_t src)
+{
+    if (src >= IRQ_SRC_COUNT) return;
+    #ifdef __XC16__
+    {
+        volatile uint16_t *ipc = &IPC0 + irq_regs[src].ipc;
+        uint8_t shift = irq_regs[src].shift;
+        *ipc = (uint16_t)((*ipc & ~(7u << shift)) |
+                          ((uint16_t)(IRQ_Table[src].priority & 7u) << shift));
+    }
+    #endif
+}
+
+uint8_t IRQ_GetPriority(IRQ_Source_t src)
+{
+    return (src < IRQ_SRC_COUNT) ? IRQ_Table[src].priority : 0u;
+}
+
+void IRQ_Enable(IRQ_Source_t src, bool enable)
+{
+    if (src >= IRQ_SRC_COUNT) return;
+    #ifdef __XC16__
+    {
+        volatile uint16_t *iec = &IEC0 + irq_regs[src].ifs;
+        uint16_t mask = (uint16_t)(1u << irq_regs[src].bit);
+        if (enable) *iec |= mask;
+        else *iec &= (uint16_t)~mask;
+    }
+    #else
+    (void)enable;
+    #endif
+}
+
+void IRQ_ClearFlag(IRQ_Source_t src)
+{
+    if (src >= IRQ_SRC_COUNT) return;
+    #ifdef __XC16__
+    {
+        volatile uint16_t *ifs = &IFS0 + irq_regs[src].ifs;
+        *ifs &= (uint16_t)~(1u << irq_regs[src].bit);
+    }
+    #endif
+}
+
+IRQ_Source_t IRQ_Validate(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < IRQ_SRC_COUNT; i++) {
+        if (IRQ_Table[i].priority > 7u) return (IRQ_Source_t)i;
+    }
+    for (i = 0; i < sizeof(irq_same_level) / sizeof(irq_same_level[0]); i++) {
+        if (IRQ_Table[irq_same_level[i][0]].priority != IRQ_Table[irq_same_level[i][1]].priority) {
+            return (IRQ_Source_t)irq_same_level[i][1];
+        }
+    }
+    return IRQ_SRC_COUNT;
+}
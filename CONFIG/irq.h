@@ -0,0 +1,88 @@
+/*
+ * irq.h - Plan de prioridades de interrupción para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Tabla única con la prioridad de cada fuente de interrupción usada por
+ *  los drivers (ADC, SPI, I2C, UART, timers, PWM). Los drivers no escriben
+ *  IPCx directamente: llaman a IRQ_SetPriority() con su fuente.
+ *
+ *  Anidamiento: activo (INTCON1.NSTDIS = 0). Una ISR solo es interrumpida
+ *  por fuentes de prioridad mayor; las que comparten estado van al mismo
+ *  nivel para que nunca se interrumpan entre sí (p. ej. MI2C1 y SI2C1).
+ *
+ *  Niveles (7 = máximo, 0 = deshabilitada), por plazo: primero lo que
+ *  pierde datos si llega tarde.
+ *    6  ADC1      lazo de control / muestreo por hardware (determinista)
+ *    5  PWM1      reservado para control de motor
+ *    4  I2C1      esclavo sin clock stretching: un byte (22.5 us a 400 kHz)
+ *    3  UART1     RX con FIFO de 4 caracteres
+ *    2  SPI1      autoritmado: la siguiente palabra no sale hasta que la ISR
+ *                 la escribe, así que un retraso solo baja el caudal
+ *    1  timers de aplicación, CN, INT0
+ *
+ * Nota:
+ *  - Los ciclos por ISR y periodos mínimos de la tabla son presupuestos
+ *    para el simulador de latencia (irq_sim.c), no medidas.
+ *  - IRQ_Validate() y la tabla compilan en el PC.
+ *  - Registros sombra (push.s): un solo nivel, reservados al nivel I2C
+ *    (vectores de i2c_isr.h). Ninguna ISR de otro nivel debe usar 'shadow'.
+ *
+ ******************************************************************************/
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    IRQ_SRC_INT0 = 0,
+    IRQ_SRC_T1,
+    IRQ_SRC_T2,
+    IRQ_SRC_T3,
+    IRQ_SRC_SPI1E,
+    IRQ_SRC_SPI1,
+    IRQ_SRC_U1RX,
+    IRQ_SRC_U1TX,
+    IRQ_SRC_AD1,
+    IRQ_SRC_SI2C1,
+    IRQ_SRC_MI2C1,
+    IRQ_SRC_CN,
+    IRQ_SRC_PWM1,
+    IRQ_SRC_COUNT
+} IRQ_Source_t;
+
+/* Plan de prioridades */
+#define IRQ_PRIO_ADC        6u
+#define IRQ_PRIO_PWM        5u
+#define IRQ_PRIO_I2C        4u
+#define IRQ_PRIO_UART       3u
+#define IRQ_PRIO_SPI        2u
+#define IRQ_PRIO_APP        1u
+
+typedef struct {
+    uint8_t priority;       /* 1..7 (0: nunca interrumpe)                  */
+    uint16_t isr_cycles;    /* presupuesto de la ISR (incluye contexto)    */
+    uint32_t min_period;    /* separación mínima entre peticiones (ciclos) */
+    uint32_t deadline;      /* respuesta máxima sin perder datos (ciclos);
+                               0 = autoritmada (la siguiente petición llega
+                               min_period después de terminar la ISR)      */
+    const char *name;
+} IRQ_Entry_t;
+
+extern const IRQ_Entry_t IRQ_Table[IRQ_SRC_COUNT];
+
+/* Ciclos máximos con interrupciones bloqueadas (DISI / secciones críticas) */
+#define IRQ_MAX_BLOCKING_CYCLES 32u
+
+void IRQ_Init(void);
+void IRQ_SetPriority(IRQ_Source_t src);
+uint8_t IRQ_GetPriority(IRQ_Source_t src);
+void IRQ_Enable(IRQ_Source_t src, bool enable);
+void IRQ_ClearFlag(IRQ_Source_t src);
+
+/* Comprueba el plan: prioridades en rango y fuentes que comparten estado
+ * en el mismo nivel. Devuelve la fuente errónea o IRQ_SRC_COUNT. */
+IRQ_Source_t IRQ_Validate(void);
+
+#endif /* IRQ_H */
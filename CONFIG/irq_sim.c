@@ -0,0 +1,209 @@
+/*
+ * irq_sim.c - Simulador de latencia de interrupciones en el PC
+ *
+ * Descripción:
+ *  Simula ciclo a ciclo el controlador de interrupciones del dsPIC33F con
+ *  el plan de irq.c: anidamiento por prioridad, orden natural (vector más
+ *  bajo primero) dentro del mismo nivel, 5 ciclos de entrada y ventanas
+ *  de bloqueo (DISI) de IRQ_MAX_BLOCKING_CYCLES desde el bucle principal.
+ *  Cada fuente pide servicio con su separación mínima más un jitter
+ *  aleatorio; las autoritmadas (plazo 0) vuelven a pedir min_period
+ *  después de terminar su ISR. Una ejecución adicional arranca todas a
+ *  la vez (instante crítico).
+ *
+ *  Informa por fuente y por nivel de prioridad de la peor latencia
+ *  (petición -> primera instrucción de la ISR), la peor respuesta
+ *  (petición -> fin de la ISR), las peticiones perdidas (bandera ya
+ *  activa o respuesta fuera de plazo) y la cota analítica de tiempo de
+ *  respuesta.
+ *
+ * Compilar:
+ *   gcc -O2 -I. -o irq_sim irq_sim.c irq.c && ./irq_sim [ejecuciones]
+ *
+ *  Devuelve 1 si alguna fuente pierde peticiones o el plan no es válido.
+ *
+ ******************************************************************************/
+
+#include "irq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define SIM_ENTRY_CYCLES    5u
+#define SIM_CYCLES          400000UL
+#define SIM_BLOCK_PERIOD    2000u       /* una sección crítica cada ~50 us */
+#define SIM_MAX_NEST        8
+
+typedef struct {
+    uint32_t next_req;      /* ciclo de la próxima petición          */
+    uint32_t req_time;      /* ciclo de la petición pendiente        */
+    uint32_t left;          /* ciclos que le quedan a la ISR activa  */
+    int pending;
+    int active;
+    uint32_t worst_latency;
+    uint32_t worst_response;
+    uint32_t lost;
+    uint32_t late;
+    uint32_t served;
+} SimSrc_t;
+
+static SimSrc_t src[IRQ_SRC_COUNT];
+
+static uint32_t jitter(uint32_t period)
+{
+    return (uint32_t)(rand() % (int)(period / 2u + 1u));
+}
+
+static void run(int critical_instant)
+{
+    int stack[SIM_MAX_NEST];
+    int depth = 0;
+    uint32_t block_left = 0;
+    uint32_t t;
+    int i;
+
+    for (i = 0; i < IRQ_SRC_COUNT; i++) {
+        src[i].next_req = critical_instant ? 0u : jitter(IRQ_Table[i].min_period) * 2u;
+        src[i].pending = 0;
+        src[i].active = 0;
+    }
+
+    for (t = 0; t < SIM_CYCLES; t++) {
+        int cur_prio = depth ? IRQ_Table[stack[depth - 1]].priority : 0;
+        int best = -1;
+
+        /* Peticiones nuevas */
+        for (i = 0; i < IRQ_SRC_COUNT; i++) {
+            if (IRQ_Table[i].priority == 0 || t < src[i].next_req) continue;
+            if (src[i].pending) src[i].lost++;
+            else {
+                src[i].pending = 1;
+                src[i].req_time = t;
+            }
+            if (IRQ_Table[i].deadline == 0u) {
+                src[i].next_req = UINT32_MAX;   /* hasta que termine la ISR */
+            } else {
+                src[i].next_req = t + IRQ_Table[i].min_period +
+                                  (critical_instant ? 0u : jitter(IRQ_Table[i].min_period));
+            }
+        }
+
+        /* Bucle principal: sección crítica ocasional (solo a nivel 0) */
+        if (depth == 0 && block_left == 0 && (rand() % SIM_BLOCK_PERIOD) == 0) {
+            block_left = IRQ_MAX_BLOCKING_CYCLES;
+        }
+
+        /* Arbitraje: mayor prioridad; empate -> vector más bajo */
+        if (block_left == 0) {
+            for (i = 0; i < IRQ_SRC_COUNT; i++) {
+                if (!src[i].pending) continue;
+                if (IRQ_Table[i].priority <= cur_prio) continue;
+                if (best < 0 || IRQ_Table[i].priority > IRQ_Table[best].priority) best = i;
+            }
+        }
+        if (best >= 0 && depth < SIM_MAX_NEST) {
+            uint32_t lat = t - src[best].req_time + SIM_ENTRY_CYCLES;
+            if (lat > src[best].worst_latency) src[best].worst_latency = lat;
+            src[best].pending = 0;
+            src[best].active = 1;
+            src[best].left = SIM_ENTRY_CYCLES + IRQ_Table[best].isr_cycles;
+            stack[depth++] = best;
+        }
+
+        /* Ejecutar un ciclo de la ISR activa o de la sección crítica */
+        if (depth > 0) {
+            const IRQ_Entry_t *e = &IRQ_Table[stack[depth - 1]];
+            SimSrc_t *s = &src[stack[depth - 1]];
+            if (--s->left == 0) {
+                uint32_t resp = t + 1u - s->req_time;
+                if (resp > s->worst_response) s->worst_response = resp;
+                if (e->deadline == 0u) s->next_req = t + 1u + e->min_period;
+                else if (resp > e->deadline) s->late++;
+                s->active = 0;
+                s->served++;
+                depth--;
+            }
+        } else if (block_left > 0) {
+            block_left--;
+        }
+    }
+}
+
+/* Cota analítica (respuesta con anidamiento y bloqueo de mismo nivel) */
+static uint32_t rta(int k)
+{
+    uint32_t c = SIM_ENTRY_CYCLES + IRQ_Table[k].isr_cycles;
+    uint32_t b = IRQ_MAX_BLOCKING_CYCLES;
+    uint32_t r = c + b, prev = 0;
+    int j;
+
+    for (j = 0; j < IRQ_SRC_COUNT; j++) {
+        /* Una instancia de cada fuente del mismo nivel puede ir antes */
+        if (j != k && IRQ_Table[j].priority == IRQ_Table[k].priority) {
+            b += SIM_ENTRY_CYCLES + IRQ_Table[j].isr_cycles;
+        }
+    }
+    r = c + b;
+    while (r != prev && r < 100u * IRQ_Table[k].min_period) {
+        prev = r;
+        r = c + b;
+        for (j = 0; j < IRQ_SRC_COUNT; j++) {
+            if (IRQ_Table[j].priority > IRQ_Table[k].priority) {
+                uint32_t n = (prev + IRQ_Table[j].min_period - 1u) / IRQ_Table[j].min_period;
+                r += n * (SIM_ENTRY_CYCLES + IRQ_Table[j].isr_cycles);
+            }
+        }
+    }
+    return r;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = (argc > 1) ? atoi(argv[1]) : 20;
+    int i, lvl, fail = 0;
+    IRQ_Source_t bad = IRQ_Validate();
+    double load = 0.0;
+
+    if (bad != IRQ_SRC_COUNT) {
+        printf("plan no válido: %s fuera de nivel\n", IRQ_Table[bad].name);
+        return 1;
+    }
+
+    memset(src, 0, sizeof(src));
+    srand(1);
+    run(1);
+    for (i = 0; i < runs; i++) run(0);
+
+    printf("fuente  prio  ciclos  periodo   plazo  lat.max  resp.max   cota  perdidas\n");
+    for (i = 0; i < IRQ_SRC_COUNT; i++) {
+        const IRQ_Entry_t *e = &IRQ_Table[i];
+        uint32_t bound = rta(i);
+        uint32_t miss = src[i].lost + src[i].late;
+        int over = e->deadline != 0u && bound > e->deadline;
+        load += (double)(e->isr_cycles + SIM_ENTRY_CYCLES) / e->min_period;
+        printf("%-6s  %4u  %6u  %7lu  %6lu  %7lu  %8lu  %5lu  %8lu%s\n", e->name, e->priority,
+               e->isr_cycles, (unsigned long)e->min_period, (unsigned long)e->deadline,
+               (unsigned long)src[i].worst_latency, (unsigned long)src[i].worst_response,
+               (unsigned long)bound, (unsigned long)miss, over ? "  <- no cumple" : "");
+        if (miss || over) fail = 1;
+    }
+
+    printf("\nnivel  lat.max (us)  resp.max (us)\n");
+    for (lvl = 7; lvl >= 1; lvl--) {
+        uint32_t lat = 0, resp = 0;
+        int any = 0;
+        for (i = 0; i < IRQ_SRC_COUNT; i++) {
+            if (IRQ_Table[i].priority != lvl) continue;
+            any = 1;
+            if (src[i].worst_latency > lat) lat = src[i].worst_latency;
+            if (src[i].worst_response > resp) resp = src[i].worst_response;
+        }
+        if (any) printf("%5d  %12.2f  %13.2f\n", lvl, lat / 40.0, resp / 40.0);
+    }
+    /* MI2C1 y SI2C1 no coinciden: el módulo es maestro o esclavo */
+    load -= (double)(IRQ_Table[IRQ_SRC_SI2C1].isr_cycles + SIM_ENTRY_CYCLES) /
+            IRQ_Table[IRQ_SRC_SI2C1].min_period;
+    printf("\ncarga total de CPU en ISR: %.1f %%\n", load * 100.0);
+    return fail;
+}
@@ -0,0 +1,176 @@
+/*
+ * pins.c - Implementación de la configuración declarativa de pines (ver pins.h)
+ *
+ ******************************************************************************/
+
+#include "pins.h"
+#include <stddef.h>
+#ifdef __XC16__
+#include <xc.h>
+#endif
+
+/* Pines presentes en el encapsulado de 44 pines */
+static const uint16_t pin_present[PIN_PORT_COUNT] = {
+    0x079Fu,    /* RA0..RA4, RA7..RA10 */
+    0xFFFFu,    /* RB0..RB15           */
+    0x03FFu     /* RC0..RC9            */
+};
+
+typedef struct {
+    uint8_t port;
+    uint8_t bit;
+} PIN_AnalogMap_t;
+
+/* ANx -> pin físico */
+static const PIN_AnalogMap_t pin_an_map[] = {
+    { PIN_PORT_A, 0 }, { PIN_PORT_A, 1 },                       /* AN0, AN1 */
+    { PIN_PORT_B, 0 }, { PIN_PORT_B, 1 },                       /* AN2, AN3 */
+    { PIN_PORT_B, 2 }, { PIN_PORT_B, 3 },                       /* AN4, AN5 */
+    { PIN_PORT_C, 0 }, { PIN_PORT_C, 1 }, { PIN_PORT_C, 2 }     /* AN6..AN8 */
+};
+
+#define PIN_AN_COUNT  (sizeof(pin_an_map) / sizeof(pin_an_map[0]))
+
+bool PIN_Exists(uint8_t port, uint8_t bit)
+{
+    if (port >= PIN_PORT_COUNT || bit > 15u) return false;
+    return (pin_present[port] & (1u << bit)) != 0u;
+}
+
+int8_t PIN_AnalogChannel(uint8_t port, uint8_t bit)
+{
+    uint8_t i;
+    for (i = 0; i < PIN_AN_COUNT; i++) {
+        if (pin_an_map[i].port == port && pin_an_map[i].bit == bit) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+static bool pin_selected(const PIN_Desc_t *d, uint8_t groups)
+{
+    return (PIN_GROUP_MASK(d->group) & groups) != 0u;
+}
+
+PIN_Status_t PIN_Validate(const PIN_Desc_t *table, uint8_t count,
+                          uint8_t groups, uint8_t *bad_index)
+{
+    uint8_t i, j;
+    PIN_Status_t st = PIN_OK;
+
+    for (i = 0; i < count && st == PIN_OK; i++) {
+        const PIN_Desc_t *d = &table[i];
+        if (!pin_selected(d, groups)) continue;
+
+        if (!PIN_Exists(d->port, d->bit)) {
+            st = PIN_ERR_NO_PIN;
+        } else if ((d->flags & PIN_ANALOG) && PIN_AnalogChannel(d->port, d->bit) < 0) {
+            st = PIN_ERR_NOT_ANALOG;
+        } else if ((d->flags & PIN_ANALOG) && (d->flags & (PIN_OUT | PIN_OPEN_DRAIN))) {
+            st = PIN_ERR_ANALOG_OUTPUT;
+        } else if ((d->flags & (PIN_OPEN_DRAIN | PIN_INIT_HIGH)) && !(d->flags & PIN_OUT)) {
+            st = PIN_ERR_OD_INPUT;
+        } else {
+            /* Un pin puede repetirse entre grupos solo con los mismos atributos */
+            for (j = 0; j < i; j++) {
+                const PIN_Desc_t *p = &table[j];
+                if (pin_selected(p, groups) && p->port == d->port &&
+                    p->bit == d->bit && p->flags != d->flags) {
+                    st = PIN_ERR_CONFLICT;
+                    break;
+                }
+            }
+        }
+        if (st != PIN_OK && bad_index != NULL) *bad_index = i;
+    }
+    return st;
+}
+
+void PIN_Apply(const PIN_Desc_t *table, uint8_t count, uint8_t groups)
+{
+    uint16_t mask[PIN_PORT_COUNT] = { 0 };      /* pines tocados            */
+    uint16_t out[PIN_PORT_COUNT] = { 0 };       /* 1 -> salida              */
+    uint16_t high[PIN_PORT_COUNT] = { 0 };      /* LATx inicial a 1         */
+    uint16_t od[PIN_PORT_COUNT] = { 0 };        /* open-drain               */
+    uint16_t an_mask = 0;                       /* PCFGx tocados            */
+    uint16_t an_on = 0;                         /* PCFGx = 0 (analógico)    */
+    uint8_t i;
+
+    /* 1) Acumular máscaras: ningún registro se toca en este bucle */
+    for (i = 0; i < count; i++) {
+        const PIN_Desc_t *d = &table[i];
+        uint16_t b;
+        int8_t an;
+
+        if (!pin_selected(d, groups) || !PIN_Exists(d->port, d->bit)) continue;
+        b = (uint16_t)(1u << d->bit);
+        mask[d->port] |= b;
+        if (d->flags & PIN_OUT) out[d->port] |= b;
+        if (d->flags & PIN_INIT_HIGH) high[d->port] |= b;
+        if (d->flags & PIN_OPEN_DRAIN) od[d->port] |= b;
+
+        an = PIN_AnalogChannel(d->port, d->bit);
+        if (an >= 0) {
+            an_mask |= (uint16_t)(1u << an);
+            if (d->flags & PIN_ANALOG) an_on |= (uint16_t)(1u << an);
+        }
+    }
+
+    /* 2) Un acceso por registro: LAT antes que TRIS para evitar glitches */
+    #ifdef LATA
+    LATA = (uint16_t)((LATA & ~mask[PIN_PORT_A]) | high[PIN_PORT_A]);
+    #endif
+    #ifdef LATB
+    LATB = (uint16_t)((LATB & ~mask[PIN_PORT_B]) | high[PIN_PORT_B]);
+    #endif
+    #ifdef LATC
+    LATC = (uint16_t)((LATC & ~mask[PIN_PORT_C]) | high[PIN_PORT_C]);
+    #endif
+
+    #ifdef ODCA
+    ODCA = (uint16_t)((ODCA & ~mask[PIN_PORT_A]) | od[PIN_PORT_A]);
+    #endif
+    #ifdef ODCB
+    ODCB = (uint16_t)((ODCB & ~mask[PIN_PORT_B]) | od[PIN_PORT_B]);
+    #endif
+    #ifdef ODCC
+    ODCC = (uint16_t)((ODCC & ~mask[PIN_PORT_C]) | od[PIN_PORT_C]);
+    #endif
+
+    /* AD1PCFGL: 0 -> analógico, 1 -> digital */
+    #ifdef AD1PCFGL
+    AD1PCFGL = (uint16_t)((AD1PCFGL | an_mask) & ~an_on);
+    #else
+    (void)an_mask;
+    (void)an_on;
+    #endif
+
+    /* TRISx: 0 -> salida */
+    #ifdef TRISA
+    TRISA = (uint16_t)((TRISA | mask[PIN_PORT_A]) & ~out[PIN_PORT_A]);
+    #endif
+    #ifdef TRISB
+    TRISB = (uint16_t)((TRISB | mask[PIN_PORT_B]) & ~out[PIN_PORT_B]);
+    #endif
+    #ifdef TRISC
+    TRISC = (uint16_t)((TRISC | mask[PIN_PORT_C]) & ~out[PIN_PORT_C]);
+    #endif
+
+    #ifndef __XC16__
+    (void)mask; (void)out; (void)high; (void)od;
+    #endif
+}
+
+const char *PIN_StatusString(PIN_Status_t status)
+{
+    switch (status) {
+        case PIN_OK:                return "OK";
+        case PIN_ERR_NO_PIN:        return "pin inexistente";
+        case PIN_ERR_NOT_ANALOG:    return "pin sin entrada analógica";
+        case PIN_ERR_ANALOG_OUTPUT: return "analógico configurado como salida";
+        case PIN_ERR_OD_INPUT:      return "open-drain/INIT_HIGH sin PIN_OUT";
+        case PIN_ERR_CONFLICT:      return "pin repetido con otra configuración";
+        default:                    return "?";
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * pins.h - Configuración declarativa de pines para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Cada pin se describe con una entrada de tabla (puerto, bit, dirección,
+ *  analógico/digital, open-drain, valor inicial) y un grupo. PIN_Apply()
+ *  recorre la tabla una sola vez, acumula máscaras por puerto y escribe cada
+ *  registro (LATx, ODCx, AD1PCFGL, TRISx) una única vez, en ese orden para
+ *  no generar glitches en las salidas.
+ *
+ *  PIN_Validate() no toca registros: compila igual en el PC (gcc) para
+ *  comprobar tablas de placa antes de grabarlas (ver board_check.c).
+ *
+ * Uso:
+ *   static const PIN_Desc_t pins[] = {
+ *       PIN_DESC(PIN_PORT_A, 0, PIN_ANALOG, GRUPO_POT),
+ *       PIN_DESC(PIN_PORT_B, 0, PIN_OUT,    GRUPO_LEDS),
+ *   };
+ *   if (PIN_Validate(pins, 2, GRUPO_POT | GRUPO_LEDS, NULL) == PIN_OK)
+ *       PIN_Apply(pins, 2, GRUPO_POT | GRUPO_LEDS);
+ *
+ * Nota:
+ *  - Pines del encapsulado de 44 pines: RA0..RA4, RA7..RA10, RB0..RB15,
+ *    RC0..RC9. Entradas analógicas AN0..AN8 (RA0, RA1, RB0..RB3, RC0..RC2).
+ *  - Las tablas de remapeo (PPS) no forman parte de esta descripción.
+ *
+ ******************************************************************************/
+
+#ifndef PINS_H
+#define PINS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    PIN_PORT_A = 0,
+    PIN_PORT_B,
+    PIN_PORT_C,
+    PIN_PORT_COUNT
+} PIN_Port_t;
+
+/* Atributos de un pin (combinables con |) */
+#define PIN_IN          0x00u   /* entrada digital (valor por defecto)      */
+#define PIN_OUT         0x01u   /* salida                                   */
+#define PIN_ANALOG      0x02u   /* entrada analógica (ANx), implica entrada */
+#define PIN_OPEN_DRAIN  0x04u   /* salida open-drain (ODCx)                 */
+#define PIN_INIT_HIGH   0x08u   /* LATx = 1 antes de habilitar la salida    */
+
+typedef struct {
+    uint8_t port;    /* PIN_Port_t                                    */
+    uint8_t bit;     /* 0..15                                         */
+    uint8_t flags;   /* PIN_IN / PIN_OUT / PIN_ANALOG / ...           */
+    uint8_t group;   /* bit de grupo para seleccionar variantes (0..7)*/
+} PIN_Desc_t;
+
+#define PIN_DESC(port, bit, flags, group) \
+    { (uint8_t)(port), (uint8_t)(bit), (uint8_t)(flags), (uint8_t)(group) }
+
+#define PIN_GROUP_MASK(group)   ((uint8_t)(1u << (group)))
+#define PIN_ANY_GROUP           0xFFu
+
+typedef enum {
+    PIN_OK = 0,
+    PIN_ERR_NO_PIN,         /* el pin no existe en este encapsulado        */
+    PIN_ERR_NOT_ANALOG,     /* PIN_ANALOG en un pin sin entrada ANx        */
+    PIN_ERR_ANALOG_OUTPUT,  /* analógico combinado con salida/open-drain   */
+    PIN_ERR_OD_INPUT,       /* open-drain o INIT_HIGH sin PIN_OUT          */
+    PIN_ERR_CONFLICT        /* mismo pin repetido con atributos distintos  */
+} PIN_Status_t;
+
+/* Comprueba las entradas de los grupos seleccionados. Si 'bad_index' no es
+ * NULL recibe el índice de la primera entrada errónea. */
+PIN_Status_t PIN_Validate(const PIN_Desc_t *table, uint8_t count,
+                          uint8_t groups, uint8_t *bad_index);
+
+/* Aplica las entradas de los grupos seleccionados (sin validar) */
+void PIN_Apply(const PIN_Desc_t *table, uint8_t count, uint8_t groups);
+
+/* Número de ANx del pin, o -1 si no tiene entrada analógica */
+int8_t PIN_AnalogChannel(uint8_t port, uint8_t bit);
+bool PIN_Exists(uint8_t port, uint8_t bit);
+
+const char *PIN_StatusString(PIN_Status_t status);
+
+#endif /* PINS_H */
@@ -0,0 +1,139 @@
+/*
+ * pps.c - Implementación del gestor PPS (ver pps.h)
+ *
+ ******************************************************************************/
+
+#include "pps.h"
+#include "pins.h"
+#include <stddef.h>
+#ifdef __XC16__
+#include <xc.h>
+#endif
+
+#define PPS_IOLOCK_BIT   0x40u   /* OSCCON<6> */
+
+/* Campos RPINRx existentes (máscara de desplazamientos válidos por registro) */
+static const uint8_t pps_rpinr_fields[PPS_RPINR_COUNT] = {
+    0x2, 0x1, 0x0, 0x3, 0x0, 0x0, 0x0, 0x3,     /* RPINR0..7   */
+    0x0, 0x0, 0x3, 0x1, 0x1, 0x1, 0x3, 0x1,     /* RPINR8..15  */
+    0x0, 0x0, 0x3, 0x0, 0x3, 0x1                /* RPINR16..21 */
+};
+
+static bool pps_locked = false;
+
+static bool pps_input_valid(uint8_t func)
+{
+    uint8_t reg = (uint8_t)(func >> 1);
+
+    if (reg >= PPS_RPINR_COUNT) return false;
+    return (pps_rpinr_fields[reg] & ((func & 1u) ? 0x2u : 0x1u)) != 0u;
+}
+
+static bool pps_output_valid(uint8_t func)
+{
+    switch (func) {
+        case PPS_OUT_NULL:  case PPS_OUT_C1OUT: case PPS_OUT_C2OUT:
+        case PPS_OUT_U1TX:  case PPS_OUT_U1RTS: case PPS_OUT_SDO1:
+        case PPS_OUT_SCK1:  case PPS_OUT_SS1:   case PPS_OUT_OC1:
+        case PPS_OUT_OC2:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool PPS_RpToPin(uint8_t rp, uint8_t *port, uint8_t *bit)
+{
+    if (rp > PPS_MAX_RP) return false;
+    if (rp < 16u) {
+        *port = PIN_PORT_B;
+        *bit = rp;
+    } else {
+        *port = PIN_PORT_C;
+        *bit = (uint8_t)(rp - 16u);
+    }
+    return true;
+}
+
+PPS_Status_t PPS_Validate(const PPS_Map_t *map, uint8_t count, uint8_t *bad_index)
+{
+    uint8_t i, j;
+    PPS_Status_t st = PPS_OK;
+
+    for (i = 0; i < count && st == PPS_OK; i++) {
+        const PPS_Map_t *m = &map[i];
+
+        if (m->rp > PPS_MAX_RP) {
+            st = PPS_ERR_NO_RP;
+        } else if (m->output ? !pps_output_valid(m->func) : !pps_input_valid(m->func)) {
+            st = PPS_ERR_BAD_FUNC;
+        } else {
+            for (j = 0; j < i; j++) {
+                const PPS_Map_t *p = &map[j];
+                if (p->output != m->output) continue;
+                if (m->output && p->rp == m->rp) { st = PPS_ERR_RP_TWICE; break; }
+                if (!m->output && p->func == m->func) { st = PPS_ERR_INPUT_TWICE; break; }
+            }
+        }
+        if (st != PPS_OK && bad_index != NULL) *bad_index = i;
+    }
+    return st;
+}
+
+PPS_Status_t PPS_Apply(const PPS_Map_t *map, uint8_t count, bool lock)
+{
+    PPS_Status_t st;
+    uint8_t i;
+
+    if (pps_locked) return PPS_ERR_LOCKED;
+    st = PPS_Validate(map, count, NULL);
+    if (st != PPS_OK) return st;
+
+    #ifdef __XC16__
+    /* Unlock: secuencia protegida de OSCCONL */
+    __builtin_write_OSCCONL(OSCCON & (uint8_t)~PPS_IOLOCK_BIT);
+
+    for (i = 0; i < count; i++) {
+        const PPS_Map_t *m = &map[i];
+        volatile uint16_t *reg;
+        uint8_t shift;
+
+        if (m->output) {
+            reg = &RPOR0 + (m->rp >> 1);
+            shift = (uint8_t)((m->rp & 1u) ? 8u : 0u);
+        } else {
+            reg = &RPINR0 + (m->func >> 1);
+            shift = (uint8_t)((m->func & 1u) ? 8u : 0u);
+        }
+        *reg = (uint16_t)((*reg & ~(0x1Fu << shift)) |
+                          ((uint16_t)((m->output ? m->func : m->rp) & 0x1Fu) << shift));
+    }
+
+    if (lock) {
+        __builtin_write_OSCCONL(OSCCON | PPS_IOLOCK_BIT);
+    }
+    #else
+    (void)i;
+    #endif
+
+    pps_locked = lock;
+    return PPS_OK;
+}
+
+bool PPS_IsLocked(void)
+{
+    return pps_locked;
+}
+
+const char *PPS_StatusString(PPS_Status_t status)
+{
+    switch (status) {
+        case PPS_OK:              return "OK";
+        case PPS_ERR_NO_RP:       return "RP inexistente";
+        case PPS_ERR_BAD_FUNC:    return "función PPS no válida";
+        case PPS_ERR_RP_TWICE:    return "dos salidas en el mismo RP";
+        case PPS_ERR_INPUT_TWICE: return "entrada asignada dos veces";
+        case PPS_ERR_LOCKED:      return "PPS ya bloqueado";
+        default:                  return "?";
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * pps.h - Gestor de Peripheral Pin Select (PPS) para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Aplica una tabla completa de remapeos (entradas RPINRx y salidas RPORx)
+ *  dentro de una única secuencia unlock/lock de IOLOCK. Con IOL1WAY = ON
+ *  (pragmas de configuración) IOLOCK solo puede desbloquearse una vez por
+ *  reset: toda la tabla debe aplicarse de una vez, al arrancar.
+ *
+ * Uso:
+ *   static const PPS_Map_t map[] = {
+ *       PPS_INPUT(PPS_IN_U1RX, 21),       // U1RX <- RP21
+ *       PPS_OUTPUT(PPS_OUT_U1TX, 20),     // RP20 <- U1TX
+ *   };
+ *   st = PPS_Apply(map, 2, true);          // valida, desbloquea, escribe, bloquea
+ *
+ * Nota:
+ *  - Pines remapeables: RP0..RP15 = RB0..RB15, RP16..RP25 = RC0..RC9.
+ *  - RP0..RP3 y RP16..RP18 comparten pin con AN2..AN5/AN6..AN8: deben
+ *    declararse digitales en la tabla de pines (board.c).
+ *  - PPS_Validate no toca registros y compila en el PC.
+ *
+ ******************************************************************************/
+
+#ifndef PPS_H
+#define PPS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PPS_MAX_RP        25u
+#define PPS_RP_NONE       0x1Fu     /* entrada sin asignar (Vss) */
+
+/* Entradas remapeables: (índice de RPINRx << 1) | campo alto (bits 12:8) */
+#define PPS_IN_CODE(reg, shift)   ((uint8_t)(((reg) << 1) | ((shift) >> 3)))
+#define PPS_IN_INT1     PPS_IN_CODE(0, 8)
+#define PPS_IN_INT2     PPS_IN_CODE(1, 0)
+#define PPS_IN_T2CK     PPS_IN_CODE(3, 0)
+#define PPS_IN_T3CK     PPS_IN_CODE(3, 8)
+#define PPS_IN_IC1      PPS_IN_CODE(7, 0)
+#define PPS_IN_IC2      PPS_IN_CODE(7, 8)
+#define PPS_IN_IC7      PPS_IN_CODE(10, 0)
+#define PPS_IN_IC8      PPS_IN_CODE(10, 8)
+#define PPS_IN_OCFA     PPS_IN_CODE(11, 0)
+#define PPS_IN_FLTA1    PPS_IN_CODE(12, 0)
+#define PPS_IN_FLTA2    PPS_IN_CODE(13, 0)
+#define PPS_IN_QEA1     PPS_IN_CODE(14, 0)
+#define PPS_IN_QEB1     PPS_IN_CODE(14, 8)
+#define PPS_IN_INDX1    PPS_IN_CODE(15, 0)
+#define PPS_IN_U1RX     PPS_IN_CODE(18, 0)
+#define PPS_IN_U1CTS    PPS_IN_CODE(18, 8)
+#define PPS_IN_SDI1     PPS_IN_CODE(20, 0)
+#define PPS_IN_SCK1     PPS_IN_CODE(20, 8)
+#define PPS_IN_SS1      PPS_IN_CODE(21, 0)
+#define PPS_RPINR_COUNT 22u
+
+/* Funciones de salida (valor de RPnR) */
+#define PPS_OUT_NULL    0u
+#define PPS_OUT_C1OUT   1u
+#define PPS_OUT_C2OUT   2u
+#define PPS_OUT_U1TX    3u
+#define PPS_OUT_U1RTS   4u
+#define PPS_OUT_SDO1    7u
+#define PPS_OUT_SCK1    8u
+#define PPS_OUT_SS1     9u
+#define PPS_OUT_OC1     18u
+#define PPS_OUT_OC2     19u
+
+typedef struct {
+    uint8_t output;   /* true: RP<- función de salida; false: entrada <- RP */
+    uint8_t func;     /* PPS_IN_xxx o PPS_OUT_xxx                         */
+    uint8_t rp;       /* 0..PPS_MAX_RP                                    */
+} PPS_Map_t;
+
+#define PPS_INPUT(func, rp)   { 0u, (uint8_t)(func), (uint8_t)(rp) }
+#define PPS_OUTPUT(func, rp)  { 1u, (uint8_t)(func), (uint8_t)(rp) }
+
+typedef enum {
+    PPS_OK = 0,
+    PPS_ERR_NO_RP,          /* RP inexistente en este dispositivo           */
+    PPS_ERR_BAD_FUNC,       /* código de función no válido                  */
+    PPS_ERR_RP_TWICE,       /* dos salidas en el mismo RP                   */
+    PPS_ERR_INPUT_TWICE,    /* misma entrada asignada dos veces             */
+    PPS_ERR_LOCKED          /* ya aplicado y bloqueado (IOL1WAY)            */
+} PPS_Status_t;
+
+PPS_Status_t PPS_Validate(const PPS_Map_t *map, uint8_t count, uint8_t *bad_index);
+
+/* Valida y aplica la tabla en una sola secuencia unlock/lock. Con 'lock'
+ * a true deja IOLOCK activo; ya no se admiten más llamadas. */
+PPS_Status_t PPS_Apply(const PPS_Map_t *map, uint8_t count, bool lock);
+
+bool PPS_IsLocked(void);
+
+/* RPn -> puerto/bit (PIN_Port_t de pins.h); false si no existe */
+bool PPS_RpToPin(uint8_t rp, uint8_t *port, uint8_t *bit);
+
+const char *PPS_StatusString(PPS_Status_t status);
+
+#endif /* PPS_H */
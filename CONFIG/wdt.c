@@ -0,0 +1,149 @@
+/*
+ * wdt.c - Implementación del supervisor del watchdog (ver wdt.h)
+ *
+ * Descripción:
+ *  Cada tarea tiene un contador de vueltas de WDT_Service que se recarga
+ *  con su plazo en cada check-in. Los check-ins se marcan en una máscara
+ *  (una instrucción BSET, segura desde ISR) y se consumen en WDT_Service.
+ *
+ ******************************************************************************/
+
+#include "wdt.h"
+#include "config.h"
+#include <xc.h>
+#include <stdio.h>  /* usado opcionalmente por WDT_PrintResetCause */
+
+typedef struct {
+    uint16_t deadline;   /* plazo en vueltas de WDT_Service */
+    uint16_t remaining;
+} WDT_Task_t;
+
+/* Internals */
+static WDT_Task_t wdt_tasks[WDT_MAX_TASKS];
+static uint8_t wdt_task_count = 0;
+static volatile uint16_t wdt_checkins = 0;
+static uint16_t wdt_expired = 0;
+static uint16_t wdt_reset_cause = 0;
+static bool wdt_cause_latched = false;
+
+static uint16_t wdt_ticks(uint16_t deadline_ms)
+{
+    uint16_t t = (uint16_t)((deadline_ms + WDT_SERVICE_PERIOD_MS - 1u) / WDT_SERVICE_PERIOD_MS);
+    return (t == 0u) ? 1u : t;
+}
+
+uint16_t WDT_LatchResetCause(void)
+{
+    /* Capturar y limpiar las banderas de reset para el siguiente arranque.
+       Solo una vez: una segunda lectura ya las vería borradas. */
+    if (!wdt_cause_latched) {
+        #ifdef RCON
+        wdt_reset_cause = RCON & WDT_RESET_MASK;
+        RCON &= (uint16_t)~WDT_RESET_MASK;
+        #endif
+        wdt_cause_latched = true;
+    }
+    return wdt_reset_cause;
+}
+
+void WDT_Init(void)
+{
+    (void)WDT_LatchResetCause();
+
+    wdt_task_count = 0;
+    wdt_checkins = 0;
+    wdt_expired = 0;
+
+    #if defined(CONFIG_WDT_ON_NORMAL) || defined(CONFIG_WDT_ON_LONG)
+    WDT_Enable(true);
+    #else
+    WDT_Enable(false);
+    #endif
+}
+
+void WDT_Enable(bool enable)
+{
+    #ifdef __XC16__
+    ClrWdt();
+    #endif
+    #ifdef RCONbits
+    RCONbits.SWDTEN = enable ? 1 : 0;
+    #else
+    (void)enable;
+    #endif
+}
+
+uint8_t WDT_Register(uint16_t deadline_ms)
+{
+    uint8_t id;
+
+    if (wdt_task_count >= WDT_MAX_TASKS) return WDT_INVALID_ID;
+    id = wdt_task_count++;
+    wdt_tasks[id].deadline = wdt_ticks(deadline_ms);
+    wdt_tasks[id].remaining = wdt_tasks[id].deadline;
+    return id;
+}
+
+void WDT_SetDeadline(uint8_t id, uint16_t deadline_ms)
+{
+    if (id >= wdt_task_count) return;
+    wdt_tasks[id].deadline = wdt_ticks(deadline_ms);
+    wdt_tasks[id].remaining = wdt_tasks[id].deadline;
+}
+
+void WDT_Checkin(uint8_t id)
+{
+    if (id < WDT_MAX_TASKS) wdt_checkins |= (uint16_t)(1u << id);
+}
+
+bool WDT_Service(void)
+{
+    uint16_t seen = wdt_checkins;
+    uint8_t i;
+
+    wdt_checkins &= (uint16_t)~seen;
+
+    for (i = 0; i < wdt_task_count; i++) {
+        if (seen & (1u << i)) {
+            wdt_tasks[i].remaining = wdt_tasks[i].deadline;
+        } else if (wdt_tasks[i].remaining == 0u) {
+            wdt_expired |= (uint16_t)(1u << i);
+        } else {
+            wdt_tasks[i].remaining--;
+        }
+    }
+
+    /* Una tarea vencida bloquea el refresco hasta el reset */
+    if (wdt_expired != 0u) return false;
+
+    #ifdef __XC16__
+    ClrWdt();
+    #endif
+    return true;
+}
+
+uint16_t WDT_GetExpired(void)
+{
+    return wdt_expired;
+}
+
+uint16_t WDT_GetResetCause(void)
+{
+    return wdt_reset_cause;
+}
+
+void WDT_PrintResetCause(void)
+{
+    #ifdef __XC16__
+    printf("Reset cause: 0x%04X", wdt_reset_cause);
+    if (wdt_reset_cause & WDT_RESET_POR)    printf(" POR");
+    if (wdt_reset_cause & WDT_RESET_BOR)    printf(" BOR");
+    if (wdt_reset_cause & WDT_RESET_WDTO)   printf(" WDTO");
+    if (wdt_reset_cause & WDT_RESET_SWR)    printf(" SWR");
+    if (wdt_reset_cause & WDT_RESET_EXTR)   printf(" EXTR");
+    if (wdt_reset_cause & WDT_RESET_CM)     printf(" CM");
+    if (wdt_reset_cause & WDT_RESET_IOPUWR) printf(" IOPUWR");
+    if (wdt_reset_cause & WDT_RESET_TRAPR)  printf(" TRAPR");
+    printf("\r\n");
+    #endif
+}
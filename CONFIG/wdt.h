@@ -0,0 +1,76 @@
+/*
+ * wdt.h - Supervisor del watchdog para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Cada tarea o etapa del pipeline se registra con un plazo máximo entre
+ *  check-ins. WDT_Service() solo ejecuta CLRWDT si todas las tareas han
+ *  reportado dentro de su plazo; si alguna se cuelga, el WDT hardware
+ *  resetea el micro. Al arrancar se captura la causa de reset (RCON).
+ *
+ * Uso:
+ *   WDT_Init();                                   // captura RCON, arranca WDT si CONFIG_WDT_ON_*
+ *   id = WDT_Register(200);                       // plazo de 200 ms
+ *   ... en la tarea: WDT_Checkin(id);
+ *   ... cada WDT_SERVICE_PERIOD_MS: WDT_Service();
+ *
+ * Nota:
+ *  - Los plazos deben ser menores que CONFIG_WDT_TIMEOUT_MS (config.h).
+ *  - Para un bloque largo (FIR de muchas muestras) usa un plazo propio
+ *    más largo o WDT_Checkin entre sub-bloques.
+ *
+ ******************************************************************************/
+
+#ifndef WDT_H
+#define WDT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Periodo con el que se llama a WDT_Service (ms) */
+#ifndef WDT_SERVICE_PERIOD_MS
+#define WDT_SERVICE_PERIOD_MS   10u
+#endif
+
+#define WDT_MAX_TASKS           8u
+#define WDT_INVALID_ID          0xFFu
+
+/* Causas de reset (bits de RCON) */
+#define WDT_RESET_POR      (1u << 0)   /* power-on                     */
+#define WDT_RESET_BOR      (1u << 1)   /* brown-out                    */
+#define WDT_RESET_WDTO     (1u << 4)   /* timeout del watchdog         */
+#define WDT_RESET_SWR      (1u << 6)   /* instrucción RESET            */
+#define WDT_RESET_EXTR     (1u << 7)   /* pin MCLR                     */
+#define WDT_RESET_CM       (1u << 9)   /* configuration mismatch       */
+#define WDT_RESET_IOPUWR   (1u << 14)  /* opcode ilegal / W no inicial. */
+#define WDT_RESET_TRAPR    (1u << 15)  /* conflicto de traps           */
+#define WDT_RESET_MASK     (WDT_RESET_POR | WDT_RESET_BOR | WDT_RESET_WDTO | \
+                            WDT_RESET_SWR | WDT_RESET_EXTR | WDT_RESET_CM | \
+                            WDT_RESET_IOPUWR | WDT_RESET_TRAPR)
+
+void WDT_Init(void);
+void WDT_Enable(bool enable);
+
+/* Registra una tarea con su plazo; devuelve su id o WDT_INVALID_ID */
+uint8_t WDT_Register(uint16_t deadline_ms);
+void WDT_SetDeadline(uint8_t id, uint16_t deadline_ms);
+
+/* Check-in de la tarea (seguro desde ISR) */
+void WDT_Checkin(uint8_t id);
+
+/* Comprueba plazos y limpia el WDT si todas cumplen. Devuelve false si
+   alguna tarea venció (el WDT dejará de refrescarse) */
+bool WDT_Service(void);
+
+/* Máscara de tareas vencidas (bit n = id n) */
+uint16_t WDT_GetExpired(void);
+
+/* Captura la causa de reset y limpia sus banderas en RCON la primera vez;
+   las siguientes llamadas devuelven lo ya capturado. La usan WDT_Init y
+   BOOT_Start, así que el orden entre ambos no importa. */
+uint16_t WDT_LatchResetCause(void);
+
+/* Causa del último reset capturada (bits WDT_RESET_*) */
+uint16_t WDT_GetResetCause(void);
+void WDT_PrintResetCause(void);
+
+#endif /* WDT_H */
@@ -7,6 +7,9 @@
  * Con nombres coincidentes con:
  *  - _square1k                 -> extern fractional square1k[256];
  *  - _lowpassexampleFilter     -> extern FIRStruct lowpassexampleFilter;
+ *
+ * Watchdog: la etapa FIR hace check-in tras cada bloque y el bucle llama a
+ * WDT_Service cada WDT_SERVICE_PERIOD_MS (añade wdt.c, config.h y wdt.h).
  **********************************************************************/
 
 // DSPIC33FJ32MC204 Configuration Bit Settings
@@ -31,11 +34,7 @@
 #pragma config IOL1WAY = ON             // Peripheral Pin Select Configuration (Allow Only One Re-configuration)
 #pragma config FCKSM = CSECMD           // Clock Switching and Monitor (Clock switching is enabled, Fail-Safe Clock Monitor is disabled)
 
-// FWDT
-#pragma config WDTPOST = PS32768        // Watchdog Timer Postscaler (1:32,768)
-#pragma config WDTPRE = PR128           // WDT Prescaler (1:128)
-#pragma config WINDIS = OFF             // Watchdog Timer Window (Watchdog Timer in Non-Window mode)
-#pragma config FWDTEN = OFF             // Watchdog Timer Enable (Watchdog timer enabled/disabled by user software)
+// FWDT: tras incluir config.h (abajo), el timeout sigue a CONFIG_WDT_ON_*
 
 // FPOR
 #pragma config FPWRT = PWR1             // POR Timer Value (Disabled)
@@ -51,10 +50,25 @@
 // #pragma config statements should precede project file includes.
 // Use project enums instead of #define for ON and OFF.
 
+#define FCY 36850000UL  /* Hz - ajusta según tu configuración real */
+
 #include <xc.h>
 #include "p33Fxxxx.h"
 #include "dsp.h"
-
+#include "config.h"     /* CONFIG_WDT_ON_*, DELAY_MS */
+#include "wdt.h"
+
+// FWDT: WDTPRE/WDTPOST según la opción de config.h; FWDTEN = OFF porque
+// WDT_Init lo arranca por software (RCON.SWDTEN) si la opción lo pide
+#if defined(CONFIG_WDT_ON_LONG)
+#pragma config WDTPOST = PS2048         // Watchdog Timer Postscaler (1:2,048)
+#pragma config WDTPRE = PR128           // WDT Prescaler (1:128) -> ~8 s
+#else
+#pragma config WDTPOST = PS1024         // Watchdog Timer Postscaler (1:1,024)
+#pragma config WDTPRE = PR32            // WDT Prescaler (1:32) -> ~1 s
+#endif
+#pragma config WINDIS = OFF             // Watchdog Timer Window (Watchdog Timer in Non-Window mode)
+#pragma config FWDTEN = OFF             // Watchdog Timer Enable (Watchdog timer enabled/disabled by user software)
 
 /* Longitud del bloque (coincide con el número de hword en _square1k) */
 #define BLOCK_LENGTH 256
@@ -65,17 +79,27 @@ extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowp
 
 fractional FilterOut[BLOCK_LENGTH];             /* Buffer de salida */
 
-/* Programa principal: configura reloj, inicializa y ejecuta el FIR una vez */
+/* Plazo de la etapa FIR: un bloque por vuelta del bucle */
+#define FIR_DEADLINE_MS  100u
+
+#if CONFIG_WDT_TIMEOUT_MS != 0 && FIR_DEADLINE_MS >= CONFIG_WDT_TIMEOUT_MS
+#error "FIR_DEADLINE_MS debe ser menor que CONFIG_WDT_TIMEOUT_MS"
+#endif
+
+/* Programa principal: configura reloj, inicializa y ejecuta el FIR por bloques */
 int main(void)
 {
+    uint8_t wdt_fir;
+
     /* Configurar PLL como en el ejemplo original (opcional si ya lo tienes) */
     PLLFBD = 38;                 /* M = 40 */
     CLKDIVbits.PLLPOST = 0;      /* N1 = 2 */
     CLKDIVbits.PLLPRE = 0;       /* N2 = 2 */
     OSCTUN = 0;
 
-    /* Deshabilitar Watchdog por software */
-    RCONbits.SWDTEN = 0;
+    /* Watchdog: captura la causa de reset y lo arranca según config.h */
+    WDT_Init();
+    wdt_fir = WDT_Register(FIR_DEADLINE_MS);
 
     /* Cambio de reloj a Primary Oscillator with PLL */
     __builtin_write_OSCCONH(0x03);
@@ -86,11 +110,15 @@ int main(void)
     /* Inicializa la línea de retardo del filtro (estado) */
     FIRDelayInit(&lowpassexampleFilter);
 
-    /* Ejecuta FIR pasabajo sobre el bloque de entrada */
-    FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
+    /* La entrada es periódica: se filtra un bloque por vuelta. En FilterOut
+       quedan las muestras filtradas (aquí podrías enviarlas por UART/DAC/DMA) */
+    while (1) {
+        FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
+        WDT_Checkin(wdt_fir);
 
-    /* En FilterOut quedan las muestras filtradas; bucle infinito */
-    while (1) { /* idle; aquí podrías enviar FilterOut por UART/DAC/DMA */ }
+        DELAY_MS(WDT_SERVICE_PERIOD_MS);
+        WDT_Service();
+    }
 
     return 0;
 }
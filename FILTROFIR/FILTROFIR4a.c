@@ -7,6 +7,12 @@
  * Comentarios en español y nombres coincidentes con tus .s:
  *  - _square1k                 -> extern fractional square1k[256];
  *  - _lowpassexampleFilter     -> extern FIRStruct lowpassexampleFilter;
+ *
+ * Watchdog: dos etapas con check-in propio. La etapa FIR filtra por
+ * sub-bloques de FIR_SUBBLOCK muestras (la línea de retardo conserva el
+ * estado, así que el resultado es el del bloque entero) y la etapa de
+ * salida hace check-in en cada espera. WDT_Service se llama cada
+ * WDT_SERVICE_PERIOD_MS (añade wdt.c, config.h y wdt.h).
  **********************************************************************/
 
 // DSPIC33FJ32MC204 Configuration Bit Settings
@@ -31,11 +37,7 @@
 #pragma config IOL1WAY = ON             // Peripheral Pin Select Configuration (Allow Only One Re-configuration)
 #pragma config FCKSM = CSECMD           // Clock Switching and Monitor (Clock switching is enabled, Fail-Safe Clock Monitor is disabled)
 
-// FWDT
-#pragma config WDTPOST = PS32768        // Watchdog Timer Postscaler (1:32,768)
-#pragma config WDTPRE = PR128           // WDT Prescaler (1:128)
-#pragma config WINDIS = OFF             // Watchdog Timer Window (Watchdog Timer in Non-Window mode)
-#pragma config FWDTEN = OFF             // Watchdog Timer Enable (Watchdog timer enabled/disabled by user software)
+// FWDT: tras incluir config.h (abajo), el timeout sigue a CONFIG_WDT_ON_*
 
 // FPOR
 #pragma config FPWRT = PWR1             // POR Timer Value (Disabled)
@@ -57,6 +59,20 @@
 #include "p33Fxxxx.h"
 #include "dsp.h"
 #include <libpic30.h>
+#include "config.h"     /* CONFIG_WDT_ON_*, DELAY_MS */
+#include "wdt.h"
+
+// FWDT: WDTPRE/WDTPOST según la opción de config.h; FWDTEN = OFF porque
+// WDT_Init lo arranca por software (RCON.SWDTEN) si la opción lo pide
+#if defined(CONFIG_WDT_ON_LONG)
+#pragma config WDTPOST = PS2048         // Watchdog Timer Postscaler (1:2,048)
+#pragma config WDTPRE = PR128           // WDT Prescaler (1:128) -> ~8 s
+#else
+#pragma config WDTPOST = PS1024         // Watchdog Timer Postscaler (1:1,024)
+#pragma config WDTPRE = PR32            // WDT Prescaler (1:32) -> ~1 s
+#endif
+#pragma config WINDIS = OFF             // Watchdog Timer Window (Watchdog Timer in Non-Window mode)
+#pragma config FWDTEN = OFF             // Watchdog Timer Enable (Watchdog timer enabled/disabled by user software)
 
 /* Longitud del bloque (coincide con el número de hword en _square1k) */
 #define BLOCK_LENGTH 256
@@ -67,17 +83,41 @@ extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowp
 
 fractional FilterOut[BLOCK_LENGTH];             /* Buffer de salida */
 
-/* Programa principal: configura reloj, inicializa y ejecuta el FIR una vez */
+/* Una muestra en PORTB cada OUT_PERIOD_MS; el FIR va FIR_SUBBLOCK por delante */
+#define OUT_PERIOD_MS     100u
+#define FIR_SUBBLOCK      8u
+#define FIR_DEADLINE_MS   (FIR_SUBBLOCK * OUT_PERIOD_MS + 2u * WDT_SERVICE_PERIOD_MS)
+#define OUT_DEADLINE_MS   (4u * WDT_SERVICE_PERIOD_MS)
+
+#if CONFIG_WDT_TIMEOUT_MS != 0 && FIR_DEADLINE_MS >= CONFIG_WDT_TIMEOUT_MS
+#error "FIR_DEADLINE_MS debe ser menor que CONFIG_WDT_TIMEOUT_MS"
+#endif
+
+/* Espera 'ms' atendiendo al supervisor: la etapa de salida sigue viva */
+static void wait_serviced(uint16_t ms, uint8_t wdt_out)
+{
+    for (; ms >= WDT_SERVICE_PERIOD_MS; ms -= WDT_SERVICE_PERIOD_MS) {
+        DELAY_MS(WDT_SERVICE_PERIOD_MS);
+        WDT_Checkin(wdt_out);
+        WDT_Service();
+    }
+}
+
+/* Programa principal: configura reloj, inicializa y ejecuta el FIR por sub-bloques */
 int main(void)
 {
+    uint8_t wdt_fir, wdt_out;
+
     /* Configurar PLL como en el ejemplo original (opcional si ya lo tienes) */
     PLLFBD = 38;                 /* M = 40 */
     CLKDIVbits.PLLPOST = 0;      /* N1 = 2 */
     CLKDIVbits.PLLPRE = 0;       /* N2 = 2 */
     OSCTUN = 0;
 
-    /* Deshabilitar Watchdog por software */
-    RCONbits.SWDTEN = 0;
+    /* Watchdog: captura la causa de reset y lo arranca según config.h */
+    WDT_Init();
+    wdt_fir = WDT_Register(FIR_DEADLINE_MS);
+    wdt_out = WDT_Register(OUT_DEADLINE_MS);
 
     /* Cambio de reloj a Primary Oscillator with PLL */
     __builtin_write_OSCCONH(0x03);
@@ -88,16 +128,19 @@ int main(void)
     /* Inicializa la línea de retardo del filtro (estado) */
     FIRDelayInit(&lowpassexampleFilter);
 
-    /* Ejecuta FIR pasabajo sobre el bloque de entrada */
-    FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
-
-    /* En FilterOut quedan las muestras filtradas; bucle infinito */
+    /* Ejecuta el FIR por sub-bloques dentro del bucle (etapa FIR) */
  while (1) {
     int i;
     
     TRISB = 0x0000;
     
     for (i = 0; i < BLOCK_LENGTH; i++) {
+        /* Etapa FIR: el siguiente sub-bloque justo antes de mostrarlo */
+        if ((i % FIR_SUBBLOCK) == 0) {
+            FIR(FIR_SUBBLOCK, &FilterOut[i], &square1k[i], &lowpassexampleFilter);
+            WDT_Checkin(wdt_fir);
+        }
+
         /* Convertir Q15 a positivo simple:
            Tomar el valor absoluto y multiplicar por 2 para usar 16 bits */
         
@@ -114,7 +157,7 @@ int main(void)
         valor_positivo = valor_positivo * 2;  /* o valor_positivo << 1 */
         
         PORTB = valor_positivo;
-        __delay_ms(100);
+        wait_serviced(OUT_PERIOD_MS, wdt_out);
     }
 }
     
@@ -0,0 +1,215 @@
+/*
+ * foc.c
+ *
+ * Implementación de los núcleos Q15 de FOC (ver foc.h).
+ *
+ * Uso típico en la ISR del ADC (una vez por periodo PWM):
+ *   FOC_Clarke(&iabc, &iab);
+ *   FOC_SinCos(theta, &sc);
+ *   FOC_Park(&iab, &sc, &idq);
+ *   vdq.d = FOC_PI_Update(&pi_d, 0, idq.d);
+ *   vdq.q = FOC_PI_Update(&pi_q, iq_ref, idq.q);
+ *   FOC_InvPark(&vdq, &sc, &vab);
+ */
+
+#include "foc.h"
+
+#ifndef __XC16__
+#include <math.h>
+
+/* M_PI no existe con -std=c99 (no es ISO C) */
+#define FOC_REF_PI 3.14159265358979323846
+#endif
+
+/* 1/sqrt(3) en Q15 */
+#define FOC_INV_SQRT3_Q15  18919
+
+/* sin(2*pi*i/256) en Q15; la entrada 256 repite la 0 para interpolar sin
+   comprobar el final de la tabla */
+static const int16_t foc_sin_table[257] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+      6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+     32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+     27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+     18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+         0
+};
+
+/* Satura un resultado de 32 bits a Q15 */
+static inline int16_t foc_sat16(int32_t x)
+{
+    if (x > FOC_Q15_MAX) return FOC_Q15_MAX;
+    if (x < FOC_Q15_MIN) return FOC_Q15_MIN;
+    return (int16_t)x;
+}
+
+/* Producto Q15 x Q15 en Q30 (32 bits) */
+static inline int32_t foc_mul32(int16_t a, int16_t b)
+{
+#ifdef __XC16__
+    return __builtin_mulss(a, b);
+#else
+    return (int32_t)a * (int32_t)b;
+#endif
+}
+
+/* Interpola linealmente entre dos entradas: 8 bits altos = índice,
+   8 bits bajos = fracción */
+static inline int16_t foc_sin_lookup(uint16_t angle)
+{
+    uint8_t idx = (uint8_t)(angle >> 8);
+    int16_t frac = (int16_t)(angle & 0xFFu);
+    int16_t y0 = foc_sin_table[idx];
+    int16_t y1 = foc_sin_table[idx + 1u];
+
+    return (int16_t)(y0 + (int16_t)(((int32_t)(y1 - y0) * frac) >> 8));
+}
+
+void FOC_SinCos(uint16_t angle, FOC_SinCos_t *sc)
+{
+    sc->sin = foc_sin_lookup(angle);
+    sc->cos = foc_sin_lookup((uint16_t)(angle + FOC_ANGLE_90));
+}
+
+void FOC_Clarke(const FOC_ABC_t *abc, FOC_AlphaBeta_t *ab)
+{
+    /* alpha = a;  beta = (a + 2b) / sqrt(3) */
+    int32_t sum = (int32_t)abc->a + 2 * (int32_t)abc->b;
+
+    ab->alpha = abc->a;
+    ab->beta  = foc_sat16((sum * FOC_INV_SQRT3_Q15) >> 15);
+}
+
+void FOC_Park(const FOC_AlphaBeta_t *ab, const FOC_SinCos_t *sc, FOC_DQ_t *dq)
+{
+    /* d =  alpha*cos + beta*sin
+       q = -alpha*sin + beta*cos   (sumas en Q30, un solo desplazamiento) */
+    int32_t d = foc_mul32(ab->alpha, sc->cos) + foc_mul32(ab->beta, sc->sin);
+    int32_t q = foc_mul32(ab->beta, sc->cos) - foc_mul32(ab->alpha, sc->sin);
+
+    dq->d = foc_sat16(d >> 15);
+    dq->q = foc_sat16(q >> 15);
+}
+
+void FOC_InvPark(const FOC_DQ_t *dq, const FOC_SinCos_t *sc, FOC_AlphaBeta_t *ab)
+{
+    /* alpha = d*cos - q*sin
+       beta  = d*sin + q*cos */
+    int32_t alpha = foc_mul32(dq->d, sc->cos) - foc_mul32(dq->q, sc->sin);
+    int32_t beta  = foc_mul32(dq->d, sc->sin) + foc_mul32(dq->q, sc->cos);
+
+    ab->alpha = foc_sat16(alpha >> 15);
+    ab->beta  = foc_sat16(beta >> 15);
+}
+
+void FOC_PI_Init(FOC_PI_t *pi, int16_t kp, int16_t ki, uint8_t kp_shift,
+                 int16_t out_min, int16_t out_max)
+{
+    pi->kp = kp;
+    pi->ki = ki;
+    pi->kp_shift = (kp_shift > 15u) ? 15u : kp_shift;
+    pi->out_min = out_min;
+    pi->out_max = out_max;
+    pi->integ = 0;
+}
+
+void FOC_PI_Reset(FOC_PI_t *pi)
+{
+    pi->integ = 0;
+}
+
+int16_t FOC_PI_Update(FOC_PI_t *pi, int16_t ref, int16_t meas)
+{
+    int16_t err = foc_sat16((int32_t)ref - meas);
+    int32_t imin = (int32_t)pi->out_min * 32768L;   /* sin desplazar negativos */
+    int32_t imax = (int32_t)pi->out_max * 32768L;
+    int32_t integ, out;
+
+    /* Integral en Q30, recortada a los límites de salida (anti-windup) */
+    integ = pi->integ + foc_mul32(pi->ki, err);
+    if (integ > imax) integ = imax;
+    if (integ < imin) integ = imin;
+    pi->integ = integ;
+
+    out = (foc_mul32(pi->kp, err) >> (15u - pi->kp_shift)) + (integ >> 15);
+    if (out > pi->out_max) out = pi->out_max;
+    if (out < pi->out_min) out = pi->out_min;
+    return (int16_t)out;
+}
+
+#ifndef __XC16__
+/* ------------------------------------------------------------------------- */
+/* Referencia en coma flotante (host)                                         */
+/* ------------------------------------------------------------------------- */
+
+void FOC_Ref_SinCos(uint16_t angle, double *s, double *c)
+{
+    double th = (double)angle * (2.0 * FOC_REF_PI / 65536.0);
+    *s = sin(th);
+    *c = cos(th);
+}
+
+void FOC_Ref_Clarke(double a, double b, double *alpha, double *beta)
+{
+    *alpha = a;
+    *beta = (a + 2.0 * b) / sqrt(3.0);
+}
+
+void FOC_Ref_Park(double alpha, double beta, double s, double c, double *d, double *q)
+{
+    *d = alpha * c + beta * s;
+    *q = -alpha * s + beta * c;
+}
+
+void FOC_Ref_InvPark(double d, double q, double s, double c, double *alpha, double *beta)
+{
+    *alpha = d * c - q * s;
+    *beta = d * s + q * c;
+}
+
+double FOC_Ref_PI(FOC_Ref_PI_t *pi, double ref, double meas)
+{
+    double err = ref - meas;
+    double out;
+
+    /* Mismo recorte del error que la versión Q15 */
+    if (err > (double)FOC_Q15_MAX / 32768.0) err = (double)FOC_Q15_MAX / 32768.0;
+    if (err < -1.0) err = -1.0;
+
+    pi->integ += pi->ki * err;
+    if (pi->integ > pi->out_max) pi->integ = pi->out_max;
+    if (pi->integ < pi->out_min) pi->integ = pi->out_min;
+
+    out = pi->kp * err + pi->integ;
+    if (out > pi->out_max) out = pi->out_max;
+    if (out < pi->out_min) out = pi->out_min;
+    return out;
+}
+#endif
@@ -0,0 +1,106 @@
+/*
+ * foc.h
+ *
+ * Núcleos matemáticos Q15 para control vectorial (FOC) en dsPIC33FJ32MC204 (XC16)
+ *
+ * API:
+ *   void FOC_SinCos(uint16_t angle, FOC_SinCos_t *sc);      // seno/coseno por tabla + interpolación
+ *   void FOC_Clarke(const FOC_ABC_t *abc, FOC_AlphaBeta_t *ab);
+ *   void FOC_Park(const FOC_AlphaBeta_t *ab, const FOC_SinCos_t *sc, FOC_DQ_t *dq);
+ *   void FOC_InvPark(const FOC_DQ_t *dq, const FOC_SinCos_t *sc, FOC_AlphaBeta_t *ab);
+ *   void FOC_PI_Init(FOC_PI_t *pi, kp, ki, kp_shift, out_min, out_max);
+ *   int16_t FOC_PI_Update(FOC_PI_t *pi, int16_t ref, int16_t meas);
+ *
+ * Formato:
+ * - Magnitudes en Q15 (-1.0 .. 0.99997). Los resultados se saturan, nunca desbordan.
+ * - Ángulo eléctrico en 16 bits: 0..65535 = 0..2*pi.
+ *
+ * Coste aproximado por llamada (ciclos, XC16 -O1; estimado contando
+ * instrucciones, confírmalo en placa con un timer a 1:1):
+ *   FOC_SinCos ~ 30, FOC_Clarke ~ 15, FOC_Park ~ 35, FOC_InvPark ~ 35,
+ *   FOC_PI_Update ~ 45.
+ *
+ * Nota:
+ * - Con XC16 las multiplicaciones usan __builtin_mulss (MUL.SS, 1 ciclo).
+ *   En Linux se compila la versión C portable, y además FOC_Ref_* (double)
+ *   como implementación de referencia para validar la versión Q15
+ *   (ver foc_check.c).
+ */
+
+#ifndef FOC_H
+#define FOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FOC_Q15_MAX   32767
+#define FOC_Q15_MIN   (-32768)
+#define FOC_Q15(x)    ((int16_t)((x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/* Ángulos útiles (16 bits = vuelta completa) */
+#define FOC_ANGLE_90  0x4000u
+#define FOC_ANGLE_120 0x5555u
+
+typedef struct { int16_t a, b, c; }        FOC_ABC_t;
+typedef struct { int16_t alpha, beta; }    FOC_AlphaBeta_t;
+typedef struct { int16_t d, q; }           FOC_DQ_t;
+typedef struct { int16_t sin, cos; }       FOC_SinCos_t;
+
+/* Regulador PI con saturación y anti-windup (integral recortada) */
+typedef struct {
+    int16_t kp;        /* Q15, escalado por 2^kp_shift                     */
+    int16_t ki;        /* Q15 por periodo de muestreo                      */
+    uint8_t kp_shift;  /* ganancia proporcional efectiva = kp * 2^kp_shift */
+    int16_t out_min;
+    int16_t out_max;
+    int32_t integ;     /* acumulador integral en Q30                       */
+} FOC_PI_t;
+
+/* Multiplicación Q15 x Q15 -> Q15 (sin redondeo) */
+#ifdef __XC16__
+#define FOC_MUL_Q15(a, b)  ((int16_t)(__builtin_mulss((a), (b)) >> 15))
+#else
+#define FOC_MUL_Q15(a, b)  ((int16_t)(((int32_t)(a) * (int32_t)(b)) >> 15))
+#endif
+
+void FOC_SinCos(uint16_t angle, FOC_SinCos_t *sc);
+
+/* Clarke (invariante en amplitud, a + b + c = 0): usa solo a y b */
+void FOC_Clarke(const FOC_ABC_t *abc, FOC_AlphaBeta_t *ab);
+
+void FOC_Park(const FOC_AlphaBeta_t *ab, const FOC_SinCos_t *sc, FOC_DQ_t *dq);
+void FOC_InvPark(const FOC_DQ_t *dq, const FOC_SinCos_t *sc, FOC_AlphaBeta_t *ab);
+
+void FOC_PI_Init(FOC_PI_t *pi, int16_t kp, int16_t ki, uint8_t kp_shift,
+                 int16_t out_min, int16_t out_max);
+void FOC_PI_Reset(FOC_PI_t *pi);
+int16_t FOC_PI_Update(FOC_PI_t *pi, int16_t ref, int16_t meas);
+
+#ifndef __XC16__
+/* Implementación de referencia en coma flotante (solo Linux / host).
+   Mismas convenciones que las versiones Q15, magnitudes en [-1, 1). */
+void FOC_Ref_SinCos(uint16_t angle, double *s, double *c);
+void FOC_Ref_Clarke(double a, double b, double *alpha, double *beta);
+void FOC_Ref_Park(double alpha, double beta, double s, double c, double *d, double *q);
+void FOC_Ref_InvPark(double d, double q, double s, double c, double *alpha, double *beta);
+
+/* PI de referencia: kp es la ganancia efectiva (kp * 2^kp_shift de la
+   versión Q15), ki por periodo; la integral se recorta a [out_min, out_max] */
+typedef struct {
+    double kp, ki;
+    double out_min, out_max;
+    double integ;
+} FOC_Ref_PI_t;
+
+double FOC_Ref_PI(FOC_Ref_PI_t *pi, double ref, double meas);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FOC_H */
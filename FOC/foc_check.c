@@ -0,0 +1,295 @@
+/*
+ * foc_check.c - Contrasta los núcleos Q15 de FOC con la referencia double (PC/Linux)
+ *
+ * Descripción:
+ *  Recorre el rango de entrada de cada núcleo, compara el resultado Q15 con
+ *  FOC_Ref_* y muestra el error máximo en LSB (1 LSB = 2^-15). El PI se
+ *  recorre con escalones de consigna en lazo cerrado (planta de primer
+ *  orden), en lazo abierto (la integral llega al límite y debe salir en
+ *  cuanto cambia el signo del error) y con el error saturado, para varias
+ *  ganancias y límites de salida. Mide además
+ *  el tiempo por llamada en el PC. No forma parte del firmware: los ciclos en
+ *  el dsPIC hay que medirlos en placa (ver foc.h).
+ *
+ * Compilar:
+ *   gcc -std=c99 -O2 -Wall -Wextra -o foc_check foc_check.c foc.c -lm
+ *
+ * Uso:
+ *   foc_check
+ *
+ *  Devuelve 0 si todos los núcleos quedan dentro de su tolerancia.
+ *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "foc.h"
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Tolerancias (LSB Q15). SinCos: tabla de 256 + interpolación lineal.
+   Park/InvPark: truncado de dos productos más el error de SinCos. */
+#define TOL_SINCOS     8.0
+#define TOL_CLARKE     2.0
+#define TOL_PARK       4.0
+#define TOL_INVPARK    4.0
+/* PI: la integral en Q30 es exacta; solo truncan el término P y integ >> 15,
+   menos de 1 LSB cada uno */
+#define TOL_PI         2.0
+
+/* Pasos por caso del PI y semiperiodo de la consigna en escalón */
+#define PI_STEPS      2048
+#define PI_HALF       256
+
+/* Paso del barrido de magnitudes Q15 */
+#define SWEEP_STEP    1021
+
+/* Repeticiones para medir el tiempo por llamada */
+#define BENCH_CALLS   1000000L
+
+typedef struct {
+    const char *name;
+    double max_err;   /* LSB */
+    double tol;       /* LSB */
+    long samples;
+    double ns_call;
+} Result_t;
+
+static double q15_to_d(int16_t x)
+{
+    return (double)x / 32768.0;
+}
+
+/* Error en LSB entre un Q15 y su referencia, con la referencia saturada al
+   rango representable */
+static double err_lsb(int16_t q, double ref)
+{
+    double r = ref * 32768.0;
+
+    if (r > FOC_Q15_MAX) r = FOC_Q15_MAX;
+    if (r < FOC_Q15_MIN) r = FOC_Q15_MIN;
+    return fabs((double)q - r);
+}
+
+static void track(Result_t *res, double e)
+{
+    if (e > res->max_err) res->max_err = e;
+    res->samples++;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Evita que el compilador elimine las llamadas del benchmark */
+static volatile int16_t sink;
+
+static void check_sincos(Result_t *res)
+{
+    FOC_SinCos_t sc;
+    double s, c, t0;
+    uint32_t a;
+    long i;
+
+    for (a = 0; a <= 0xFFFFu; a++) {
+        FOC_SinCos((uint16_t)a, &sc);
+        FOC_Ref_SinCos((uint16_t)a, &s, &c);
+        track(res, err_lsb(sc.sin, s));
+        track(res, err_lsb(sc.cos, c));
+    }
+
+    t0 = now_ns();
+    for (i = 0; i < BENCH_CALLS; i++) {
+        FOC_SinCos((uint16_t)(i * 40503L), &sc);
+        sink = sc.sin;
+    }
+    res->ns_call = (now_ns() - t0) / BENCH_CALLS;
+}
+
+static void check_clarke(Result_t *res)
+{
+    FOC_ABC_t abc;
+    FOC_AlphaBeta_t ab;
+    double alpha, beta, t0;
+    int32_t a, b;
+    long i;
+
+    for (a = FOC_Q15_MIN; a <= FOC_Q15_MAX; a += SWEEP_STEP) {
+        for (b = FOC_Q15_MIN; b <= FOC_Q15_MAX; b += SWEEP_STEP) {
+            abc.a = (int16_t)a;
+            abc.b = (int16_t)b;
+            abc.c = (int16_t)(-(a + b) / 2);  /* no se usa */
+            FOC_Clarke(&abc, &ab);
+            FOC_Ref_Clarke(q15_to_d(abc.a), q15_to_d(abc.b), &alpha, &beta);
+            track(res, err_lsb(ab.alpha, alpha));
+            track(res, err_lsb(ab.beta, beta));
+        }
+    }
+
+    t0 = now_ns();
+    for (i = 0; i < BENCH_CALLS; i++) {
+        abc.a = (int16_t)(i * 7);
+        abc.b = (int16_t)(i * 13);
+        FOC_Clarke(&abc, &ab);
+        sink = ab.beta;
+    }
+    res->ns_call = (now_ns() - t0) / BENCH_CALLS;
+}
+
+/* Park e InvPark comparten barrido: ángulo cada 1/64 de vuelta y las dos
+   magnitudes de entrada en rejilla. La referencia usa el seno/coseno
+   exacto, así que el error incluye el de FOC_SinCos. */
+static void check_park(Result_t *park, Result_t *inv)
+{
+    FOC_SinCos_t sc;
+    FOC_AlphaBeta_t ab;
+    FOC_DQ_t dq;
+    double s, c, d, q, alpha, beta, t0;
+    uint32_t ang;
+    int32_t x, y;
+    long i;
+
+    for (ang = 0; ang <= 0xFFFFu; ang += 0x400u) {
+        FOC_SinCos((uint16_t)ang, &sc);
+        FOC_Ref_SinCos((uint16_t)ang, &s, &c);
+        for (x = FOC_Q15_MIN; x <= FOC_Q15_MAX; x += SWEEP_STEP) {
+            for (y = FOC_Q15_MIN; y <= FOC_Q15_MAX; y += SWEEP_STEP) {
+                ab.alpha = (int16_t)x;
+                ab.beta = (int16_t)y;
+                FOC_Park(&ab, &sc, &dq);
+                FOC_Ref_Park(q15_to_d(ab.alpha), q15_to_d(ab.beta), s, c, &d, &q);
+                track(park, err_lsb(dq.d, d));
+                track(park, err_lsb(dq.q, q));
+
+                dq.d = (int16_t)x;
+                dq.q = (int16_t)y;
+                FOC_InvPark(&dq, &sc, &ab);
+                FOC_Ref_InvPark(q15_to_d(dq.d), q15_to_d(dq.q), s, c, &alpha, &beta);
+                track(inv, err_lsb(ab.alpha, alpha));
+                track(inv, err_lsb(ab.beta, beta));
+            }
+        }
+    }
+
+    FOC_SinCos(0x1234u, &sc);
+    t0 = now_ns();
+    for (i = 0; i < BENCH_CALLS; i++) {
+        ab.alpha = (int16_t)(i * 7);
+        ab.beta = (int16_t)(i * 13);
+        FOC_Park(&ab, &sc, &dq);
+        sink = dq.q;
+    }
+    park->ns_call = (now_ns() - t0) / BENCH_CALLS;
+
+    t0 = now_ns();
+    for (i = 0; i < BENCH_CALLS; i++) {
+        dq.d = (int16_t)(i * 7);
+        dq.q = (int16_t)(i * 13);
+        FOC_InvPark(&dq, &sc, &ab);
+        sink = ab.beta;
+    }
+    inv->ns_call = (now_ns() - t0) / BENCH_CALLS;
+}
+
+/* PI: mismas medidas 'meas' para la versión Q15 y la referencia (las
+   genera el lazo Q15), así se compara el núcleo y no la planta. Cuenta en
+   'windup' las veces que la integral Q30 sale de los límites de salida. */
+static void check_pi(Result_t *res, long *windup)
+{
+    static const int16_t kps[] = { FOC_Q15(0.1), FOC_Q15(0.5), FOC_Q15(0.99) };
+    static const uint8_t shifts[] = { 0, 2, 4 };
+    static const int16_t kis[] = { FOC_Q15(0.001), FOC_Q15(0.02), FOC_Q15(0.2) };
+    static const int16_t lims[][2] = {
+        { FOC_Q15_MIN, FOC_Q15_MAX },
+        { FOC_Q15(-0.5), FOC_Q15(0.25) },
+    };
+    static const int16_t amps[] = { FOC_Q15(0.3), FOC_Q15(0.9) };
+    FOC_PI_t pi;
+    FOC_Ref_PI_t ref_pi;
+    unsigned a, b, c, l, m, plant;
+    double t0;
+    long i;
+
+    for (a = 0; a < 3; a++)
+    for (b = 0; b < 3; b++)
+    for (c = 0; c < 3; c++)
+    for (l = 0; l < 2; l++)
+    for (m = 0; m < 2; m++)
+    for (plant = 0; plant < 3; plant++) {
+        int16_t y = 0;
+
+        FOC_PI_Init(&pi, kps[a], kis[c], shifts[b], lims[l][0], lims[l][1]);
+        ref_pi.kp = q15_to_d(kps[a]) * (double)(1u << shifts[b]);
+        ref_pi.ki = q15_to_d(kis[c]);
+        ref_pi.out_min = q15_to_d(lims[l][0]);
+        ref_pi.out_max = q15_to_d(lims[l][1]);
+        ref_pi.integ = 0.0;
+
+        for (i = 0; i < PI_STEPS; i++) {
+            int16_t r = ((i / PI_HALF) & 1) ? (int16_t)-amps[m] : amps[m];
+            int16_t meas, u;
+            double u_ref;
+
+            switch (plant) {
+                case 0:  meas = y; break;                  /* lazo cerrado     */
+                case 1:  meas = 0; break;                  /* lazo abierto     */
+                default: meas = (int16_t)-r; break;        /* error saturado   */
+            }
+            u = FOC_PI_Update(&pi, r, meas);
+            u_ref = FOC_Ref_PI(&ref_pi, q15_to_d(r), q15_to_d(meas));
+            track(res, err_lsb(u, u_ref));
+
+            if (pi.integ > (int32_t)pi.out_max * 32768L ||
+                pi.integ < (int32_t)pi.out_min * 32768L) {
+                (*windup)++;
+            }
+            y = (int16_t)(y + ((u - y) >> 4));             /* planta 1er orden */
+        }
+    }
+
+    FOC_PI_Init(&pi, FOC_Q15(0.5), FOC_Q15(0.02), 2, FOC_Q15_MIN, FOC_Q15_MAX);
+    t0 = now_ns();
+    for (i = 0; i < BENCH_CALLS; i++) {
+        sink = FOC_PI_Update(&pi, (int16_t)(i * 7), (int16_t)(i * 13));
+    }
+    res->ns_call = (now_ns() - t0) / BENCH_CALLS;
+}
+
+int main(void)
+{
+    Result_t res[] = {
+        { "FOC_SinCos",  0.0, TOL_SINCOS,  0, 0.0 },
+        { "FOC_Clarke",  0.0, TOL_CLARKE,  0, 0.0 },
+        { "FOC_Park",    0.0, TOL_PARK,    0, 0.0 },
+        { "FOC_InvPark", 0.0, TOL_INVPARK, 0, 0.0 },
+        { "FOC_PI",      0.0, TOL_PI,      0, 0.0 },
+    };
+    unsigned i;
+    int errors = 0;
+    long windup = 0;
+
+    check_sincos(&res[0]);
+    check_clarke(&res[1]);
+    check_park(&res[2], &res[3]);
+    check_pi(&res[4], &windup);
+
+    printf("%-12s %10s %8s %9s %8s\n", "nucleo", "muestras", "err LSB", "tol LSB", "ns/llam");
+    for (i = 0; i < sizeof(res) / sizeof(res[0]); i++) {
+        bool ok = res[i].max_err <= res[i].tol;
+
+        printf("%-12s %10ld %8.2f %9.1f %8.2f %s\n", res[i].name, res[i].samples,
+               res[i].max_err, res[i].tol, res[i].ns_call, ok ? "" : "FALLO");
+        if (!ok) errors++;
+    }
+    printf("anti-windup: %ld pasos con la integral fuera de [out_min, out_max] %s\n",
+           windup, windup ? "FALLO" : "");
+    if (windup) errors++;
+
+    printf("%s (%d fallos)\n", errors ? "ERROR" : "OK", errors);
+    return errors ? 1 : 0;
+}
@@ -7,6 +7,9 @@
  ******************************************************************************/
 
 #include "i2c.h"
+#include "i2c_isr.h"
+#include "board.h"
+#include "irq.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -32,14 +35,66 @@ static uint16_t i2c1_tx_index = 0;
 static uint16_t i2c2_rx_index = 0;
 static uint16_t i2c2_tx_index = 0;
 
-// Callbacks
-static I2C_Callback_t i2c1_callback = NULL;
+// Callbacks (el de I2C1 lo usan los vectores de i2c_isr.h)
+I2C_Callback_t I2C1_Callback = NULL;
 static I2C_Callback_t i2c2_callback = NULL;
 
+// Esclavo con mapa de registros: sin mapa se sirve un registro fijo
+static uint8_t i2c1_map_dummy = 0xFF;
+#define _I2C_BANK_EMPTY     { 0, &i2c1_map_dummy, 1, 0, 0 }
+I2C_SlaveMap_t I2C1_SlaveMap = {
+    { _I2C_BANK_EMPTY, _I2C_BANK_EMPTY, _I2C_BANK_EMPTY, _I2C_BANK_EMPTY },
+    1, false, &I2C1_SlaveMap.bank[0], 0, I2C_SLV_PHASE_POINTER
+};
+
+// Esclavo con callback: bytes preparados para el maestro
+I2C_SlaveTx_t I2C1_SlaveTx;
+
+#ifdef I2C_ISR_PROFILE
+volatile uint16_t I2C1_IsrWorst[2];
+#endif
+
+// Arbitraje multi-maestro: contadores y generador del backoff
+typedef struct {
+    I2C_ArbStats_t stats;
+    uint16_t rng;               // xorshift16, nunca 0
+} _I2C_Arb_t;
+
+static _I2C_Arb_t i2c1_arb = { { 0, 0, 0, 0 }, 0xACE1u };
+static _I2C_Arb_t i2c2_arb = { { 0, 0, 0, 0 }, 0xACE1u };
+
 // =============================================================================
 // FUNCIONES PRIVADAS
 // =============================================================================
 
+// Desplazamientos respecto a I2CxCON (orden del mapa de memoria:
+// RCV, TRN, BRG, CON, STAT, ADD, MSK)
+#define _I2C_OFS_RCV    (-3)
+#define _I2C_OFS_TRN    (-2)
+#define _I2C_OFS_BRG    (-1)
+#define _I2C_OFS_STAT   1
+#define _I2C_OFS_ADD    2
+#define _I2C_OFS_MSK    3
+
+// Punto de sincronización con el modelo del bus en el PC (i2c_bus_sim.c).
+// En el dispositivo no genera código.
+#ifdef I2C_SIM
+#include "i2c_bus_sim.h"
+#define _I2C_HW_SYNC()      I2CSim_Step()
+#define _I2C_DELAY_US(us)   I2CSim_Idle(us)
+#else
+#include "config.h"         // FCY para __delay_us
+#define _I2C_HW_SYNC()
+#define _I2C_DELAY_US(us)   DELAY_US(us)
+#endif
+
+// Bits de I2CxSTAT
+#define _I2C_STAT_ACKSTAT   (1u << 15)
+#define _I2C_STAT_TRSTAT    (1u << 14)
+#define _I2C_STAT_BCL       (1u << 10)
+#define _I2C_STAT_IWCOL     (1u << 7)
+#define _I2C_STAT_I2COV     (1u << 6)
+
 /**
  * @brief Obtiene puntero al módulo I2C
  */
@@ -84,31 +139,30 @@ static I2C_Config_t* _I2C_GetConfig(I2C_Module_t module) {
     }
 }
 
+/**
+ * @brief Obtiene contadores y generador del backoff
+ */
+static _I2C_Arb_t* _I2C_GetArb(I2C_Module_t module) {
+    switch(module) {
+        case I2C_MODULE_1: return &i2c1_arb;
+        case I2C_MODULE_2: return &i2c2_arb;
+        default: return &i2c1_arb;
+    }
+}
+
 /**
  * @brief Configura pines I2C
  */
 static void _I2C_ConfigurePins(I2C_Module_t module) {
     switch(module) {
         case I2C_MODULE_1:
-            // I2C1: SCL1 - RC3, SDA1 - RC4
-            ANSELCbits.ANSC3 = 0;  // Digital
-            ANSELCbits.ANSC4 = 0;  // Digital
-            TRISCbits.TRISC3 = 1;  // Input
-            TRISCbits.TRISC4 = 1;  // Input
-            // Open-drain configuration
-            ODCONCbits.ODCC3 = 1;  // Open-drain
-            ODCONCbits.ODCC4 = 1;  // Open-drain
+            // I2C1: SCL1 - RB8, SDA1 - RB9 (tabla de board.c)
+            // El módulo fuerza el open-drain al habilitarse
+            BOARD_PinsInit(BOARD_VARIANT_I2C);
             break;
             
         case I2C_MODULE_2:
-            // I2C2: SCL2 - RG2, SDA2 - RG3
-            ANSELGbits.ANSG2 = 0;  // Digital
-            ANSELGbits.ANSG3 = 0;  // Digital
-            TRISGbits.TRISG2 = 1;  // Input
-            TRISGbits.TRISG3 = 1;  // Input
-            // Open-drain configuration
-            ODCONGbits.ODCG2 = 1;  // Open-drain
-            ODCONGbits.ODCG3 = 1;  // Open-drain
+            // dsPIC33FJ32MC204 no tiene I2C2: no hay pines que configurar
             break;
     }
 }
@@ -117,12 +171,12 @@ static void _I2C_ConfigurePins(I2C_Module_t module) {
  * @brief Calcula baud rate register
  */
 static uint16_t _I2C_CalculateBRG(uint32_t fcy, uint32_t desired_speed) {
-    // Fórmula: BRG = (Fcy / (2 * Fscl)) - 2
+    // Fórmula (FRM I2C): BRG = Fcy / Fscl - Fcy / 10 MHz - 1
     // Donde Fscl = desired_speed
-    uint32_t brg = (fcy / (2 * desired_speed)) - 2;
+    uint32_t brg = fcy / desired_speed - fcy / 10000000UL - 1;
     
-    // Limitar a valor máximo de 16 bits
-    if (brg > 0xFFFF) brg = 0xFFFF;
+    // Limitar a valor máximo de 9 bits
+    if (brg > 0x01FF) brg = 0x01FF;
     if (brg < 2) brg = 2;  // Mínimo según datasheet
     
     return (uint16_t)brg;
@@ -133,28 +187,133 @@ static uint16_t _I2C_CalculateBRG(uint32_t fcy, uint32_t desired_speed) {
  */
 static bool _I2C_WaitCondition(I2C_Module_t module, uint16_t timeout_ms) {
     volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    uint32_t timeout_counter = timeout_ms * 1000;  // Aproximado
+    volatile uint16_t* i2c_stat = i2c_con + _I2C_OFS_STAT;
+    uint32_t timeout_counter = (uint32_t)timeout_ms * 1000;  // Aproximado
     
-    while ((*i2c_con & 0x1F) != 0 && timeout_counter--) {
+    // SEN/RSEN/PEN/RCEN/ACKEN a 0 y sin transmisión en curso (TRSTAT)
+    _I2C_HW_SYNC();
+    while ((*i2c_con & 0x1F) != 0 || (*i2c_stat & _I2C_STAT_TRSTAT)) {
+        _I2C_HW_SYNC();
         // Verificar errores
-        if (*i2c_con & (1 << 9)) {  // I2COV (Overflow)
+        if (*i2c_stat & _I2C_STAT_I2COV) {  // Overflow
             *_I2C_GetState(module) = I2C_STATE_OVERRUN;
             return false;
         }
-        if (*i2c_con & (1 << 8)) {  // IWCOL (Write collision)
+        if (*i2c_stat & _I2C_STAT_IWCOL) {  // Write collision
             *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
             return false;
         }
+        if (*i2c_stat & _I2C_STAT_BCL) {    // Otro maestro ganó el bus
+            *_I2C_GetState(module) = I2C_STATE_ARB_LOST;
+            return false;
+        }
+        if (timeout_counter-- == 0) {
+            *_I2C_GetState(module) = I2C_STATE_TIMEOUT;
+            return false;
+        }
+    }
+    
+    // Una escritura en TRN con el bus ocupado se descarta con IWCOL
+    if (*i2c_stat & _I2C_STAT_IWCOL) {
+        *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
+        return false;
+    }
+    
+    // Con BCL el módulo aborta la operación y deja SEN..ACKEN a 0
+    if (*i2c_stat & _I2C_STAT_BCL) {
+        *_I2C_GetState(module) = I2C_STATE_ARB_LOST;
+        return false;
     }
     
-    if (timeout_counter == 0) {
-        *_I2C_GetState(module) = I2C_STATE_TIMEOUT;
+    return true;
+}
+
+/**
+ * @brief El bus lo tiene otro maestro (la transacción se puede repetir)
+ */
+static bool _I2C_BusLost(I2C_State_t state) {
+    return state == I2C_STATE_ARB_LOST || state == I2C_STATE_BUS_COLLISION;
+}
+
+/**
+ * @brief Suelta el bus tras BCL y lo cuenta
+ *
+ * Al perder el arbitraje el módulo ya dejó SDA y SCL libres: no se genera
+ * STOP (el bus es del otro maestro). Basta borrar BCL/IWCOL para que el
+ * módulo acepte la próxima orden.
+ */
+static void _I2C_ReleaseBus(I2C_Module_t module) {
+    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    volatile uint16_t* i2c_stat = i2c_con + _I2C_OFS_STAT;
+    I2C_ArbStats_t* stats = &_I2C_GetArb(module)->stats;
+    
+    if (*_I2C_GetState(module) == I2C_STATE_ARB_LOST) stats->arb_lost++;
+    else stats->collisions++;
+    
+    *i2c_con &= ~0x001F;  // SEN/RSEN/PEN/RCEN/ACKEN
+    *i2c_stat &= ~(_I2C_STAT_BCL | _I2C_STAT_IWCOL);
+    *_I2C_GetBusyFlag(module) = false;
+}
+
+/**
+ * @brief xorshift16 (periodo 65535): reparte los reintentos de varios maestros
+ */
+static uint16_t _I2C_Random(_I2C_Arb_t* arb) {
+    uint16_t x = arb->rng;
+    
+    x ^= (uint16_t)(x << 7);
+    x ^= (uint16_t)(x >> 9);
+    x ^= (uint16_t)(x << 8);
+    arb->rng = x;
+    return x;
+}
+
+/**
+ * @brief Decide si se repite una transacción fallida y espera el backoff
+ *
+ * Solo se repite si se perdió el bus: un NACK o un timeout no se arreglan
+ * repitiendo. La espera es aleatoria entre la mitad y el total de una
+ * ventana que se dobla en cada intento, para que dos maestros que
+ * chocaron no vuelvan a arrancar a la vez.
+ */
+static bool _I2C_Backoff(I2C_Module_t module, uint8_t attempt) {
+    _I2C_Arb_t* arb = _I2C_GetArb(module);
+    uint32_t window;
+    uint16_t half;
+    
+    if (!_I2C_BusLost(*_I2C_GetState(module))) return false;
+    if (attempt >= I2C_ARB_RETRIES) {
+        arb->stats.failures++;
         return false;
     }
     
+    window = (uint32_t)I2C_ARB_BACKOFF_US << attempt;
+    if (window > I2C_ARB_BACKOFF_MAX_US) window = I2C_ARB_BACKOFF_MAX_US;
+    half = (uint16_t)(window / 2);
+    
+    arb->stats.retries++;
+    I2C_DelayUs((uint16_t)(half + _I2C_Random(arb) % (half + 1u)));
     return true;
 }
 
+/**
+ * @brief Cierra una transacción fallida conservando la causa
+ */
+static void _I2C_Abort(I2C_Module_t module, bool address_phase) {
+    volatile I2C_State_t* state = _I2C_GetState(module);
+    I2C_State_t cause = *state;
+    
+    if (address_phase && cause == I2C_STATE_DATA_NACK) cause = I2C_STATE_ADDR_NACK;
+    if (*(_I2C_GetModuleBase(module) + _I2C_OFS_STAT) & _I2C_STAT_BCL) {
+        _I2C_ReleaseBus(module);  // sin STOP: el bus es del otro maestro
+        *state = cause;
+        return;
+    }
+    I2C_Stop(module);
+    *state = cause;  // I2C_Stop deja IDLE: conservar la causa
+    *_I2C_GetBusyFlag(module) = false;  // aunque el STOP no haya salido
+}
+
 // =============================================================================
 // FUNCIONES PÚBLICAS
 // =============================================================================
@@ -173,10 +332,9 @@ void I2C_Init(I2C_Config_t *config) {
     
     // Obtener puntero a registros
     volatile uint16_t* i2c_con = _I2C_GetModuleBase(config->module);
-    volatile uint16_t* i2c_stat = i2c_con + 1;  // I2CxSTAT
-    volatile uint16_t* i2c_add = i2c_con + 2;   // I2CxADD
-    volatile uint16_t* i2c_msk = i2c_con + 3;   // I2CxMSK
-    volatile uint16_t* i2c_brg = i2c_con + 4;   // I2CxBRG
+    volatile uint16_t* i2c_add = i2c_con + _I2C_OFS_ADD;   // I2CxADD
+    volatile uint16_t* i2c_msk = i2c_con + _I2C_OFS_MSK;   // I2CxMSK
+    volatile uint16_t* i2c_brg = i2c_con + _I2C_OFS_BRG;   // I2CxBRG
     
     // Deshabilitar módulo durante configuración
     *i2c_con = 0x0000;
@@ -192,56 +350,68 @@ void I2C_Init(I2C_Config_t *config) {
             *i2c_con = 0x8000;  // I2CEN = 1
             break;
             
+        case I2C_MODE_SLAVE:
         case I2C_MODE_SLAVE_7BIT:
-            // Esclavo 7-bit
-            *i2c_add = config->slave_address << 1;  // Dirección en 7-bit
-            *i2c_msk = 0x0000;  // Sin máscara
-            *i2c_con = 0x8000;  // I2CEN = 1
-            *i2c_con |= 0x4000; // Slave mode
+            // Esclavo 7-bit: ADD<6:0> sin desplazar; MSK = bits que no se comparan
+            *i2c_add = config->slave_address & 0x007F;
+            *i2c_msk = config->slave_mask & 0x007F;
+            *i2c_con = 0x9000;  // I2CEN = 1, SCLREL = 1
             break;
             
         case I2C_MODE_SLAVE_10BIT:
-            // Esclavo 10-bit
-            *i2c_add = config->slave_address;  // Dirección en 10-bit
-            *i2c_con = 0x8000;  // I2CEN = 1
-            *i2c_con |= 0x4400; // Slave mode + 10-bit address
+            // Esclavo 10-bit: ADD<9:0>, MSK<9:0>
+            *i2c_add = config->slave_address & 0x03FF;
+            *i2c_msk = config->slave_mask & 0x03FF;
+            *i2c_con = 0x9000;  // I2CEN = 1, SCLREL = 1
+            *i2c_con |= 0x0400; // A10M = 1
             break;
             
         default:
             break;
     }
     
+    if (config->mode != I2C_MODE_MASTER && config->module == I2C_MODULE_1) {
+        I2C1_SlaveMap.ten_bit = (config->mode == I2C_MODE_SLAVE_10BIT);
+        I2C1_SlaveMap.bank[0].address = config->slave_address;
+        memset(&I2C1_SlaveTx, 0, sizeof(I2C1_SlaveTx));
+    }
+    
+    // General call: el esclavo responde también a 0x00 (con A10M incluido)
+    if (config->mode != I2C_MODE_MASTER && config->general_call_enable) {
+        *i2c_con |= 0x0080;  // GCEN = 1
+    }
+    
     // Configurar SMBus si es necesario
     if (config->smbus_enable) {
-        *i2c_con |= 0x0020;  // SMBEN = 1
+        *i2c_con |= 0x0100;  // SMEN = 1 (umbrales de entrada SMBus)
     }
     
-    // Configurar slew rate
-    if (config->slew_rate_control) {
-        *i2c_con |= 0x0040;  // DISSLW = 0 (slew rate enabled)
-    } else {
-        *i2c_con |= 0x0080;  // DISSLW = 1 (slew rate disabled)
-    }
-    
-    // Configurar interrupciones
-    if (config->interrupt_enable) {
-        switch(config->module) {
-            case I2C_MODULE_1:
-                IFS1bits.I2C1BIF = 0;
-                IEC1bits.I2C1BIE = 1;
-                IPC7bits.I2C1BIP = 4;
-                break;
-            case I2C_MODULE_2:
-                IFS3bits.I2C2BIF = 0;
-                IEC3bits.I2C2BIE = 1;
-                IPC14bits.I2C2BIP = 4;
-                break;
-        }
+    // Configurar slew rate (DISSLW = 0: control de slew activo, para 400 kHz)
+    if (!config->slew_rate_control) {
+        *i2c_con |= 0x0200;  // DISSLW = 1
+    }
+    
+    // Configurar interrupciones: vector maestro (MI2C1) o esclavo (SI2C1).
+    // Este dispositivo solo tiene I2C1; la prioridad sale de irq.c
+    if (config->interrupt_enable && config->module == I2C_MODULE_1) {
+        IRQ_Source_t src = (config->mode == I2C_MODE_MASTER) ? IRQ_SRC_MI2C1 : IRQ_SRC_SI2C1;
+        IRQ_ClearFlag(src);
+        IRQ_SetPriority(src);
+        IRQ_Enable(src, true);
     }
     
+    #ifdef I2C_ISR_PROFILE
+    // Timer2 libre a FCY para medir los vectores de i2c_isr.h
+    T2CON = 0x0000;
+    TMR2 = 0;
+    PR2 = 0xFFFF;
+    T2CONbits.TON = 1;
+    #endif
+    
     // Inicializar estado
     *_I2C_GetState(config->module) = I2C_STATE_IDLE;
     *_I2C_GetBusyFlag(config->module) = false;
+    // La semilla del backoff no se toca: la da el llamador (I2C_SetBackoffSeed)
     
     // Configurar callback
     I2C_SetCallback(config->module, config->callback);
@@ -255,13 +425,9 @@ void I2C_Deinit(I2C_Module_t module) {
     *i2c_con = 0x0000;  // Deshabilitar módulo
     
     // Deshabilitar interrupciones
-    switch(module) {
-        case I2C_MODULE_1:
-            IEC1bits.I2C1BIE = 0;
-            break;
-        case I2C_MODULE_2:
-            IEC3bits.I2C2BIE = 0;
-            break;
+    if (module == I2C_MODULE_1) {
+        IRQ_Enable(IRQ_SRC_MI2C1, false);
+        IRQ_Enable(IRQ_SRC_SI2C1, false);
     }
     
     // Resetear estado
@@ -286,6 +452,11 @@ bool I2C_Start(I2C_Module_t module) {
     
     // Esperar a que se complete
     if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
+        // BCL en el START: SDA o SCL ya estaban a 0 (otro maestro)
+        if (*_I2C_GetState(module) == I2C_STATE_ARB_LOST) {
+            *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
+            _I2C_ReleaseBus(module);
+        }
         *busy = false;
         return false;
     }
@@ -302,8 +473,15 @@ bool I2C_Restart(I2C_Module_t module) {
     // Generar REPEATED START
     *i2c_con |= 0x0002;  // RSEN = 1
     
-    // Esperar a que se complete
-    return _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+    // Esperar a que se complete; con BCL el llamador aborta (_I2C_Abort)
+    if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
+        if (*_I2C_GetState(module) == I2C_STATE_ARB_LOST) {
+            *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
+        }
+        return false;
+    }
+    
+    return true;
 }
 
 /**
@@ -312,12 +490,24 @@ bool I2C_Restart(I2C_Module_t module) {
 bool I2C_Stop(I2C_Module_t module) {
     volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
     volatile bool* busy = _I2C_GetBusyFlag(module);
+    volatile I2C_State_t* state = _I2C_GetState(module);
+    
+    // Tras perder el arbitraje no hay STOP que dar: solo soltar el bus
+    if (*(i2c_con + _I2C_OFS_STAT) & _I2C_STAT_BCL) {
+        if (!_I2C_BusLost(*state)) *state = I2C_STATE_ARB_LOST;
+        _I2C_ReleaseBus(module);
+        return false;
+    }
     
     // Generar condición STOP
     *i2c_con |= 0x0004;  // PEN = 1
     
     // Esperar a que se complete
     if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
+        if (*state == I2C_STATE_ARB_LOST) {
+            *state = I2C_STATE_BUS_COLLISION;
+            _I2C_ReleaseBus(module);
+        }
         return false;
     }
     
@@ -333,21 +523,19 @@ bool I2C_Stop(I2C_Module_t module) {
  */
 bool I2C_WriteByte(I2C_Module_t module, uint8_t data) {
     volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_trn = i2c_con + 5;  // I2CxTRN
+    volatile uint16_t* i2c_trn = i2c_con + _I2C_OFS_TRN;    // I2CxTRN
+    volatile uint16_t* i2c_stat = i2c_con + _I2C_OFS_STAT;  // I2CxSTAT
     
-    // Escribir dato en buffer de transmisión
+    // Escribir en TRN inicia la transmisión (TBF/TRSTAT = 1)
     *i2c_trn = data;
     
-    // Iniciar transmisión
-    *i2c_con |= 0x0008;  // RCEN = 0, PEN = 0, SEN = 0, RSEN = 0, ACKEN = 0
-    
-    // Esperar a que se complete
+    // Esperar a que se complete (TRSTAT = 0 tras el ACK)
     if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
         return false;
     }
     
     // Verificar ACK
-    if (*i2c_con & (1 << 15)) {  // ACKSTAT = 1 (NACK recibido)
+    if (*i2c_stat & _I2C_STAT_ACKSTAT) {  // ACKSTAT = 1 (NACK recibido)
         *_I2C_GetState(module) = I2C_STATE_DATA_NACK;
         return false;
     }
@@ -360,44 +548,48 @@ bool I2C_WriteByte(I2C_Module_t module, uint8_t data) {
  */
 uint8_t I2C_ReadByte(I2C_Module_t module, bool ack) {
     volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_rcv = i2c_con + 6;  // I2CxRCV
-    
-    // Configurar recepción
-    if (ack) {
-        *i2c_con &= ~(1 << 4);  // ACKDT = 0 (ACK)
-    } else {
-        *i2c_con |= (1 << 4);   // ACKDT = 1 (NACK)
-    }
+    volatile uint16_t* i2c_rcv = i2c_con + _I2C_OFS_RCV;  // I2CxRCV
+    uint16_t timeout_ms = _I2C_GetConfig(module)->timeout_ms;
+    uint8_t data;
     
     // Iniciar recepción
     *i2c_con |= 0x0008;  // RCEN = 1
     
     // Esperar a que se complete
-    _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+    if (!_I2C_WaitCondition(module, timeout_ms)) return 0xFF;
     
-    // Leer dato recibido
-    return (uint8_t)(*i2c_rcv & 0x00FF);
+    // Leer dato recibido (borra RBF)
+    data = (uint8_t)(*i2c_rcv & 0x00FF);
+    
+    // Secuencia de ACK/NACK
+    if (ack) {
+        *i2c_con &= ~(1 << 5);  // ACKDT = 0 (ACK)
+    } else {
+        *i2c_con |= (1 << 5);   // ACKDT = 1 (NACK)
+    }
+    *i2c_con |= (1 << 4);       // ACKEN = 1
+    _I2C_WaitCondition(module, timeout_ms);
+    
+    return data;
 }
 
 /**
- * @brief Escribe datos a un dispositivo esclavo
+ * @brief Un intento de escritura (I2C_WriteData repite si se pierde el bus)
  */
-bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t length) {
-    if (length == 0 || data == NULL) return false;
-    
+static bool _I2C_WriteOnce(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t length) {
     // Generar START
     if (!I2C_Start(module)) return false;
     
     // Enviar dirección + bit de escritura
     if (!I2C_WriteByte(module, (address << 1) | 0x00)) {
-        I2C_Stop(module);
+        _I2C_Abort(module, true);
         return false;
     }
     
     // Enviar datos
     for (uint8_t i = 0; i < length; i++) {
         if (!I2C_WriteByte(module, data[i])) {
-            I2C_Stop(module);
+            _I2C_Abort(module, false);
             return false;
         }
     }
@@ -407,17 +599,17 @@ bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t
 }
 
 /**
- * @brief Lee datos de un dispositivo esclavo
+ * @brief Un intento de lectura (I2C_ReadData repite si se pierde el bus)
  */
-bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t length) {
-    if (length == 0 || buffer == NULL) return false;
+static bool _I2C_ReadOnce(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t length) {
+    volatile I2C_State_t* state = _I2C_GetState(module);
     
     // Generar START
     if (!I2C_Start(module)) return false;
     
     // Enviar dirección + bit de lectura
     if (!I2C_WriteByte(module, (address << 1) | 0x01)) {
-        I2C_Stop(module);
+        _I2C_Abort(module, true);
         return false;
     }
     
@@ -425,12 +617,48 @@ bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t
     for (uint8_t i = 0; i < length; i++) {
         bool ack = (i < length - 1);  // ACK en todos menos el último
         buffer[i] = I2C_ReadByte(module, ack);
+        if (*state != I2C_STATE_BUSY) {  // timeout, overrun o bus perdido en el ACK
+            _I2C_Abort(module, false);
+            return false;
+        }
     }
     
     // Generar STOP
     return I2C_Stop(module);
 }
 
+/**
+ * @brief Escribe datos a un dispositivo esclavo
+ *
+ * Si otro maestro gana el bus, repite hasta I2C_ARB_RETRIES veces con
+ * backoff; si aun así falla, I2C_GetLastError indica ARB_LOST o
+ * BUS_COLLISION.
+ */
+bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t length) {
+    uint8_t attempt = 0;
+    
+    if (length == 0 || data == NULL) return false;
+    
+    while (!_I2C_WriteOnce(module, address, data, length)) {
+        if (!_I2C_Backoff(module, attempt++)) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lee datos de un dispositivo esclavo (con reintentos como I2C_WriteData)
+ */
+bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t length) {
+    uint8_t attempt = 0;
+    
+    if (length == 0 || buffer == NULL) return false;
+    
+    while (!_I2C_ReadOnce(module, address, buffer, length)) {
+        if (!_I2C_Backoff(module, attempt++)) return false;
+    }
+    return true;
+}
+
 /**
  * @brief Escribe a un registro específico
  */
@@ -456,6 +684,19 @@ uint8_t I2C_ReadRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr
     return value;
 }
 
+/**
+ * @brief Escritura por general call a todos los esclavos que lo escuchan
+ *
+ * Una sola transacción en lugar de una por dispositivo: todos reciben los
+ * bytes en el mismo flanco de SCL. El ACK solo indica que al menos uno
+ * escucha (ADDR_NACK = ninguno); no hay forma de saber cuántos. El primer
+ * byte no debe ser I2C_GC_RESET_ADDRESS ni I2C_GC_WRITE_ADDRESS si hay
+ * dispositivos estándar en el bus.
+ */
+bool I2C_BroadcastWrite(I2C_Module_t module, uint8_t *data, uint8_t length) {
+    return I2C_WriteData(module, I2C_GENERAL_CALL_ADDRESS, data, length);
+}
+
 /**
  * @brief Escanea el bus I2C buscando dispositivos
  */
@@ -496,7 +737,7 @@ bool I2C_CheckDevice(I2C_Module_t module, uint8_t address) {
 void I2C_SetCallback(I2C_Module_t module, I2C_Callback_t callback) {
     switch(module) {
         case I2C_MODULE_1:
-            i2c1_callback = callback;
+            I2C1_Callback = callback;
             break;
         case I2C_MODULE_2:
             i2c2_callback = callback;
@@ -506,41 +747,224 @@ void I2C_SetCallback(I2C_Module_t module, I2C_Callback_t callback) {
 
 /**
  * @brief Handler de interrupción I2C
+ *
+ * Para código que no usa los vectores de i2c_isr.h: atiende la fuente
+ * (maestro o esclavo) que tenga la bandera activa. I2C2 no existe en
+ * este dispositivo.
  */
 void I2C_ISR_Handler(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_stat = i2c_con + 1;
-    I2C_Callback_t callback = NULL;
-    
-    // Obtener callback
-    switch(module) {
-        case I2C_MODULE_1:
-            callback = i2c1_callback;
-            IFS1bits.I2C1BIF = 0;  // Limpiar flag
-            break;
-        case I2C_MODULE_2:
-            callback = i2c2_callback;
-            IFS3bits.I2C2BIF = 0;  // Limpiar flag
-            break;
+    if (module != I2C_MODULE_1) return;
+
+    if (IFS1bits.SI2C1IF) _I2C1_SlaveCallbackIsr();
+    if (IFS1bits.MI2C1IF) _I2C1_MasterIsr();
+}
+
+/**
+ * @brief Asocia un mapa de registros al esclavo (vector I2C1_VECTOR_SLAVE_MAP)
+ *
+ * El maestro escribe [puntero][datos...] y lee desde el puntero actual;
+ * el puntero avanza y vuelve a 0 al final del mapa. Es el banco 0: el que
+ * responde a slave_address y a cualquier dirección sin banco propio.
+ */
+void I2C_SlaveAttachMap(I2C_Module_t module, uint8_t *regs, uint8_t size) {
+    I2C_SlaveAttachBank(module, 0, _I2C_GetConfig(module)->slave_address, regs, size);
+}
+
+/**
+ * @brief Asocia un mapa de registros a una dirección del rango de slave_mask
+ *
+ * Cada banco tiene su propio puntero, así que una placa puede emular
+ * varios dispositivos independientes.
+ */
+bool I2C_SlaveAttachBank(I2C_Module_t module, uint8_t bank, uint16_t address, uint8_t *regs, uint8_t size) {
+    I2C_SlaveMap_t *m = &I2C1_SlaveMap;
+    I2C_SlaveBank_t *b;
+
+    if (module != I2C_MODULE_1 || bank >= I2C_SLAVE_BANKS) return false;
+
+    IRQ_Enable(IRQ_SRC_SI2C1, false);
+    if (regs == NULL || size == 0) {
+        regs = &i2c1_map_dummy;
+        size = 1;
     }
+    b = &m->bank[bank];
+    b->address = address;
+    b->regs = regs;
+    b->size = size;
+    b->ptr = 0;
+    b->events = 0;
+    if (bank >= m->nbanks) m->nbanks = (uint8_t)(bank + 1u);
+    m->cur = &m->bank[0];
+    m->phase = I2C_SLV_PHASE_POINTER;
+    IRQ_Enable(IRQ_SRC_SI2C1, _I2C_GetConfig(module)->interrupt_enable);
+    return true;
+}
+
+/**
+ * @brief Devuelve y borra los eventos I2C_SLV_EV_xxx de todos los bancos
+ */
+uint8_t I2C_SlaveTakeEvents(I2C_Module_t module) {
+    uint8_t ev = 0;
+    uint8_t i;
+
+    if (module != I2C_MODULE_1) return 0;
+
+    for (i = 0; i < I2C1_SlaveMap.nbanks; i++) ev |= I2C_SlaveTakeBankEvents(module, i);
+    return ev;
+}
+
+/**
+ * @brief Devuelve y borra los eventos I2C_SLV_EV_xxx de un banco
+ */
+uint8_t I2C_SlaveTakeBankEvents(I2C_Module_t module, uint8_t bank) {
+    I2C_SlaveBank_t *b;
+    uint8_t ev;
+
+    if (module != I2C_MODULE_1 || bank >= I2C_SLAVE_BANKS) return 0;
+
+    b = &I2C1_SlaveMap.bank[bank];
+    ev = b->events;
+    b->events &= (uint8_t)~ev;  // BCLR atómico frente a la ISR
+    return ev;
+}
+
+/**
+ * @brief Actualiza un banco sin partir una transacción del maestro
+ *
+ * Copia 'length' bytes en regs[offset..] solo si el bus está libre (no
+ * hay START sin su STOP). Con la ISR del esclavo deshabilitada durante la
+ * copia, un maestro que direccione el banco mientras tanto espera con SCL
+ * retenido y lee la imagen completa. Así los campos de varios bytes nunca
+ * mezclan valores viejos y nuevos.
+ *
+ * @return false si hay una transacción en curso (reintentar más tarde)
+ */
+bool I2C_SlaveBankUpdate(I2C_Module_t module, uint8_t bank, uint8_t offset, const uint8_t *src, uint8_t length) {
+    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    I2C_SlaveBank_t *b;
+    bool idle;
+
+    if (module != I2C_MODULE_1 || bank >= I2C1_SlaveMap.nbanks || src == NULL) return false;
+    b = &I2C1_SlaveMap.bank[bank];
+    if ((uint16_t)offset + length > b->size) return false;
+
+    IRQ_Enable(IRQ_SRC_SI2C1, false);
+    idle = !(*(i2c_con + _I2C_OFS_STAT) & 0x0008);  // S = 0: sin transacción abierta
+    if (idle) memcpy(&b->regs[offset], src, length);
+    IRQ_Enable(IRQ_SRC_SI2C1, _I2C_GetConfig(module)->interrupt_enable);
+    return idle;
+}
+
+/**
+ * @brief Cambia la dirección propia del esclavo (7 o 10 bits según A10M)
+ */
+void I2C_SetSlaveAddress(I2C_Module_t module, uint16_t address) {
+    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    uint16_t bits = (*i2c_con & 0x0400) ? 0x03FF : 0x007F;
+
+    *(i2c_con + _I2C_OFS_ADD) = address & bits;
+    _I2C_GetConfig(module)->slave_address = address;
+    if (module == I2C_MODULE_1) I2C1_SlaveMap.bank[0].address = address;
+}
+
+/**
+ * @brief Responder (o no) al general call como esclavo
+ *
+ * Con el mapa de registros los bytes difundidos van al banco 0 y marcan
+ * I2C_SLV_EV_GENCALL; con callback llega I2C_EVENT_GENERAL_CALL y luego
+ * los datos.
+ */
+void I2C_EnableGeneralCall(I2C_Module_t module, bool enable) {
+    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
     
-    if (callback == NULL) return;
-    
-    // Determinar evento
-    if (*i2c_stat & (1 << 15)) {  // Start bit detectado
-        callback(I2C_EVENT_START, 0);
-    }
-    else if (*i2c_stat & (1 << 14)) {  // Stop bit detectado
-        callback(I2C_EVENT_STOP, 0);
-    }
-    else if (*i2c_stat & (1 << 13)) {  // Datos recibidos
-        volatile uint16_t* i2c_rcv = i2c_con + 6;
-        uint8_t data = (uint8_t)(*i2c_rcv & 0x00FF);
-        callback(I2C_EVENT_DATA_RECEIVED, data);
-    }
-    else if (*i2c_stat & (1 << 12)) {  // Solicitud de datos
-        callback(I2C_EVENT_DATA_REQUESTED, 0);
+    if (enable) *i2c_con |= 0x0080;   // GCEN = 1
+    else *i2c_con &= ~0x0080;
+    _I2C_GetConfig(module)->general_call_enable = enable;
+}
+
+/**
+ * @brief Bits de dirección que no se comparan (1 = cualquier valor)
+ *
+ * Con ADD = 0x48 y MSK = 0x03 el esclavo responde a 0x48..0x4B.
+ */
+void I2C_SetSlaveMask(I2C_Module_t module, uint16_t mask) {
+    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    uint16_t bits = (*i2c_con & 0x0400) ? 0x03FF : 0x007F;
+
+    *(i2c_con + _I2C_OFS_MSK) = mask & bits;
+    _I2C_GetConfig(module)->slave_mask = mask;
+}
+
+/**
+ * @brief Byte recibido pendiente de leer (esclavo sin interrupciones)
+ */
+bool I2C_DataReady(I2C_Module_t module) {
+    return (*(_I2C_GetModuleBase(module) + _I2C_OFS_STAT) & 0x0002) != 0;  // RBF
+}
+
+/**
+ * @brief Lee el byte recibido (borra RBF)
+ */
+uint8_t I2C_GetByte(I2C_Module_t module) {
+    return (uint8_t)(*(_I2C_GetModuleBase(module) + _I2C_OFS_RCV) & 0x00FF);
+}
+
+/**
+ * @brief Prepara el próximo byte que leerá el maestro (esclavo con callback)
+ *
+ * Se puede llamar antes de que el maestro pida el byte (al recibir el
+ * puntero, o en I2C_EVENT_DATA_REQUESTED para el siguiente): la ISR lo
+ * carga y libera SCL sin esperar al callback. Si SCL ya está retenido
+ * esperando dato, lo entrega y libera el bus. Con la cola llena el byte
+ * se descarta. Lo preparado se descarta al NACK final del maestro y al
+ * recibir una nueva dirección de escritura.
+ */
+void I2C_PutByte(I2C_Module_t module, uint8_t data) {
+    I2C_SlaveTx_t *t = &I2C1_SlaveTx;
+    uint8_t head, next;
+
+    if (module != I2C_MODULE_1) return;
+
+    IRQ_Enable(IRQ_SRC_SI2C1, false);
+    head = t->head;
+    next = (uint8_t)((head + 1u) & (I2C_SLAVE_TX_STAGE - 1u));
+    if (next != t->tail) {
+        t->buf[head] = data;
+        t->head = next;
     }
+    if (t->hold && _I2C1_SlaveTxPop()) t->hold = false;
+    IRQ_Enable(IRQ_SRC_SI2C1, _I2C_GetConfig(module)->interrupt_enable);
+}
+
+/**
+ * @brief Bytes preparados con I2C_PutByte que el maestro aún no ha pedido
+ */
+uint8_t I2C_SlaveTxStaged(I2C_Module_t module) {
+    if (module != I2C_MODULE_1) return 0;
+    return (uint8_t)((I2C1_SlaveTx.head - I2C1_SlaveTx.tail) & (I2C_SLAVE_TX_STAGE - 1u));
+}
+
+/**
+ * @brief Última dirección a la que respondió el esclavo (útil con máscara)
+ */
+uint16_t I2C_GetReceivedAddress(I2C_Module_t module) {
+    if (module != I2C_MODULE_1) return 0;
+    return I2C1_SlaveMap.address;
+}
+
+/**
+ * @brief Peor duración del cuerpo de cada vector I2C1 (ciclos de Timer2)
+ *
+ * Solo con I2C_ISR_PROFILE; sin él devuelve 0.
+ */
+void I2C_GetIsrProfile(uint16_t *master_cycles, uint16_t *slave_cycles) {
+    #ifdef I2C_ISR_PROFILE
+    if (master_cycles) *master_cycles = I2C1_IsrWorst[0];
+    if (slave_cycles) *slave_cycles = I2C1_IsrWorst[1];
+    #else
+    if (master_cycles) *master_cycles = 0;
+    if (slave_cycles) *slave_cycles = 0;
+    #endif
 }
 
 /**
@@ -554,7 +978,7 @@ void I2C_PrintConfig(I2C_Module_t module) {
                          cfg->mode == I2C_MODE_SLAVE_7BIT ? "Esclavo 7-bit" : 
                          "Esclavo 10-bit");
     printf("Velocidad: %lu Hz\n", cfg->speed);
-    printf("Dirección esclavo: 0x%02X\n", cfg->slave_address);
+    printf("Dirección esclavo: 0x%03X (máscara 0x%03X)\n", cfg->slave_address, cfg->slave_mask);
     printf("Timeout: %d ms\n", cfg->timeout_ms);
     printf("General Call: %s\n", cfg->general_call_enable ? "Habilitado" : "Deshabilitado");
     printf("SMBus: %s\n", cfg->smbus_enable ? "Habilitado" : "Deshabilitado");
@@ -566,14 +990,16 @@ void I2C_PrintConfig(I2C_Module_t module) {
  * @brief Espera a que el bus esté libre
  */
 bool I2C_WaitIdle(I2C_Module_t module, uint16_t timeout_ms) {
-    volatile uint16_t* i2c_stat = _I2C_GetModuleBase(module) + 1;
-    uint32_t timeout_counter = timeout_ms * 1000;
+    volatile uint16_t* i2c_stat = _I2C_GetModuleBase(module) + _I2C_OFS_STAT;
+    uint32_t timeout_counter = (uint32_t)timeout_ms * 1000;
     
-    while ((*i2c_stat & (1 << 14)) && timeout_counter--) {
-        // Esperar activamente
+    _I2C_HW_SYNC();
+    while (*i2c_stat & _I2C_STAT_TRSTAT) {
+        _I2C_HW_SYNC();
+        if (timeout_counter-- == 0) return false;
     }
     
-    return (timeout_counter > 0);
+    return true;
 }
 
 /**
@@ -590,8 +1016,42 @@ void I2C_ClearErrors(I2C_Module_t module) {
     *_I2C_GetState(module) = I2C_STATE_IDLE;
     
     // Limpiar flags de error en el módulo
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    *i2c_con &= ~((1 << 9) | (1 << 8));  // Limpiar I2COV e IWCOL
+    volatile uint16_t* i2c_stat = _I2C_GetModuleBase(module) + _I2C_OFS_STAT;
+    *i2c_stat &= ~(_I2C_STAT_I2COV | _I2C_STAT_IWCOL | _I2C_STAT_BCL);  // I2COV, IWCOL y BCL
+}
+
+/**
+ * @brief Copia los contadores de arbitraje
+ */
+void I2C_GetArbStats(I2C_Module_t module, I2C_ArbStats_t *stats) {
+    if (stats) *stats = _I2C_GetArb(module)->stats;
+}
+
+/**
+ * @brief Pone a cero los contadores de arbitraje
+ */
+void I2C_ResetArbStats(I2C_Module_t module) {
+    memset(&_I2C_GetArb(module)->stats, 0, sizeof(I2C_ArbStats_t));
+}
+
+/**
+ * @brief Semilla del backoff
+ *
+ * Dos maestros con el mismo firmware y la misma semilla esperarían lo
+ * mismo y volverían a chocar: la semilla debe ser distinta en cada placa
+ * (número de serie grabado en producción, ruido del ADC...). El valor por
+ * defecto es igual en todas; I2C_Init no lo cambia, así que se puede
+ * sembrar antes o después de inicializar.
+ */
+void I2C_SetBackoffSeed(I2C_Module_t module, uint16_t seed) {
+    _I2C_GetArb(module)->rng = seed ? seed : 0xACE1u;  // 0 es punto fijo
+}
+
+/**
+ * @brief Espera activa en microsegundos (backoff de arbitraje)
+ */
+void I2C_DelayUs(uint16_t microseconds) {
+    _I2C_DELAY_US(microseconds);
 }
 
 /**
@@ -13,8 +13,17 @@
  * - Transmisiones síncronas y asíncronas
  * - Buffer para recepción
  * - Timeout y manejo de errores
+ * - Multi-maestro: arbitraje perdido, reintento con backoff aleatorio
+ * - General call: difusión desde el maestro y recepción en el esclavo
  * - Compatible con SMBus/PMBus
  * 
+ * Nota:
+ * - Multi-maestro: el dsPIC33F no tiene número de serie único y la semilla
+ *   del backoff por defecto es la misma en todas las placas. Con varios
+ *   maestros en el bus, el llamador debe llamar a I2C_SetBackoffSeed con un
+ *   valor propio de cada placa (ver i2cmain.c); si no, dos placas con el
+ *   mismo firmware repiten el mismo backoff y vuelven a chocar.
+ * 
  ******************************************************************************/
 
 #ifndef I2C_H
@@ -59,6 +68,12 @@ typedef enum {
 #define I2C_HS_MODE_CODE          0x05
 #define I2C_SET_SPEED             0x06
 
+// Segundo byte del general call con significado fijo (UM10204): un
+// dispositivo estándar en el bus lo interpreta aunque la difusión sea
+// para otra cosa. Las difusiones propias no deben empezar por estos.
+#define I2C_GC_RESET_ADDRESS      0x06  // reset y carga de la dirección
+#define I2C_GC_WRITE_ADDRESS      0x04  // carga de la dirección sin reset
+
 // Estados del bus I2C
 typedef enum {
     I2C_STATE_IDLE,           // Bus libre
@@ -83,18 +98,49 @@ typedef enum {
     I2C_EVENT_DATA_REQUESTED, // Maestro solicita dato
     I2C_EVENT_ACK_SENT,       // ACK enviado
     I2C_EVENT_NACK_SENT,      // NACK enviado
-    I2C_EVENT_ERROR           // Error detectado
+    I2C_EVENT_ERROR,          // Error detectado
+    I2C_EVENT_GENERAL_CALL    // General call (dirección 0x00) recibido
 } I2C_Event_t;
 
 // Callback function type
 typedef void (*I2C_Callback_t)(I2C_Event_t event, uint8_t data);
 
+// Eventos del esclavo con mapa de registros (I2C_SlaveTakeEvents)
+#define I2C_SLV_EV_WRITE    0x01u  // el maestro escribió registros
+#define I2C_SLV_EV_READ     0x02u  // el maestro leyó registros
+#define I2C_SLV_EV_OVERRUN  0x04u  // byte perdido (I2COV)
+#define I2C_SLV_EV_GENCALL  0x08u  // escritura por general call (banco 0)
+
+// Bancos de registros del esclavo: con slave_mask un solo esclavo responde
+// a un rango de direcciones y cada dirección puede tener su propio mapa
+#define I2C_SLAVE_BANKS     4u
+
+// Esclavo con callback: bytes de transmisión preparados con I2C_PutByte
+// antes de que el maestro los pida (potencia de 2; caben STAGE - 1)
+#define I2C_SLAVE_TX_STAGE  8u
+
+// Multi-maestro: I2C_WriteData/ReadData reintentan si pierden el bus
+// (BCL) tras una espera aleatoria dentro de una ventana que se dobla en
+// cada intento, hasta el tope
+#define I2C_ARB_RETRIES         4u      // reintentos tras el primer intento
+#define I2C_ARB_BACKOFF_US      50u     // ventana del primer reintento
+#define I2C_ARB_BACKOFF_MAX_US  2000u   // tope de la ventana
+
+// Contadores de arbitraje (I2C_GetArbStats)
+typedef struct {
+    uint16_t arb_lost;      // arbitraje perdido en dirección o datos
+    uint16_t collisions;    // colisión en START/RESTART/STOP (bus ocupado)
+    uint16_t retries;       // transacciones repetidas
+    uint16_t failures;      // transacciones abandonadas tras los reintentos
+} I2C_ArbStats_t;
+
 // Estructura de configuración
 typedef struct {
     I2C_Module_t module;      // Módulo I2C a usar
     I2C_Mode_t mode;          // Modo de operación
     I2C_Speed_t speed;        // Velocidad del bus
-    uint8_t slave_address;    // Dirección esclavo (7-bit)
+    uint16_t slave_address;   // Dirección esclavo (7 o 10 bits según el modo)
+    uint16_t slave_mask;      // I2CxMSK: bits de dirección que no se comparan
     bool general_call_enable; // Habilitar general call
     bool slew_rate_control;   // Control de slew rate
     bool smbus_enable;        // Habilitar protocolo SMBus
@@ -109,6 +155,7 @@ typedef struct {
     .mode = I2C_MODE_MASTER, \
     .speed = I2C_SPEED_100KHZ, \
     .slave_address = 0x00, \
+    .slave_mask = 0x0000, \
     .general_call_enable = false, \
     .slew_rate_control = true, \
     .smbus_enable = false, \
@@ -123,6 +170,7 @@ typedef struct {
     .mode = I2C_MODE_SLAVE_7BIT, \
     .speed = I2C_SPEED_100KHZ, \
     .slave_address = 0x40, \
+    .slave_mask = 0x0000, \
     .general_call_enable = true, \
     .slew_rate_control = true, \
     .smbus_enable = false, \
@@ -160,14 +208,22 @@ bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t
 bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t length);
 bool I2C_WriteRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr, uint8_t data);
 uint8_t I2C_ReadRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr);
+bool I2C_BroadcastWrite(I2C_Module_t module, uint8_t *data, uint8_t length);
 
 // Funciones esclavo
-void I2C_SetSlaveAddress(I2C_Module_t module, uint8_t address);
+void I2C_SetSlaveAddress(I2C_Module_t module, uint16_t address);
+void I2C_SetSlaveMask(I2C_Module_t module, uint16_t mask);
 void I2C_EnableGeneralCall(I2C_Module_t module, bool enable);
-uint8_t I2C_GetReceivedAddress(I2C_Module_t module);
+uint16_t I2C_GetReceivedAddress(I2C_Module_t module);
 bool I2C_DataReady(I2C_Module_t module);
 uint8_t I2C_GetByte(I2C_Module_t module);
 void I2C_PutByte(I2C_Module_t module, uint8_t data);
+uint8_t I2C_SlaveTxStaged(I2C_Module_t module);
+void I2C_SlaveAttachMap(I2C_Module_t module, uint8_t *regs, uint8_t size);
+bool I2C_SlaveAttachBank(I2C_Module_t module, uint8_t bank, uint16_t address, uint8_t *regs, uint8_t size);
+uint8_t I2C_SlaveTakeEvents(I2C_Module_t module);
+uint8_t I2C_SlaveTakeBankEvents(I2C_Module_t module, uint8_t bank);
+bool I2C_SlaveBankUpdate(I2C_Module_t module, uint8_t bank, uint8_t offset, const uint8_t *src, uint8_t length);
 
 // Funciones avanzadas
 bool I2C_ScanBus(I2C_Module_t module, uint8_t *devices, uint8_t max_devices);
@@ -175,6 +231,9 @@ bool I2C_CheckDevice(I2C_Module_t module, uint8_t address);
 void I2C_SetTimeout(I2C_Module_t module, uint16_t timeout_ms);
 I2C_State_t I2C_GetLastError(I2C_Module_t module);
 void I2C_ClearErrors(I2C_Module_t module);
+void I2C_GetArbStats(I2C_Module_t module, I2C_ArbStats_t *stats);
+void I2C_ResetArbStats(I2C_Module_t module);
+void I2C_SetBackoffSeed(I2C_Module_t module, uint16_t seed);   // distinta por placa (ver Nota)
 
 // Buffer y colas
 bool I2C_WriteBuffer(I2C_Module_t module, uint8_t address, uint8_t *data, uint16_t length);
@@ -186,6 +245,7 @@ uint16_t I2C_GetTxBufferCount(I2C_Module_t module);
 void I2C_SetCallback(I2C_Module_t module, I2C_Callback_t callback);
 void I2C_EnableInterrupts(I2C_Module_t module, bool enable);
 void I2C_ISR_Handler(I2C_Module_t module);
+void I2C_GetIsrProfile(uint16_t *master_cycles, uint16_t *slave_cycles);
 
 // Utilitarias
 void I2C_PrintConfig(I2C_Module_t module);
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * i2c_bus_sim.h - Modelo del bus I2C en el PC para probar el driver
+ *
+ * Descripción: Simula el periférico I2C1 en modo maestro y el bus con sus
+ *              esclavos. El driver (i2c.c) se compila contra los registros
+ *              de sim/xc.h con I2C_SIM definido: sus bucles de espera
+ *              llaman a I2CSim_Step() (_I2C_HW_SYNC en i2c.c), que atiende
+ *              SEN/RSEN/PEN/RCEN/ACKEN y las escrituras en TRN igual que el
+ *              periférico. Un solo hilo y sin temporizadores: cada ejecución
+ *              es reproducible.
+ *
+ *              El tiempo es simulado (ciclos de FCY): solo avanza con el
+ *              tráfico del bus (bits a la velocidad de I2C1BRG, más el clock
+ *              stretching de los esclavos) y con I2CSim_Idle(). Así las
+ *              medidas de caudal son deterministas.
+ *
+ * Maestro externo: I2CSim_ExtWrite/ExtRead hacen de otro maestro del bus
+ *           frente al I2C1 en modo esclavo: comparación con I2CxADD/MSK
+ *           (7 o 10 bits), RBF/D_A/R_W como el periférico y el vector
+ *           _SI2C1Interrupt llamado en cada byte. Si el esclavo retiene SCL
+ *           (lectura sin TRN cargado, o STREN), la espera cuesta la latencia
+ *           de la ISR (I2CSim_SetSlaveLatency) y se acumula aparte. El
+ *           trabajo del software del esclavo (I2CSim_SlaveWork) solo
+ *           cuesta tiempo de bus si ocurre con SCL retenido; si la ISR no
+ *           lo suelta, lo puede soltar el bucle principal
+ *           (I2CSim_SetSlaveMainLoop) antes de darlo por bloqueado.
+ *
+ * Esclavos: I2CSim_Device_t con callbacks por fase (dirección, byte
+ *           escrito, byte leído, STOP). Modelos en i2c_sim_dev.h. Con
+ *           general_call, un general call del maestro llega a todos los
+ *           que lo escuchan a la vez (ACK si alguno responde). El I2C1
+ *           como esclavo responde a ExtWrite(0x00) si GCEN = 1 (GCSTAT
+ *           hasta el STOP).
+ *
+ * Fallos inyectables:
+ * - NACK en la dirección o en los datos (por dispositivo, N veces)
+ * - Clock stretching fijo por byte (por dispositivo)
+ * - SDA bloqueada a 0 en los próximos N START (colisión, BCL)
+ * - Otro maestro en el bus: gana el arbitraje en las próximas N direcciones
+ *   y ocupa el bus un tiempo; un START mientras tanto colisiona (BCL)
+ *
+ ******************************************************************************/
+
+#ifndef I2C_BUS_SIM_H
+#define I2C_BUS_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Reloj de instrucción simulado
+#define I2CSIM_FCY          40000000UL
+#define I2CSIM_US(us)       ((uint64_t)(us) * (I2CSIM_FCY / 1000000UL))
+
+// Maestro externo: 400 kHz
+#define I2CSIM_EXT_BIT_CYCLES   (I2CSIM_FCY / 400000UL)
+// Entrada a la ISR del esclavo hasta SCLREL = 1 (latencia + prólogo + cuerpo)
+#define I2CSIM_SLAVE_LATENCY    60u
+
+// Resultados de I2CSim_ExtWrite/ExtRead (>= 0: bytes de datos con ACK)
+#define I2CSIM_EXT_NACK         (-1)
+#define I2CSIM_EXT_STALL        (-2)    // el esclavo no soltó SCL
+
+typedef struct I2CSim_Device I2CSim_Device_t;
+
+struct I2CSim_Device {
+    const char *name;
+    uint8_t address;            // 7 bits
+    bool general_call;          // también escucha la dirección 0 (difusión)
+
+    // Fase de dirección: true = ACK
+    bool (*select)(I2CSim_Device_t *dev, bool read, uint64_t now);
+    // Byte escrito por el maestro: true = ACK
+    bool (*write)(I2CSim_Device_t *dev, uint8_t data);
+    // Byte pedido por el maestro
+    uint8_t (*read)(I2CSim_Device_t *dev);
+    // Fin de la transacción (STOP, o RESTART si restart = true)
+    void (*stop)(I2CSim_Device_t *dev, bool restart, uint64_t now);
+
+    // Fallos inyectados
+    uint16_t nack_address;      // NACK en las próximas N direcciones
+    uint16_t nack_data;         // NACK en los próximos N bytes escritos
+    uint32_t stretch_cycles;    // SCL retenido por cada byte
+
+    I2CSim_Device_t *next;
+};
+
+typedef struct {
+    uint64_t cycles;            // tiempo simulado total
+    uint32_t starts;            // START + RESTART
+    uint32_t stops;
+    uint32_t bytes_tx;          // bytes escritos por el maestro (incl. dirección)
+    uint32_t bytes_rx;          // bytes leídos por el maestro
+    uint32_t addr_nacks;
+    uint32_t data_nacks;
+    uint32_t collisions;        // BCL en el START
+    uint32_t arb_losses;        // BCL en la dirección (gana el otro maestro)
+    uint64_t stretch_cycles;
+    uint32_t slave_bytes_rx;    // esclavo I2C1: bytes recibidos del maestro externo
+    uint32_t slave_bytes_tx;
+    uint32_t slave_stalls;      // SCL sin liberar por el software
+    uint64_t slave_stretch_cycles;
+} I2CSim_Stats_t;
+
+// Ciclo de vida
+void I2CSim_Init(void);
+void I2CSim_Attach(I2CSim_Device_t *dev);
+void I2CSim_SetMasterVector(void (*vector)(void));  // _MI2C1Interrupt
+void I2CSim_SetSlaveVector(void (*vector)(void));   // _SI2C1Interrupt
+void I2CSim_SetSlaveLatency(uint32_t cycles);
+// Bucle principal del esclavo: se llama si la ISR deja SCL retenido
+void I2CSim_SetSlaveMainLoop(void (*main_loop)(void));
+// El software del esclavo gasta N ciclos: con SCL retenido el bus espera,
+// con SCL libre se solapa con la transferencia
+void I2CSim_SlaveWork(uint32_t cycles);
+
+// Motor del modelo: atiende una operación pendiente del maestro
+void I2CSim_Step(void);
+
+// Maestro externo frente al esclavo I2C1
+int16_t I2CSim_ExtWrite(uint16_t address, bool ten_bit, const uint8_t *data, uint8_t length);
+int16_t I2CSim_ExtRead(uint16_t address, bool ten_bit, const uint8_t *wr, uint8_t wr_len,
+                       uint8_t *buffer, uint8_t length);
+
+// Tiempo
+uint64_t I2CSim_Now(void);
+void I2CSim_Idle(uint32_t us);
+
+// Fallos de bus
+void I2CSim_StuckSda(uint16_t starts);
+void I2CSim_Contend(uint16_t addresses, uint32_t busy_us);
+
+// Estadísticas
+const I2CSim_Stats_t *I2CSim_GetStats(void);
+void I2CSim_ResetStats(void);
+
+#endif /* I2C_BUS_SIM_H */
@@ -0,0 +1,322 @@
+/*******************************************************************************
+ * i2c_isr.h - Vectores I2C1 por fuente con el manejador en línea
+ *
+ * Descripción: El dsPIC33FJ32MC204 tiene dos vectores para I2C1: MI2C1
+ *              (maestro) y SI2C1 (esclavo). Cada macro I2C1_VECTOR_xxx()
+ *              genera la ISR de un vector con el manejador del módulo 1
+ *              escrito en línea: sin switch por módulo ni llamada a
+ *              I2C_ISR_Handler.
+ *
+ * Contexto guardado (40 MIPS, 400 kHz = 100 ciclos por bit):
+ * - I2C1_VECTOR_SLAVE_MAP(): el esclavo sirve un mapa de registros sin
+ *   llamar a ninguna función, así que el compilador solo guarda lo que usa
+ *   y W0..W3/SR van a los registros sombra (push.s/pop.s, 1 ciclo cada uno).
+ * - I2C1_VECTOR_SLAVE_CALLBACK() / I2C1_VECTOR_MASTER(): llaman al callback
+ *   de la aplicación, lo que obliga a guardar W0..W7 y RCOUNT.
+ *
+ *   Vector                 Prólogo+epílogo   Cuerpo (típico)
+ *   SLAVE_MAP  (shadow)     ~2 + registros    ~25 ciclos
+ *   SLAVE_CALLBACK          ~20               10 + callback
+ *   MASTER                  ~20               10 + callback
+ *
+ *   A eso se suman la latencia de entrada del núcleo (4-5 ciclos) y RETFIE
+ *   (3 ciclos). Prólogo y epílogo son estimaciones a partir del código que
+ *   genera XC16; el cuerpo se mide con I2C_ISR_PROFILE (ver abajo).
+ *
+ * Uso (una sola vez, en el archivo con main):
+ *   I2C1_VECTOR_MASTER()
+ *   I2C1_VECTOR_SLAVE_MAP()       // o I2C1_VECTOR_SLAVE_CALLBACK()
+ *
+ * Nota:
+ * - Los registros sombra tienen un solo nivel: solo las ISR de un mismo
+ *   nivel de prioridad pueden usar 'shadow' (aquí, las de I2C1 en
+ *   IRQ_PRIO_I2C). Ninguna otra ISR del proyecto debe usarlo.
+ * - Lectura del maestro: el módulo retiene SCL tras cada byte pedido hasta
+ *   SCLREL = 1, así que el tiempo de bus perdido es lo que tarda la ISR en
+ *   cargar I2C1TRN. Ambas ISR liberan SCL antes de cualquier otra cosa; con
+ *   callback, los bytes preparados con I2C_PutByte evitan esperar a que el
+ *   callback decida (ver _I2C1_SlaveCallbackIsr).
+ * - General call (GCEN): GCSTAT sigue a 1 hasta el STOP, así que cada byte
+ *   sabe si viene de una difusión sin guardar estado. El mapa lo lleva al
+ *   banco 0 con I2C_SLV_EV_GENCALL (también una difusión de un solo byte,
+ *   que solo mueve el puntero); el callback recibe I2C_EVENT_GENERAL_CALL
+ *   en la ISR, lo que conviene para disparos sincronizados.
+ * - Con I2C_ISR_PROFILE definido, Timer2 corre libre a FCY y cada vector
+ *   guarda su peor cuerpo en ciclos (I2C_GetIsrProfile en i2c.h).
+ * - Fuera de XC16 (simulador i2c_sim.c) los vectores son funciones normales
+ *   que llama el modelo del bus.
+ *
+ ******************************************************************************/
+
+#ifndef I2C_ISR_H
+#define I2C_ISR_H
+
+#include "i2c.h"
+#include "irq.h"
+
+// =============================================================================
+// ESTADO COMPARTIDO CON i2c.c
+// =============================================================================
+
+// Fases del esclavo con mapa de registros
+#define I2C_SLV_PHASE_POINTER   0u  // el próximo byte escrito es el puntero
+#define I2C_SLV_PHASE_DATA      1u  // los siguientes son datos
+
+// Banco de registros: un dispositivo emulado dentro del rango de MSK
+typedef struct {
+    uint16_t address;           // dirección que lo selecciona (7 o 10 bits)
+    uint8_t *regs;              // mapa de registros (nunca NULL)
+    uint8_t size;               // bytes del mapa
+    volatile uint8_t ptr;       // puntero de registro propio del banco
+    volatile uint8_t events;    // I2C_SLV_EV_xxx pendientes
+} I2C_SlaveBank_t;
+
+typedef struct {
+    I2C_SlaveBank_t bank[I2C_SLAVE_BANKS];
+    uint8_t nbanks;             // bancos en uso (al menos el 0)
+    bool ten_bit;               // A10M: direcciones de 10 bits
+    I2C_SlaveBank_t *volatile cur;  // banco direccionado
+    volatile uint16_t address;  // última dirección reconocida
+    volatile uint8_t phase;     // I2C_SLV_PHASE_xxx
+} I2C_SlaveMap_t;
+
+// Esclavo con callback: cola de bytes preparados (una ISR lee, I2C_PutByte
+// escribe) y SCL retenido a la espera de I2C_PutByte si la cola se vació
+typedef struct {
+    uint8_t buf[I2C_SLAVE_TX_STAGE];
+    volatile uint8_t head;      // siguiente hueco (I2C_PutByte)
+    volatile uint8_t tail;      // siguiente byte a enviar (ISR)
+    volatile bool hold;         // respaldo: SCL retenido hasta I2C_PutByte
+} I2C_SlaveTx_t;
+
+extern I2C_SlaveMap_t I2C1_SlaveMap;
+extern I2C_SlaveTx_t I2C1_SlaveTx;
+extern I2C_Callback_t I2C1_Callback;
+
+#ifdef I2C_ISR_PROFILE
+extern volatile uint16_t I2C1_IsrWorst[2];  // [0] maestro, [1] esclavo
+#define _I2C_PROF_BEGIN()     uint16_t _i2c_t0 = TMR2
+#define _I2C_PROF_END(i)      do { uint16_t _d = (uint16_t)(TMR2 - _i2c_t0); \
+                                   if (_d > I2C1_IsrWorst[i]) I2C1_IsrWorst[i] = _d; } while (0)
+#else
+#define _I2C_PROF_BEGIN()
+#define _I2C_PROF_END(i)
+#endif
+
+// =============================================================================
+// MANEJADORES EN LÍNEA (módulo 1)
+// =============================================================================
+
+/**
+ * @brief Dirección completa a partir del byte de dirección recibido
+ *
+ * En 10 bits I2CxRCV solo trae el byte bajo: A9..A8 se toman de I2CxADD
+ * (con MSK sobre A9..A8 no se distinguen los bancos por esos bits).
+ */
+static inline uint16_t _I2C1_SlaveAddress(I2C_SlaveMap_t *m, uint8_t addr_byte) {
+    uint16_t a = m->ten_bit ? (uint16_t)((I2C1ADD & 0x0300u) | addr_byte)
+                            : (uint16_t)(addr_byte >> 1);
+    m->address = a;
+    return a;
+}
+
+/**
+ * @brief Banco de la dirección recibida; sin banco propio, el 0
+ */
+static inline I2C_SlaveBank_t *_I2C1_SlaveSelect(I2C_SlaveMap_t *m, uint8_t addr_byte) {
+    uint16_t a = _I2C1_SlaveAddress(m, addr_byte);
+    uint8_t i;
+
+    for (i = 1; i < m->nbanks; i++) {
+        if (m->bank[i].address == a) return &m->bank[i];
+    }
+    return &m->bank[0];
+}
+
+/**
+ * @brief Esclavo con mapa de registros: puntero + datos, lectura secuencial
+ *
+ * El banco se elige en el byte de dirección (hasta I2C_SLAVE_BANKS
+ * comparaciones); los bytes de datos no pagan nada por tener bancos.
+ */
+static inline void _I2C1_SlaveMapIsr(void) {
+    I2C_SlaveMap_t *m = &I2C1_SlaveMap;
+    I2C_SlaveBank_t *b = m->cur;
+    uint16_t stat = I2C1STAT;
+    uint8_t ptr;
+
+    IFS1bits.SI2C1IF = 0;
+
+    if (stat & (1u << 6)) {  // I2COV: byte perdido
+        I2C1STATbits.I2COV = 0;
+        b->events |= I2C_SLV_EV_OVERRUN;
+    }
+
+    if (!(stat & (1u << 2))) {  // R_W = 0: el maestro escribe
+        uint8_t data = (uint8_t)I2C1RCV;
+        if (!(stat & (1u << 5))) {  // D_A = 0: byte de dirección
+            if (stat & (1u << 9)) {  // GCSTAT: general call, al banco 0
+                m->address = I2C_GENERAL_CALL_ADDRESS;
+                m->cur = &m->bank[0];
+            } else {
+                m->cur = _I2C1_SlaveSelect(m, data);
+            }
+            m->phase = I2C_SLV_PHASE_POINTER;
+        } else if (m->phase == I2C_SLV_PHASE_POINTER) {
+            b->ptr = (data < b->size) ? data : 0u;
+            m->phase = I2C_SLV_PHASE_DATA;
+            if (stat & (1u << 9)) b->events |= I2C_SLV_EV_GENCALL;
+        } else {
+            ptr = b->ptr;
+            b->regs[ptr] = data;
+            b->ptr = (uint8_t)((ptr + 1u < b->size) ? ptr + 1u : 0u);
+            b->events |= (stat & (1u << 9)) ? (I2C_SLV_EV_WRITE | I2C_SLV_EV_GENCALL)
+                                            : I2C_SLV_EV_WRITE;
+        }
+        return;
+    }
+
+    // R_W = 1: el maestro lee
+    if (!(stat & (1u << 5))) {
+        uint8_t data = (uint8_t)I2C1RCV;  // byte de dirección: vaciar RBF
+        // En 10 bits es 11110xx1 tras el RESTART: sigue el banco ya elegido
+        if (!m->ten_bit) b = m->cur = _I2C1_SlaveSelect(m, data);
+    } else if (stat & (1u << 15)) {
+        return;  // ACKSTAT = 1: NACK del maestro, fin de la lectura
+    }
+    ptr = b->ptr;
+    I2C1TRN = b->regs[ptr];
+    I2C1CONbits.SCLREL = 1;  // liberar SCL ya: el resto va con el bus en marcha
+    b->ptr = (uint8_t)((ptr + 1u < b->size) ? ptr + 1u : 0u);
+    b->events |= I2C_SLV_EV_READ;
+}
+
+/**
+ * @brief Carga en I2C1TRN el siguiente byte preparado y libera SCL
+ * @return false si no había ninguno
+ */
+static inline bool _I2C1_SlaveTxPop(void) {
+    I2C_SlaveTx_t *t = &I2C1_SlaveTx;
+    uint8_t tail = t->tail;
+
+    if (tail == t->head) return false;
+    I2C1TRN = t->buf[tail];
+    t->tail = (uint8_t)((tail + 1u) & (I2C_SLAVE_TX_STAGE - 1u));
+    I2C1CONbits.SCLREL = 1;
+    return true;
+}
+
+/**
+ * @brief Descarta lo preparado: el maestro dejó de leer o cambia de registro
+ */
+static inline void _I2C1_SlaveTxFlush(void) {
+    I2C1_SlaveTx.tail = I2C1_SlaveTx.head;
+    I2C1_SlaveTx.hold = false;
+}
+
+/**
+ * @brief Esclavo con callback de la aplicación
+ *
+ * Lectura del maestro: si hay un byte preparado (I2C_PutByte) se envía y
+ * se libera SCL antes de llamar al callback, que solo tiene que preparar
+ * el siguiente mientras el bus sigue a su velocidad. Si no lo hay, el
+ * callback lo da en la misma llamada (SCL retenido mientras tanto) o, en
+ * último caso, SCL queda retenido hasta que I2C_PutByte lo entregue.
+ */
+static inline void _I2C1_SlaveCallbackIsr(void) {
+    uint16_t stat = I2C1STAT;
+    I2C_Callback_t cb = I2C1_Callback;
+    bool loaded;
+
+    IFS1bits.SI2C1IF = 0;
+
+    if (stat & ((1u << 6) | (1u << 7))) {  // I2COV / IWCOL
+        I2C1STAT &= (uint16_t)~((1u << 6) | (1u << 7));
+        if (cb) cb(I2C_EVENT_ERROR, 0);
+    }
+
+    if (!(stat & (1u << 2))) {  // Escritura del maestro
+        uint8_t data = (uint8_t)I2C1RCV;
+        if (!(stat & (1u << 5))) {
+            uint16_t a;
+            if (stat & (1u << 9)) {  // GCSTAT: los datos que siguen son difusión
+                I2C1_SlaveMap.address = I2C_GENERAL_CALL_ADDRESS;
+                if (cb) cb(I2C_EVENT_GENERAL_CALL, 0);
+                return;
+            }
+            a = _I2C1_SlaveAddress(&I2C1_SlaveMap, data);
+            _I2C1_SlaveTxFlush();  // llega un puntero nuevo: lo preparado no vale
+            if (cb) cb(I2C_EVENT_ADDR_RECEIVED, (uint8_t)a);
+            return;
+        }
+        if (cb) cb(I2C_EVENT_DATA_RECEIVED, data);
+        return;
+    }
+
+    // Lectura del maestro
+    if (!(stat & (1u << 5))) {
+        (void)I2C1RCV;
+    } else if (stat & (1u << 15)) {
+        _I2C1_SlaveTxFlush();  // NACK del maestro: fin de la lectura
+        return;
+    }
+    loaded = _I2C1_SlaveTxPop();
+    if (cb) cb(I2C_EVENT_DATA_REQUESTED, 0);
+    if (!loaded && !_I2C1_SlaveTxPop()) I2C1_SlaveTx.hold = true;
+}
+
+/**
+ * @brief Maestro: notifica fin de START/STOP/byte al callback
+ */
+static inline void _I2C1_MasterIsr(void) {
+    uint16_t stat = I2C1STAT;
+    I2C_Callback_t cb = I2C1_Callback;
+
+    IFS1bits.MI2C1IF = 0;
+    if (cb == NULL) return;
+
+    if (stat & (1u << 10)) {            // BCL
+        cb(I2C_EVENT_ERROR, 0);
+    } else if (stat & (1u << 1)) {      // RBF: byte recibido
+        cb(I2C_EVENT_DATA_RECEIVED, (uint8_t)I2C1RCV);
+    } else if (stat & (1u << 4)) {      // P
+        cb(I2C_EVENT_STOP, 0);
+    } else if (stat & (1u << 3)) {      // S
+        cb(I2C_EVENT_START, 0);
+    }
+}
+
+// =============================================================================
+// GENERADORES DE VECTORES
+// =============================================================================
+
+#ifdef __XC16__
+#define _I2C_ISR_FULL       __attribute__((interrupt, no_auto_psv))
+#define _I2C_ISR_SHADOW     __attribute__((interrupt, shadow, no_auto_psv))
+#else
+#define _I2C_ISR_FULL
+#define _I2C_ISR_SHADOW
+#endif
+
+#define I2C1_VECTOR_SLAVE_MAP() \
+    void _I2C_ISR_SHADOW _SI2C1Interrupt(void) { \
+        _I2C_PROF_BEGIN(); \
+        _I2C1_SlaveMapIsr(); \
+        _I2C_PROF_END(1); \
+    }
+
+#define I2C1_VECTOR_SLAVE_CALLBACK() \
+    void _I2C_ISR_FULL _SI2C1Interrupt(void) { \
+        _I2C_PROF_BEGIN(); \
+        _I2C1_SlaveCallbackIsr(); \
+        _I2C_PROF_END(1); \
+    }
+
+#define I2C1_VECTOR_MASTER() \
+    void _I2C_ISR_FULL _MI2C1Interrupt(void) { \
+        _I2C_PROF_BEGIN(); \
+        _I2C1_MasterIsr(); \
+        _I2C_PROF_END(0); \
+    }
+
+#endif /* I2C_ISR_H */
@@ -0,0 +1,767 @@
+/*******************************************************************************
+ * i2c_sim.c - Regresión y caudal del driver I2C contra el bus simulado
+ *
+ * Descripción: Ejecuta el driver (i2c.c) en el PC sobre el modelo del bus
+ *              (i2c_bus_sim.c) con los dispositivos de i2cmain.c: 24LC256
+ *              en 0x50, LM75 en 0x48 y un mapa de registros en 0x68.
+ *              No forma parte del firmware.
+ *
+ *              Regresión: escaneo, EEPROM (página, vuelta de página, ACK
+ *              polling), LM75, registros, y fallos inyectados (NACK en
+ *              dirección y datos, clock stretching, SDA bloqueada).
+ *              Multi-maestro: arbitraje perdido, reintentos y contadores.
+ *              General call: difusión a dos mapas de registros y el I2C1
+ *              esclavo con GCEN.
+ *              Esclavo con callback: bytes preparados con I2C_PutByte,
+ *              dados en el callback o por el bucle principal.
+ *
+ *              Lotes de tempsensor.c con tres LM75 (0x48..0x4A).
+ *              SMBus/PMBus con PEC (smbus.c) contra una fuente en 0x5A.
+ *              I2C1 como esclavo (I2C1_VECTOR_SLAVE_MAP) frente a un maestro
+ *              externo: máscara de dirección, bancos de registros, 10 bits.
+ *
+ *              Caudal: bytes útiles por segundo de tiempo de bus simulado a
+ *              100 y 400 kHz para los patrones de acceso típicos, y del
+ *              esclavo según cuándo prepara los bytes de lectura.
+ *
+ * Uso (desde I2C/):
+ *   gcc -O2 -fno-strict-aliasing -DI2C_SIM -Isim -I. -I../CONFIG -o i2c_sim i2c_sim.c \
+ *       i2c_bus_sim.c i2c_sim_dev.c i2c.c tempsensor.c smbus.c \
+ *       ../CONFIG/irq.c ../CONFIG/board.c ../CONFIG/pins.c ../CONFIG/pps.c && ./i2c_sim
+ *
+ *  Devuelve 0 si todas las comprobaciones pasan.
+ *
+ ******************************************************************************/
+
+#include "i2c.h"
+#include "i2c_bus_sim.h"
+#include "i2c_sim_dev.h"
+#include "tempsensor.h"
+#include "smbus.h"
+#include "i2c_isr.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ADDR_EEPROM     0x50
+#define ADDR_LM75       0x48
+#define ADDR_REGMAP     0x68
+#define ADDR_ABSENT     0x20
+#define ADDR_PMBUS      0x5A
+#define ADDR_STAGE      0x3C    // I2C1 esclavo con callback
+
+static I2CSim_Eeprom_t eeprom;
+static I2CSim_Lm75_t lm75;
+static I2CSim_RegMap_t regmap;
+static I2CSim_RegMap_t regmap_b;                // segundo oyente del general call
+static I2CSim_Lm75_t lm75_b, lm75_c;           // lote de tempsensor.c
+static TSENS_Sensor_t sensors[3] = {
+    { .address = ADDR_LM75,     .type = TSENS_LM75 },
+    { .address = ADDR_LM75 + 1, .type = TSENS_LM75 },
+    { .address = ADDR_LM75 + 2, .type = TSENS_LM75 },
+};
+static I2CSim_Pmbus_t psu;
+static const SMBUS_Device_t psu_dev = { I2C_MODULE_1, ADDR_PMBUS, true };
+static int failures = 0;
+
+// Vector del esclavo que llama el modelo del bus
+I2C1_VECTOR_SLAVE_MAP()
+
+static void check(bool ok, const char *what) {
+    printf("  %-48s %s\n", what, ok ? "OK" : "FALLO");
+    if (!ok) failures++;
+}
+
+static void master_init(I2C_Speed_t speed) {
+    I2C_Config_t cfg = I2C_CONFIG_DEFAULT_MASTER;
+    cfg.speed = speed;
+    cfg.timeout_ms = 10;
+    I2C_Init(&cfg);
+}
+
+// =============================================================================
+// REGRESIÓN
+// =============================================================================
+
+static void test_scan(void) {
+    uint8_t found[8];
+    bool ok;
+
+    memset(found, 0, sizeof(found));
+    ok = I2C_ScanBus(I2C_MODULE_1, found, 8);
+    check(ok && found[0] == ADDR_LM75 && found[1] == ADDR_EEPROM &&
+          found[2] == ADDR_REGMAP && found[3] == 0, "escaneo: 0x48, 0x50, 0x68");
+}
+
+/* ACK polling: reintenta la dirección hasta que la EEPROM termina */
+static uint16_t eeprom_wait_ready(void) {
+    uint16_t polls = 0;
+    while (!I2C_CheckDevice(I2C_MODULE_1, ADDR_EEPROM) && polls < 1000) polls++;
+    return polls;
+}
+
+static bool eeprom_read(uint16_t addr, uint8_t *buf, uint8_t len) {
+    uint8_t a[2] = { (uint8_t)(addr >> 8), (uint8_t)addr };
+    return I2C_WriteData(I2C_MODULE_1, ADDR_EEPROM, a, 2) &&
+           I2C_ReadData(I2C_MODULE_1, ADDR_EEPROM, buf, len);
+}
+
+static void test_eeprom(void) {
+    uint8_t wr[2 + 16], rd[16];
+    uint16_t polls;
+    uint8_t i;
+
+    wr[0] = 0x01;
+    wr[1] = 0x00;  // 0x0100
+    for (i = 0; i < 16; i++) wr[2 + i] = (uint8_t)(0xA0 + i);
+    check(I2C_WriteData(I2C_MODULE_1, ADDR_EEPROM, wr, sizeof(wr)), "EEPROM: escritura de página");
+
+    check(!I2C_CheckDevice(I2C_MODULE_1, ADDR_EEPROM), "EEPROM: NACK durante el ciclo");
+    polls = eeprom_wait_ready();
+    check(polls > 0 && polls < 1000, "EEPROM: ACK polling termina");
+
+    check(eeprom_read(0x0100, rd, 16) && memcmp(rd, &wr[2], 16) == 0, "EEPROM: lectura aleatoria");
+
+    // 8 bytes desde 0x013C: 4 al final de la página y 4 al principio
+    wr[0] = 0x01;
+    wr[1] = 0x3C;
+    for (i = 0; i < 8; i++) wr[2 + i] = (uint8_t)(0x10 + i);
+    I2C_WriteData(I2C_MODULE_1, ADDR_EEPROM, wr, 10);
+    eeprom_wait_ready();
+    check(eeprom.mem[0x013F] == 0x13 && eeprom.mem[0x0100] == 0x14 &&
+          eeprom.mem[0x0140] == 0xFF, "EEPROM: vuelta dentro de la página");
+}
+
+static void test_lm75(void) {
+    uint8_t b[2];
+    int16_t raw;
+
+    lm75.temp_mc = 25125;
+    check(I2C_ReadData(I2C_MODULE_1, ADDR_LM75, b, 2), "LM75: lectura");
+    raw = (int16_t)((b[0] << 8) | b[1]) >> 5;
+    check(raw * 125 == 25125, "LM75: 25.125 C");
+
+    lm75.temp_mc = -10500;
+    I2C_ReadData(I2C_MODULE_1, ADDR_LM75, b, 2);
+    raw = (int16_t)((b[0] << 8) | b[1]) >> 5;
+    check(raw * 125 == -10500, "LM75: -10.5 C");
+
+    // Cambiar el puntero a TOS: se conserva para la lectura siguiente
+    b[0] = I2CSIM_LM75_REG_TOS;
+    I2C_WriteData(I2C_MODULE_1, ADDR_LM75, b, 1);
+    I2C_ReadData(I2C_MODULE_1, ADDR_LM75, b, 2);
+    check(b[0] == 0x50 && b[1] == 0x00, "LM75: puntero persistente (TOS = 80 C)");
+    b[0] = I2CSIM_LM75_REG_TEMP;
+    I2C_WriteData(I2C_MODULE_1, ADDR_LM75, b, 1);
+}
+
+static void test_regmap(void) {
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x10, 0x5A) && regmap.regs[0x10] == 0x5A,
+          "registros: escritura");
+    regmap.regs[0x20] = 0xC3;
+    check(I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, 0x20) == 0xC3, "registros: lectura");
+}
+
+static void test_tsens(void) {
+    uint32_t ptr_writes;
+    uint16_t tos;
+
+    I2CSim_Lm75Init(&lm75_b, ADDR_LM75 + 1);
+    I2CSim_Lm75Init(&lm75_c, ADDR_LM75 + 2);
+    I2CSim_Attach(&lm75_b.dev);
+    I2CSim_Attach(&lm75_c.dev);
+    lm75.temp_mc = 25125;
+    lm75_b.temp_mc = -10500;
+    lm75_c.temp_mc = 85000;
+
+    TSENS_Init(I2C_MODULE_1, sensors, 3);
+    check(TSENS_PollAll() == 3 && sensors[0].temp == TSENS_Q8(25.125) &&
+          sensors[1].temp == TSENS_Q8(-10.5) && sensors[2].temp == TSENS_Q8(85),
+          "sensores: lote, Q8.8");
+    check(TSENS_TO_CENTI(sensors[0].temp) == 2512, "sensores: Q8.8 a centésimas");
+
+    ptr_writes = lm75.pointer_writes + lm75_b.pointer_writes + lm75_c.pointer_writes;
+    TSENS_PollAll();
+    check(lm75.pointer_writes + lm75_b.pointer_writes + lm75_c.pointer_writes == ptr_writes,
+          "sensores: sin reescribir el puntero");
+
+    check(TSENS_ReadRegister(&sensors[1], I2CSIM_LM75_REG_TOS, &tos) && tos == 0x5000,
+          "sensores: registro TOS");
+    TSENS_PollAll();
+    check(lm75_b.ptr == I2CSIM_LM75_REG_TEMP && sensors[1].temp == TSENS_Q8(-10.5),
+          "sensores: puntero restaurado tras TOS");
+
+    lm75_b.dev.nack_address = 1;
+    check(TSENS_PollAll() == 2 && !sensors[1].valid && sensors[2].valid,
+          "sensores: uno ausente, el lote sigue");
+    check(TSENS_PollAll() == 3, "sensores: recuperación");
+}
+
+static void test_smbus(void) {
+    static const uint8_t check_str[9] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    static const uint8_t model[7] = { 'P', 'S', 'U', '-', '4', '8', 'V' };
+    uint8_t blk[SMBUS_BLOCK_MAX], len = 0, b = 0;
+    uint16_t w = 0;
+
+    check(SMBUS_Pec(0, check_str, 9) == 0xF4, "SMBus: CRC-8 de referencia");
+
+    I2CSim_PmbusInit(&psu, ADDR_PMBUS, true);
+    psu.size[PMBUS_OPERATION] = 1;
+    psu.size[PMBUS_MFR_MODEL] = I2CSIM_PMBUS_BLOCK;
+    I2CSim_Attach(&psu.dev);
+
+    check(SMBUS_WriteWord(&psu_dev, 0x21, 0x1234) == SMBUS_OK && psu.word[0x21] == 0x1234 &&
+          psu.pec_errors == 0, "SMBus: write word con PEC");
+    psu.word[PMBUS_READ_VOUT] = 0xBEEF;
+    check(SMBUS_ReadWord(&psu_dev, PMBUS_READ_VOUT, &w) == SMBUS_OK && w == 0xBEEF,
+          "SMBus: read word con PEC");
+    check(SMBUS_WriteByte(&psu_dev, PMBUS_OPERATION, 0x80) == SMBUS_OK &&
+          SMBUS_ReadByte(&psu_dev, PMBUS_OPERATION, &b) == SMBUS_OK && b == 0x80,
+          "SMBus: write/read byte");
+    check(SMBUS_BlockWrite(&psu_dev, PMBUS_MFR_MODEL, model, 7) == SMBUS_OK &&
+          SMBUS_BlockRead(&psu_dev, PMBUS_MFR_MODEL, blk, &len, sizeof(blk)) == SMBUS_OK &&
+          len == 7 && memcmp(blk, model, 7) == 0, "SMBus: block write/read");
+    check(SMBUS_BlockRead(&psu_dev, PMBUS_MFR_MODEL, blk, &len, 4) == SMBUS_ERR_LENGTH,
+          "SMBus: bloque mayor que el buffer");
+    check(SMBUS_ProcessCall(&psu_dev, I2CSIM_PMBUS_PCALL, 0x00FF, &w) == SMBUS_OK && w == 0xFF00,
+          "SMBus: process call");
+    check(SMBUS_SendByte(&psu_dev, PMBUS_CLEAR_FAULTS) == SMBUS_OK && psu.pec_errors == 0,
+          "SMBus: send byte");
+
+    w = 0;
+    psu.corrupt_next_read = true;
+    check(SMBUS_ReadWord(&psu_dev, PMBUS_READ_VOUT, &w) == SMBUS_ERR_PEC && w == 0,
+          "SMBus: PEC erróneo detectado");
+    check(SMBUS_ReadWord(&psu_dev, 0x21, &w) == SMBUS_OK && w == 0x1234, "SMBus: recuperación");
+
+    check(PMBUS_Linear11ToMilli(0xF032) == 12500 && PMBUS_Linear11ToMilli(0x07FF) == -1000,
+          "PMBus: LINEAR11");
+    check(PMBUS_Linear11ToMilli(0x5BFF) == 2095104000L && PMBUS_Linear11ToMilli(0x5C00) == -2097152000L,
+          "PMBus: LINEAR11 exp +11 sin saturar");
+    check(PMBUS_Linear11ToMilli(0x7BFF) == INT32_MAX && PMBUS_Linear11ToMilli(0x7C00) == INT32_MIN,
+          "PMBus: LINEAR11 exp +15 satura");
+}
+
+static void slave_init(I2C_Mode_t mode, uint16_t address, uint16_t mask) {
+    I2C_Config_t cfg = I2C_CONFIG_DEFAULT_SLAVE;
+    cfg.mode = mode;
+    cfg.speed = I2C_SPEED_400KHZ;
+    cfg.slave_address = address;
+    cfg.slave_mask = mask;
+    I2C_Init(&cfg);
+}
+
+static void test_slave_banks(void) {
+    static uint8_t bank_a[16], bank_b[8], bank_c[8];
+    static const uint8_t wr_b[3] = { 0x02, 0xAA, 0xBB };
+    static const uint8_t wr_c[2] = { 0x05, 0x5C };
+    static const uint8_t wr_a[2] = { 0x01, 0x11 };
+    static const uint8_t upd[2] = { 0x12, 0x34 };
+    uint8_t ptr = 0x02, rd[2] = { 0, 0 };
+
+    I2CSim_SetSlaveVector(_SI2C1Interrupt);
+
+    // 0x30..0x33: 0x31 y 0x33 con mapa propio, el resto al banco 0
+    slave_init(I2C_MODE_SLAVE_7BIT, 0x30, 0x03);
+    I2C_SlaveAttachMap(I2C_MODULE_1, bank_a, sizeof(bank_a));
+    I2C_SlaveAttachBank(I2C_MODULE_1, 1, 0x31, bank_b, sizeof(bank_b));
+    I2C_SlaveAttachBank(I2C_MODULE_1, 2, 0x33, bank_c, sizeof(bank_c));
+
+    check(I2CSim_ExtWrite(0x31, false, wr_b, 3) == 3 && bank_b[2] == 0xAA && bank_b[3] == 0xBB &&
+          I2C_GetReceivedAddress(I2C_MODULE_1) == 0x31, "esclavo: escritura al banco 0x31");
+    check(I2CSim_ExtWrite(0x33, false, wr_c, 2) == 2 && bank_c[5] == 0x5C && bank_b[5] == 0,
+          "esclavo: escritura al banco 0x33");
+    check(I2CSim_ExtRead(0x31, false, &ptr, 1, rd, 2) == 2 && rd[0] == 0xAA && rd[1] == 0xBB,
+          "esclavo: lectura del banco 0x31");
+    check(I2CSim_ExtWrite(0x32, false, wr_a, 2) == 2 && bank_a[1] == 0x11 &&
+          I2C_GetReceivedAddress(I2C_MODULE_1) == 0x32, "esclavo: 0x32 sin banco va al 0");
+    check(I2CSim_ExtWrite(0x34, false, wr_a, 2) == I2CSIM_EXT_NACK, "esclavo: 0x34 fuera de la máscara");
+    check((I2C_SlaveTakeBankEvents(I2C_MODULE_1, 1) & (I2C_SLV_EV_WRITE | I2C_SLV_EV_READ)) ==
+          (I2C_SLV_EV_WRITE | I2C_SLV_EV_READ) && I2C_SlaveTakeBankEvents(I2C_MODULE_1, 1) == 0,
+          "esclavo: eventos por banco");
+
+    // Puntero propio por banco: leer 0x33 sin fase de escritura sigue en 6
+    bank_c[6] = 0x66;
+    check(I2CSim_ExtRead(0x33, false, NULL, 0, rd, 1) == 1 && rd[0] == 0x66,
+          "esclavo: puntero independiente por banco");
+
+    // Actualización desde el firmware: nunca con una transacción abierta
+    I2C1STATbits.S = 1;
+    check(!I2C_SlaveBankUpdate(I2C_MODULE_1, 1, 4, upd, 2) && bank_b[4] == 0,
+          "esclavo: actualización aplazada con el bus ocupado");
+    I2C1STATbits.S = 0;
+    ptr = 0x04;
+    check(I2C_SlaveBankUpdate(I2C_MODULE_1, 1, 4, upd, 2) &&
+          I2CSim_ExtRead(0x31, false, &ptr, 1, rd, 2) == 2 && rd[0] == 0x12 && rd[1] == 0x34,
+          "esclavo: actualización con el bus libre");
+    check(!I2C_SlaveBankUpdate(I2C_MODULE_1, 1, 7, upd, 2), "esclavo: actualización fuera del banco");
+    ptr = 0x02;
+
+    // 10 bits: 0x2A4..0x2A7, bancos en 0x2A4 y 0x2A6
+    memset(bank_a, 0, sizeof(bank_a));
+    memset(bank_b, 0, sizeof(bank_b));
+    slave_init(I2C_MODE_SLAVE_10BIT, 0x2A4, 0x003);
+    I2C_SlaveAttachMap(I2C_MODULE_1, bank_a, sizeof(bank_a));
+    I2C_SlaveAttachBank(I2C_MODULE_1, 1, 0x2A6, bank_b, sizeof(bank_b));
+    check(I2CSim_ExtWrite(0x2A6, true, wr_b, 3) == 3 && bank_b[2] == 0xAA &&
+          I2C_GetReceivedAddress(I2C_MODULE_1) == 0x2A6, "esclavo 10 bits: escritura al banco");
+    rd[0] = rd[1] = 0;
+    check(I2CSim_ExtRead(0x2A6, true, &ptr, 1, rd, 2) == 2 && rd[0] == 0xAA && rd[1] == 0xBB,
+          "esclavo 10 bits: lectura con RESTART");
+    check(I2CSim_ExtWrite(0x1A6, true, wr_b, 3) == I2CSIM_EXT_NACK &&
+          I2CSim_ExtWrite(0x26, false, wr_b, 3) == I2CSIM_EXT_NACK, "esclavo 10 bits: otras direcciones");
+}
+
+static void test_faults(void) {
+    uint8_t data[3] = { 0x00, 0x11, 0x22 };
+    uint8_t b;
+    uint64_t t0, t1;
+    I2C_ArbStats_t arb;
+    bool ok;
+
+    regmap.dev.nack_address = 1;
+    check(!I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x00, 0x01) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_ADDR_NACK, "fallo: NACK en dirección");
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x00, 0x01), "fallo: recuperación tras NACK");
+
+    regmap.dev.nack_data = 1;
+    check(!I2C_WriteData(I2C_MODULE_1, ADDR_REGMAP, data, 3) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_DATA_NACK, "fallo: NACK en datos");
+
+    check(!I2C_ReadData(I2C_MODULE_1, ADDR_ABSENT, &b, 1) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_ADDR_NACK, "fallo: dispositivo ausente");
+
+    // Clock stretching: mismo resultado, más tiempo de bus
+    regmap.regs[0x30] = 0x77;
+    t0 = I2CSim_Now();
+    I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, 0x30);
+    t1 = I2CSim_Now();
+    regmap.dev.stretch_cycles = 2000;  // 50 us por byte
+    b = I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, 0x30);
+    regmap.dev.stretch_cycles = 0;
+    check(b == 0x77 && (I2CSim_Now() - t1) >= (t1 - t0) + 4u * 2000u, "fallo: clock stretching");
+
+    // SDA bloqueada: el START colisiona; un START se salva con un reintento,
+    // más que I2C_ARB_RETRIES falla sin colgarse
+    I2C_ResetArbStats(I2C_MODULE_1);
+    I2CSim_StuckSda(1);
+    ok = I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x00, 0x02);
+    I2C_GetArbStats(I2C_MODULE_1, &arb);
+    check(ok && arb.collisions == 1 && arb.retries == 1, "fallo: SDA bloqueada en un START");
+    I2CSim_StuckSda(I2C_ARB_RETRIES + 1u);
+    check(!I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x00, 0x02) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_BUS_COLLISION, "fallo: SDA bloqueada");
+    I2C_ClearErrors(I2C_MODULE_1);
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x00, 0x02), "fallo: recuperación tras colisión");
+}
+
+/**
+ * @brief Otro maestro en el bus: arbitraje perdido, backoff y contadores
+ */
+static void test_arbitration(void) {
+    I2C_ArbStats_t arb;
+    uint64_t t0, t_a, t_b;
+    uint8_t b;
+    bool ok;
+
+    // Pierde la dirección una vez; el otro maestro acaba enseguida
+    I2C_ResetArbStats(I2C_MODULE_1);
+    I2CSim_Contend(1, 0);
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x10, 0x5A) && regmap.regs[0x10] == 0x5A,
+          "arbitraje: escritura repetida tras perder");
+    I2C_GetArbStats(I2C_MODULE_1, &arb);
+    check(arb.arb_lost == 1 && arb.retries == 1 && arb.failures == 0, "arbitraje: contadores");
+
+    // Lectura: la dirección de lectura también se arbitra
+    I2CSim_Contend(1, 0);
+    regmap.regs[0x11] = 0xA5;
+    b = I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, 0x11);
+    check(b == 0xA5, "arbitraje: lectura repetida tras perder");
+
+    // El otro maestro retiene el bus 300 us: los START colisionan hasta que
+    // la ventana del backoff (50, 100, 200... us) lo supera
+    I2C_ResetArbStats(I2C_MODULE_1);
+    I2CSim_Contend(1, 300);
+    t0 = I2CSim_Now();
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x12, 0x3C) && regmap.regs[0x12] == 0x3C,
+          "arbitraje: espera al otro maestro");
+    I2C_GetArbStats(I2C_MODULE_1, &arb);
+    check(arb.arb_lost == 1 && arb.collisions >= 1 && arb.retries == 1u + arb.collisions &&
+          I2CSim_Now() - t0 >= I2CSIM_US(300), "arbitraje: colisiones mientras está ocupado");
+
+    // Siempre gana el otro: se abandona tras I2C_ARB_RETRIES y queda la causa
+    I2C_ResetArbStats(I2C_MODULE_1);
+    I2CSim_Contend(I2C_ARB_RETRIES + 1u, 0);
+    t0 = I2CSim_Now();
+    check(!I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x13, 0x01) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_ARB_LOST, "arbitraje: abandono tras reintentos");
+    I2C_GetArbStats(I2C_MODULE_1, &arb);
+    check(arb.arb_lost == I2C_ARB_RETRIES + 1u && arb.failures == 1 &&
+          I2CSim_Now() - t0 < I2CSIM_US(I2C_ARB_RETRIES * I2C_ARB_BACKOFF_MAX_US),
+          "arbitraje: espera acotada");
+    check(I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x13, 0x01), "arbitraje: recuperación");
+
+    // Un NACK no se repite
+    I2C_ResetArbStats(I2C_MODULE_1);
+    ok = I2C_ReadData(I2C_MODULE_1, ADDR_ABSENT, &b, 1);
+    I2C_GetArbStats(I2C_MODULE_1, &arb);
+    check(!ok && arb.retries == 0, "arbitraje: NACK sin reintento");
+
+    // Semillas distintas, esperas distintas
+    I2C_SetBackoffSeed(I2C_MODULE_1, 0x1234);
+    I2CSim_Contend(1, 0);
+    t0 = I2CSim_Now();
+    I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x14, 0x00);
+    t_a = I2CSim_Now() - t0;
+    I2C_SetBackoffSeed(I2C_MODULE_1, 0xBEEF);
+    I2CSim_Contend(1, 0);
+    t0 = I2CSim_Now();
+    I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x14, 0x00);
+    t_b = I2CSim_Now() - t0;
+    check(t_a != t_b, "arbitraje: backoff según la semilla");
+}
+
+/**
+ * @brief General call del maestro: una escritura a todos los que escuchan
+ */
+static void test_general_call(void) {
+    static uint8_t cmd[3] = { 0x40, 0xAB, 0xCD };
+    const I2CSim_Stats_t *st = I2CSim_GetStats();
+    uint32_t starts;
+
+    I2CSim_RegMapInit(&regmap_b, ADDR_REGMAP + 1);
+    I2CSim_Attach(&regmap_b.dev);
+
+    check(!I2C_BroadcastWrite(I2C_MODULE_1, cmd, 3) &&
+          I2C_GetLastError(I2C_MODULE_1) == I2C_STATE_ADDR_NACK, "general call: nadie escucha");
+
+    regmap.dev.general_call = true;
+    regmap_b.dev.general_call = true;
+    starts = st->starts;
+    check(I2C_BroadcastWrite(I2C_MODULE_1, cmd, 3) && st->starts == starts + 1u &&
+          regmap.regs[0x40] == 0xAB && regmap.regs[0x41] == 0xCD &&
+          regmap_b.regs[0x40] == 0xAB && regmap_b.regs[0x41] == 0xCD,
+          "general call: una transacción a todos");
+
+    regmap_b.dev.general_call = false;
+    cmd[1] = 0x11;
+    check(I2C_BroadcastWrite(I2C_MODULE_1, cmd, 2) && regmap.regs[0x40] == 0x11 &&
+          regmap_b.regs[0x40] == 0xAB, "general call: solo los que escuchan");
+    regmap.dev.general_call = false;
+    check(I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, 0x40) == 0x11, "general call: dirección propia intacta");
+}
+
+/**
+ * @brief General call hacia el I2C1 esclavo (GCEN)
+ */
+static void test_slave_general_call(void) {
+    static uint8_t bank_a[16], bank_b[8];
+    static const uint8_t trig[2] = { 0x03, 0x01 };
+    static const uint8_t wr[2] = { 0x04, 0x22 };
+
+    // 0x30..0x33 con banco en 0x31: la difusión va al banco 0
+    slave_init(I2C_MODE_SLAVE_7BIT, 0x30, 0x03);  // general_call_enable por defecto
+    I2C_SlaveAttachMap(I2C_MODULE_1, bank_a, sizeof(bank_a));
+    I2C_SlaveAttachBank(I2C_MODULE_1, 1, 0x31, bank_b, sizeof(bank_b));
+
+    check(I2CSim_ExtWrite(0x00, false, trig, 2) == 2 && bank_a[3] == 0x01 && bank_b[3] == 0 &&
+          I2C_GetReceivedAddress(I2C_MODULE_1) == I2C_GENERAL_CALL_ADDRESS,
+          "esclavo: general call al banco 0");
+    check(I2C_SlaveTakeBankEvents(I2C_MODULE_1, 0) == (I2C_SLV_EV_WRITE | I2C_SLV_EV_GENCALL) &&
+          I2C_SlaveTakeBankEvents(I2C_MODULE_1, 1) == 0, "esclavo: evento de general call");
+    check(I2CSim_ExtWrite(0x30, false, wr, 2) == 2 &&
+          I2C_SlaveTakeBankEvents(I2C_MODULE_1, 0) == I2C_SLV_EV_WRITE, "esclavo: GCSTAT se borra con el STOP");
+    check(I2CSim_ExtWrite(0x00, false, trig, 1) == 1 &&
+          I2C_SlaveTakeBankEvents(I2C_MODULE_1, 0) == I2C_SLV_EV_GENCALL, "esclavo: disparo de un byte");
+
+    I2C_EnableGeneralCall(I2C_MODULE_1, false);
+    check(I2CSim_ExtWrite(0x00, false, trig, 2) == I2CSIM_EXT_NACK, "esclavo: sin GCEN no responde");
+
+    // En 10 bits el general call sigue siendo la dirección 0 de 7 bits
+    bank_a[3] = 0;
+    slave_init(I2C_MODE_SLAVE_10BIT, 0x2A4, 0x000);
+    I2C_SlaveAttachMap(I2C_MODULE_1, bank_a, sizeof(bank_a));
+    check(I2CSim_ExtWrite(0x00, false, trig, 2) == 2 && bank_a[3] == 0x01, "esclavo 10 bits: general call");
+}
+
+// Esclavo con callback y 16 registros: el modo decide cuándo se prepara
+// cada byte que leerá el maestro
+#define STAGE_WORK_CYCLES   400u    // el callback tarda 10 us en decidir
+#define STAGE_MAIN_CYCLES   4000u   // el bucle principal responde en 100 us
+
+typedef enum {
+    STAGE_AHEAD,            // uno preparado de antemano (I2C_PutByte)
+    STAGE_ON_REQUEST,       // el callback lo da cuando se pide
+    STAGE_MAIN_LOOP         // lo da el bucle principal (SCL retenido)
+} StageMode_t;
+
+static const char *const stage_names[] = {
+    "preparado de antemano", "en el callback", "bucle principal",
+};
+static uint8_t stage_regs[16];
+static uint8_t stage_ptr;
+static bool stage_pointer;
+static StageMode_t stage_mode;
+
+static void stage_next(void) {
+    I2C_PutByte(I2C_MODULE_1, stage_regs[stage_ptr]);
+    stage_ptr = (uint8_t)((stage_ptr + 1u) & 0x0Fu);
+}
+
+static void stage_callback(I2C_Event_t event, uint8_t data) {
+    switch (event) {
+        case I2C_EVENT_ADDR_RECEIVED:
+            stage_pointer = true;
+            break;
+        case I2C_EVENT_DATA_RECEIVED:
+            if (stage_pointer) {
+                stage_pointer = false;
+                stage_ptr = data & 0x0Fu;
+                if (stage_mode == STAGE_AHEAD) stage_next();  // antes de que lo pida
+            } else {
+                stage_regs[stage_ptr] = data;
+                stage_ptr = (uint8_t)((stage_ptr + 1u) & 0x0Fu);
+            }
+            break;
+        case I2C_EVENT_DATA_REQUESTED:
+            I2CSim_SlaveWork(STAGE_WORK_CYCLES);
+            if (stage_mode != STAGE_MAIN_LOOP) stage_next();
+            break;
+        default:
+            break;
+    }
+}
+
+static void stage_main_loop(void) {
+    I2CSim_SlaveWork(STAGE_MAIN_CYCLES);
+    stage_next();
+}
+
+static void slave_callback_vector(void) {
+    _I2C1_SlaveCallbackIsr();
+}
+
+static void stage_init(void) {
+    uint8_t i;
+
+    for (i = 0; i < sizeof(stage_regs); i++) stage_regs[i] = (uint8_t)(0xA0u + i);
+    slave_init(I2C_MODE_SLAVE_7BIT, ADDR_STAGE, 0x0000);
+    I2C_SetCallback(I2C_MODULE_1, stage_callback);
+    I2CSim_SetSlaveVector(slave_callback_vector);
+    I2CSim_SetSlaveMainLoop(stage_main_loop);
+}
+
+/**
+ * @brief Lectura de 8 registros desde el 4; devuelve los ciclos de SCL retenido
+ */
+static uint64_t stage_read(StageMode_t mode, uint8_t *rd, int16_t *n) {
+    uint8_t ptr = 4;
+    uint64_t s0 = I2CSim_GetStats()->slave_stretch_cycles;
+
+    stage_mode = mode;
+    *n = I2CSim_ExtRead(ADDR_STAGE, false, &ptr, 1, rd, 8);
+    return I2CSim_GetStats()->slave_stretch_cycles - s0;
+}
+
+/**
+ * @brief Esclavo con callback: bytes preparados frente a SCL retenido
+ */
+static void test_slave_stage(void) {
+    static const uint8_t wr[3] = { 0x02, 0x55, 0x66 };
+    uint8_t rd[8];
+    uint32_t stalls;
+    uint64_t st;
+    int16_t n;
+    uint8_t i;
+
+    stage_init();
+    stalls = I2CSim_GetStats()->slave_stalls;
+
+    // 8 retenciones: dirección de lectura y 7 bytes con ACK
+    st = stage_read(STAGE_AHEAD, rd, &n);
+    check(n == 8 && memcmp(rd, &stage_regs[4], 8) == 0, "esclavo preparado: datos");
+    check(st == 8u * I2CSIM_SLAVE_LATENCY, "esclavo preparado: solo la latencia de la ISR");
+    check(I2C_SlaveTxStaged(I2C_MODULE_1) == 0, "esclavo preparado: sobrante descartado al NACK");
+
+    memset(rd, 0, sizeof(rd));
+    st = stage_read(STAGE_ON_REQUEST, rd, &n);
+    check(n == 8 && memcmp(rd, &stage_regs[4], 8) == 0 &&
+          st == 8u * (I2CSIM_SLAVE_LATENCY + STAGE_WORK_CYCLES), "esclavo: dato en el callback");
+
+    memset(rd, 0, sizeof(rd));
+    st = stage_read(STAGE_MAIN_LOOP, rd, &n);
+    check(n == 8 && memcmp(rd, &stage_regs[4], 8) == 0 &&
+          st == 8u * (I2CSIM_SLAVE_LATENCY + STAGE_WORK_CYCLES + STAGE_MAIN_CYCLES) &&
+          I2CSim_GetStats()->slave_stalls == stalls, "esclavo: respaldo con SCL retenido");
+
+    check(I2CSim_ExtWrite(ADDR_STAGE, false, wr, 3) == 3 && stage_regs[2] == 0x55 &&
+          stage_regs[3] == 0x66, "esclavo con callback: escritura");
+
+    // Preparados sin puntero: la cola guarda STAGE - 1 y el maestro los lee
+    stage_mode = STAGE_AHEAD;
+    stage_ptr = 0;
+    for (i = 0; i < I2C_SLAVE_TX_STAGE + 2u; i++) stage_next();
+    check(I2C_SlaveTxStaged(I2C_MODULE_1) == I2C_SLAVE_TX_STAGE - 1u, "esclavo: cola llena");
+    check(I2CSim_ExtRead(ADDR_STAGE, false, NULL, 0, rd, 2) == 2 && rd[0] == stage_regs[0] &&
+          rd[1] == stage_regs[1] && I2C_SlaveTxStaged(I2C_MODULE_1) == 0, "esclavo: lectura sin puntero");
+}
+
+// =============================================================================
+// CAUDAL
+// =============================================================================
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(void);      // devuelve bytes útiles
+} Bench_t;
+
+static uint32_t bench_eeprom_seq(void) {
+    uint8_t buf[128];
+    eeprom_read(0x0000, buf, sizeof(buf));
+    return sizeof(buf);
+}
+
+static uint32_t bench_regmap_single(void) {
+    uint8_t i;
+    for (i = 0; i < 32; i++) (void)I2C_ReadRegister(I2C_MODULE_1, ADDR_REGMAP, i);
+    return 32;
+}
+
+static uint32_t bench_regmap_block(void) {
+    uint8_t buf[32];
+    uint8_t p = 0;
+    I2C_WriteData(I2C_MODULE_1, ADDR_REGMAP, &p, 1);
+    I2C_ReadData(I2C_MODULE_1, ADDR_REGMAP, buf, sizeof(buf));
+    return sizeof(buf);
+}
+
+static uint32_t bench_lm75_pointer(void) {
+    uint8_t b[2], p = I2CSIM_LM75_REG_TEMP, i;
+    for (i = 0; i < 8; i++) {
+        I2C_WriteData(I2C_MODULE_1, ADDR_LM75, &p, 1);
+        I2C_ReadData(I2C_MODULE_1, ADDR_LM75, b, 2);
+    }
+    return 16;
+}
+
+static uint32_t bench_lm75_direct(void) {
+    uint8_t b[2], i;
+    for (i = 0; i < 8; i++) I2C_ReadData(I2C_MODULE_1, ADDR_LM75, b, 2);
+    return 16;
+}
+
+static uint32_t bench_tsens_batch(void) {
+    uint8_t i;
+    for (i = 0; i < 8; i++) TSENS_PollAll();
+    return 8 * 3 * 2;
+}
+
+static uint32_t bench_smbus_word(void) {
+    uint16_t w;
+    uint8_t i;
+    for (i = 0; i < 16; i++) SMBUS_ReadWord(&psu_dev, PMBUS_READ_VOUT, &w);
+    return 16 * 2;
+}
+
+// Mismo dato (2 bytes) a los dos mapas de registros: uno a uno o difundido
+static uint32_t bench_unicast_pair(void) {
+    uint8_t i;
+    for (i = 0; i < 8; i++) {
+        I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP, 0x50, i);
+        I2C_WriteRegister(I2C_MODULE_1, ADDR_REGMAP + 1, 0x50, i);
+    }
+    return 8 * 2;
+}
+
+static uint32_t bench_broadcast_pair(void) {
+    uint8_t i, cmd[2] = { 0x50, 0 };
+    regmap.dev.general_call = regmap_b.dev.general_call = true;
+    for (i = 0; i < 8; i++) {
+        cmd[1] = i;
+        I2C_BroadcastWrite(I2C_MODULE_1, cmd, 2);
+    }
+    regmap.dev.general_call = regmap_b.dev.general_call = false;
+    return 8 * 2;
+}
+
+static const Bench_t benches[] = {
+    { "EEPROM 128 B secuenciales",         bench_eeprom_seq },
+    { "registros: 32 x I2C_ReadRegister",  bench_regmap_single },
+    { "registros: bloque de 32",           bench_regmap_block },
+    { "LM75: 8 lecturas con puntero",      bench_lm75_pointer },
+    { "LM75: 8 lecturas sin puntero",      bench_lm75_direct },
+    { "tempsensor: 8 lotes de 3",          bench_tsens_batch },
+    { "PMBus: 16 x ReadWord con PEC",      bench_smbus_word },
+    { "2 esclavos: 8 escrituras a cada",  bench_unicast_pair },
+    { "2 esclavos: 8 general call",        bench_broadcast_pair },
+};
+
+static void run_benches(I2C_Speed_t speed) {
+    uint8_t i;
+
+    master_init(speed);
+    printf("\n%lu kHz                               bytes   bus (us)   B/s\n",
+           (unsigned long)speed / 1000u);
+    for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        uint64_t t0 = I2CSim_Now();
+        uint32_t n = benches[i].run();
+        double us = (double)(I2CSim_Now() - t0) / (I2CSIM_FCY / 1000000.0);
+        printf("  %-34s %5lu  %9.0f  %6.0f\n", benches[i].name,
+               (unsigned long)n, us, n / (us / 1e6));
+    }
+}
+
+/**
+ * @brief I2C1 esclavo con callback: 8 lecturas de 8 registros por modo
+ */
+static void run_slave_benches(void) {
+    uint8_t rd[8], i, m;
+    int16_t n;
+
+    stage_init();
+    printf("\nesclavo, 400 kHz                      bytes   bus (us)   B/s   SCL retenido (us)\n");
+    for (m = STAGE_AHEAD; m <= STAGE_MAIN_LOOP; m++) {
+        uint64_t t0 = I2CSim_Now(), st = 0;
+        double us;
+        for (i = 0; i < 8; i++) st += stage_read((StageMode_t)m, rd, &n);
+        us = (double)(I2CSim_Now() - t0) / (I2CSIM_FCY / 1000000.0);
+        printf("  %-34s %5u  %9.0f  %6.0f  %8.0f\n", stage_names[m], 64u, us, 64 / (us / 1e6),
+               (double)st / (I2CSIM_FCY / 1000000.0));
+    }
+    I2CSim_SetSlaveMainLoop(NULL);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    I2CSim_Init();
+    I2CSim_EepromInit(&eeprom, ADDR_EEPROM);
+    I2CSim_Lm75Init(&lm75, ADDR_LM75);
+    I2CSim_RegMapInit(&regmap, ADDR_REGMAP);
+    I2CSim_Attach(&eeprom.dev);
+    I2CSim_Attach(&lm75.dev);
+    I2CSim_Attach(&regmap.dev);
+
+    printf("Regresión (100 kHz)\n");
+    master_init(I2C_SPEED_100KHZ);
+    test_scan();
+    test_eeprom();
+    test_lm75();
+    test_regmap();
+    test_faults();
+    test_arbitration();
+    test_general_call();
+    test_tsens();
+    test_smbus();
+    test_slave_banks();
+    test_slave_general_call();
+    test_slave_stage();
+
+    run_benches(I2C_SPEED_100KHZ);
+    run_benches(I2C_SPEED_400KHZ);
+    run_slave_benches();
+
+    printf("\n%s (%d fallos)\n", failures ? "FALLO" : "OK", failures);
+    return failures ? 1 : 0;
+}
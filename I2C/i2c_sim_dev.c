@@ -0,0 +1,310 @@
+/*******************************************************************************
+ * i2c_sim_dev.c - Modelos de esclavos para el bus simulado (ver i2c_sim_dev.h)
+ *
+ ******************************************************************************/
+
+#include "i2c_sim_dev.h"
+#include <string.h>
+
+// =============================================================================
+// 24LC256
+// =============================================================================
+
+static bool _Eeprom_Select(I2CSim_Device_t *dev, bool read, uint64_t now) {
+    I2CSim_Eeprom_t *e = (I2CSim_Eeprom_t *)dev;
+
+    if (now < e->busy_until) return false;  // ciclo de escritura: NACK
+    if (!read) {
+        e->phase = 0;
+        e->page_dirty = 0;
+    }
+    return true;
+}
+
+static bool _Eeprom_Write(I2CSim_Device_t *dev, uint8_t data) {
+    I2CSim_Eeprom_t *e = (I2CSim_Eeprom_t *)dev;
+    uint16_t off;
+
+    switch (e->phase) {
+        case 0:
+            e->ptr = (uint16_t)((data << 8) & 0x7F00u);
+            e->phase = 1;
+            break;
+        case 1:
+            e->ptr |= data;
+            e->phase = 2;
+            // El buffer de página arranca con el contenido actual
+            memcpy(e->page, &e->mem[e->ptr & ~(I2CSIM_EEPROM_PAGE - 1u)], I2CSIM_EEPROM_PAGE);
+            break;
+        default:
+            off = (uint16_t)(e->ptr & (I2CSIM_EEPROM_PAGE - 1u));
+            e->page[off] = data;
+            e->page_dirty |= (uint64_t)1 << off;
+            // El contador de página da la vuelta sin cambiar de página
+            e->ptr = (uint16_t)((e->ptr & ~(I2CSIM_EEPROM_PAGE - 1u)) |
+                                ((off + 1u) & (I2CSIM_EEPROM_PAGE - 1u)));
+            break;
+    }
+    return true;
+}
+
+static uint8_t _Eeprom_Read(I2CSim_Device_t *dev) {
+    I2CSim_Eeprom_t *e = (I2CSim_Eeprom_t *)dev;
+    uint8_t data = e->mem[e->ptr];
+
+    e->ptr = (uint16_t)((e->ptr + 1u) & (I2CSIM_EEPROM_SIZE - 1u));
+    return data;
+}
+
+static void _Eeprom_Stop(I2CSim_Device_t *dev, bool restart, uint64_t now) {
+    I2CSim_Eeprom_t *e = (I2CSim_Eeprom_t *)dev;
+
+    // Solo un STOP tras escribir datos lanza el ciclo de escritura
+    if (!restart && e->page_dirty != 0) {
+        memcpy(&e->mem[e->ptr & ~(I2CSIM_EEPROM_PAGE - 1u)], e->page, I2CSIM_EEPROM_PAGE);
+        e->busy_until = now + I2CSIM_US(I2CSIM_EEPROM_WRITE_US);
+        e->write_cycles++;
+    }
+    e->page_dirty = 0;
+}
+
+void I2CSim_EepromInit(I2CSim_Eeprom_t *e, uint8_t address) {
+    memset(e, 0, sizeof(*e));
+    memset(e->mem, 0xFF, sizeof(e->mem));  // borrada
+    e->dev.name = "24LC256";
+    e->dev.address = address;
+    e->dev.select = _Eeprom_Select;
+    e->dev.write = _Eeprom_Write;
+    e->dev.read = _Eeprom_Read;
+    e->dev.stop = _Eeprom_Stop;
+}
+
+// =============================================================================
+// LM75
+// =============================================================================
+
+static uint16_t _Lm75_TempReg(int32_t mc) {
+    // 11 bits en complemento a 2, alineados a la izquierda (0.125 °C/LSB)
+    int32_t raw = (mc >= 0) ? mc / 125 : -((-mc + 124) / 125);
+    if (raw > 1023) raw = 1023;
+    if (raw < -1024) raw = -1024;
+    return (uint16_t)((uint16_t)raw << 5);
+}
+
+static uint16_t _Lm75_Reg16(I2CSim_Lm75_t *t) {
+    switch (t->ptr) {
+        case I2CSIM_LM75_REG_TEMP:  return _Lm75_TempReg(t->temp_mc);
+        case I2CSIM_LM75_REG_THYST: return t->thyst;
+        case I2CSIM_LM75_REG_TOS:   return t->tos;
+        default:                    return (uint16_t)(t->conf << 8);
+    }
+}
+
+static bool _Lm75_Select(I2CSim_Device_t *dev, bool read, uint64_t now) {
+    I2CSim_Lm75_t *t = (I2CSim_Lm75_t *)dev;
+
+    (void)read;
+    (void)now;
+    t->index = 0;
+    t->first_write = true;
+    return true;
+}
+
+static bool _Lm75_Write(I2CSim_Device_t *dev, uint8_t data) {
+    I2CSim_Lm75_t *t = (I2CSim_Lm75_t *)dev;
+    uint16_t *reg;
+
+    if (t->first_write) {
+        t->ptr = (uint8_t)(data & 0x03u);
+        t->first_write = false;
+        t->pointer_writes++;
+        return true;
+    }
+
+    switch (t->ptr) {
+        case I2CSIM_LM75_REG_CONF:
+            t->conf = data;
+            return true;
+        case I2CSIM_LM75_REG_THYST:
+        case I2CSIM_LM75_REG_TOS:
+            reg = (t->ptr == I2CSIM_LM75_REG_TOS) ? &t->tos : &t->thyst;
+            if (t->index == 0) *reg = (uint16_t)((*reg & 0x00FFu) | (data << 8));
+            else *reg = (uint16_t)((*reg & 0xFF00u) | (data & 0x80u));  // 9 bits
+            t->index ^= 1u;
+            return true;
+        default:
+            return true;  // temperatura: solo lectura, se ignora
+    }
+}
+
+static uint8_t _Lm75_Read(I2CSim_Device_t *dev) {
+    I2CSim_Lm75_t *t = (I2CSim_Lm75_t *)dev;
+    uint16_t reg = _Lm75_Reg16(t);
+    uint8_t data;
+
+    if (t->ptr == I2CSIM_LM75_REG_CONF) return t->conf;
+    data = (t->index == 0) ? (uint8_t)(reg >> 8) : (uint8_t)reg;
+    t->index ^= 1u;  // lecturas extra repiten el registro
+    return data;
+}
+
+void I2CSim_Lm75Init(I2CSim_Lm75_t *t, uint8_t address) {
+    memset(t, 0, sizeof(*t));
+    t->dev.name = "LM75";
+    t->dev.address = address;
+    t->dev.select = _Lm75_Select;
+    t->dev.write = _Lm75_Write;
+    t->dev.read = _Lm75_Read;
+    t->thyst = 0x4B00;  // 75 °C
+    t->tos = 0x5000;    // 80 °C
+}
+
+// =============================================================================
+// MAPA DE REGISTROS
+// =============================================================================
+
+static bool _RegMap_Select(I2CSim_Device_t *dev, bool read, uint64_t now) {
+    I2CSim_RegMap_t *r = (I2CSim_RegMap_t *)dev;
+
+    (void)read;
+    (void)now;
+    r->first_write = true;
+    return true;
+}
+
+static bool _RegMap_Write(I2CSim_Device_t *dev, uint8_t data) {
+    I2CSim_RegMap_t *r = (I2CSim_RegMap_t *)dev;
+
+    if (r->first_write) {
+        r->ptr = data;
+        r->first_write = false;
+    } else {
+        r->regs[r->ptr++] = data;
+    }
+    return true;
+}
+
+static uint8_t _RegMap_Read(I2CSim_Device_t *dev) {
+    I2CSim_RegMap_t *r = (I2CSim_RegMap_t *)dev;
+    return r->regs[r->ptr++];
+}
+
+void I2CSim_RegMapInit(I2CSim_RegMap_t *r, uint8_t address) {
+    memset(r, 0, sizeof(*r));
+    r->dev.name = "REGMAP";
+    r->dev.address = address;
+    r->dev.select = _RegMap_Select;
+    r->dev.write = _RegMap_Write;
+    r->dev.read = _RegMap_Read;
+}
+
+// =============================================================================
+// FUENTE PMBUS
+// =============================================================================
+
+static uint8_t _Pmbus_Crc(uint8_t crc, uint8_t data) {
+    uint8_t i;
+    crc ^= data;
+    for (i = 0; i < 8; i++) crc = (uint8_t)((crc & 0x80u) ? (crc << 1) ^ 0x07 : crc << 1);
+    return crc;
+}
+
+static void _Pmbus_Out(I2CSim_Pmbus_t *p, uint8_t data) {
+    if (p->out_len < I2CSIM_PMBUS_BUF) p->out[p->out_len++] = data;
+}
+
+static bool _Pmbus_Select(I2CSim_Device_t *dev, bool read, uint64_t now) {
+    I2CSim_Pmbus_t *p = (I2CSim_Pmbus_t *)dev;
+    uint8_t crc, cmd, i;
+    uint16_t w;
+
+    (void)now;
+    p->reading = read;
+    if (!read) {
+        p->in_len = 0;
+        return true;
+    }
+    if (p->in_len == 0) return false;  // lectura sin comando
+
+    cmd = p->in[0];
+    crc = _Pmbus_Crc(0, (uint8_t)(dev->address << 1));
+    for (i = 0; i < p->in_len; i++) crc = _Pmbus_Crc(crc, p->in[i]);
+    crc = _Pmbus_Crc(crc, (uint8_t)((dev->address << 1) | 1u));
+
+    p->out_len = 0;
+    p->out_pos = 0;
+    if (cmd == I2CSIM_PMBUS_PCALL && p->in_len >= 3) {
+        w = (uint16_t)~(p->in[1] | (p->in[2] << 8));
+        _Pmbus_Out(p, (uint8_t)w);
+        _Pmbus_Out(p, (uint8_t)(w >> 8));
+    } else if (p->size[cmd] == I2CSIM_PMBUS_BLOCK) {
+        _Pmbus_Out(p, p->block_len);
+        for (i = 0; i < p->block_len; i++) _Pmbus_Out(p, p->block[i]);
+    } else {
+        _Pmbus_Out(p, (uint8_t)p->word[cmd]);
+        if (p->size[cmd] == 2) _Pmbus_Out(p, (uint8_t)(p->word[cmd] >> 8));
+    }
+    for (i = 0; i < p->out_len; i++) crc = _Pmbus_Crc(crc, p->out[i]);
+    if (p->pec) _Pmbus_Out(p, crc);
+
+    if (p->corrupt_next_read) {
+        p->out[0] ^= 0x01u;
+        p->corrupt_next_read = false;
+    }
+    return true;
+}
+
+static bool _Pmbus_Write(I2CSim_Device_t *dev, uint8_t data) {
+    I2CSim_Pmbus_t *p = (I2CSim_Pmbus_t *)dev;
+
+    if (p->in_len >= I2CSIM_PMBUS_BUF) return false;
+    p->in[p->in_len++] = data;
+    return true;
+}
+
+static uint8_t _Pmbus_Read(I2CSim_Device_t *dev) {
+    I2CSim_Pmbus_t *p = (I2CSim_Pmbus_t *)dev;
+    return (p->out_pos < p->out_len) ? p->out[p->out_pos++] : 0xFF;
+}
+
+static void _Pmbus_Stop(I2CSim_Device_t *dev, bool restart, uint64_t now) {
+    I2CSim_Pmbus_t *p = (I2CSim_Pmbus_t *)dev;
+    uint8_t crc, n, cmd, i;
+
+    (void)now;
+    if (restart || p->reading || p->in_len == 0) return;
+
+    n = p->in_len;
+    if (p->pec) {
+        crc = _Pmbus_Crc(0, (uint8_t)(dev->address << 1));
+        for (i = 0; i < n; i++) crc = _Pmbus_Crc(crc, p->in[i]);
+        if (crc != 0) {  // el PEC recibido cierra el CRC a 0
+            p->pec_errors++;
+            return;
+        }
+        n--;
+    }
+
+    cmd = p->in[0];
+    if (p->size[cmd] == I2CSIM_PMBUS_BLOCK && n >= 2) {
+        p->block_len = (uint8_t)((p->in[1] <= sizeof(p->block)) ? p->in[1] : sizeof(p->block));
+        memcpy(p->block, &p->in[2], p->block_len);
+    } else if (n == 2) {
+        p->word[cmd] = p->in[1];
+    } else if (n == 3) {
+        p->word[cmd] = (uint16_t)(p->in[1] | (p->in[2] << 8));
+    }
+    p->writes++;  // n == 1: send byte
+}
+
+void I2CSim_PmbusInit(I2CSim_Pmbus_t *p, uint8_t address, bool pec) {
+    memset(p, 0, sizeof(*p));
+    memset(p->size, 2, sizeof(p->size));  // por defecto, palabras
+    p->dev.name = "PMBUS";
+    p->dev.address = address;
+    p->dev.select = _Pmbus_Select;
+    p->dev.write = _Pmbus_Write;
+    p->dev.read = _Pmbus_Read;
+    p->dev.stop = _Pmbus_Stop;
+    p->pec = pec;
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+ * i2c_sim_dev.h - Modelos de esclavos para el bus simulado (i2c_bus_sim.h)
+ *
+ * Descripción: Dispositivos de i2cmain.c para probar el driver en el PC:
+ * - 24LC256: EEPROM de 32 KB, dirección de 16 bits, página de 64 bytes
+ *   (la escritura da la vuelta dentro de la página) y ciclo de escritura
+ *   de 5 ms tras el STOP, durante el que no reconoce su dirección.
+ * - LM75: puntero de registro que se conserva entre transacciones,
+ *   temperatura de 11 bits (0.125 °C/LSB), CONF, THYST y TOS.
+ * - Mapa de registros genérico: 256 bytes con puntero autoincremental.
+ * - Fuente PMBus: comandos de byte, palabra y bloque, process call y PEC
+ *   comprobado con un CRC bit a bit (independiente de la tabla de smbus.c).
+ *
+ * Uso:
+ *   static I2CSim_Lm75_t lm75;
+ *   I2CSim_Lm75Init(&lm75, 0x48);
+ *   I2CSim_Attach(&lm75.dev);
+ *   lm75.temp_mc = 25125;   // 25.125 °C
+ *
+ ******************************************************************************/
+
+#ifndef I2C_SIM_DEV_H
+#define I2C_SIM_DEV_H
+
+#include "i2c_bus_sim.h"
+
+// =============================================================================
+// 24LC256
+// =============================================================================
+
+#define I2CSIM_EEPROM_SIZE          32768u
+#define I2CSIM_EEPROM_PAGE          64u
+#define I2CSIM_EEPROM_WRITE_US      5000u
+
+typedef struct {
+    I2CSim_Device_t dev;            // primero: el bus trabaja con &dev
+    uint8_t mem[I2CSIM_EEPROM_SIZE];
+    uint8_t page[I2CSIM_EEPROM_PAGE];
+    uint64_t page_dirty;            // bit i: page[i] escrito
+    uint16_t ptr;
+    uint8_t phase;                  // 0/1: dirección alta/baja, 2: datos
+    uint64_t busy_until;            // fin del ciclo de escritura
+    uint32_t write_cycles;
+} I2CSim_Eeprom_t;
+
+void I2CSim_EepromInit(I2CSim_Eeprom_t *e, uint8_t address);
+
+// =============================================================================
+// LM75
+// =============================================================================
+
+#define I2CSIM_LM75_REG_TEMP    0u
+#define I2CSIM_LM75_REG_CONF    1u
+#define I2CSIM_LM75_REG_THYST   2u
+#define I2CSIM_LM75_REG_TOS     3u
+
+typedef struct {
+    I2CSim_Device_t dev;
+    int32_t temp_mc;                // temperatura en milésimas de °C
+    uint8_t conf;
+    uint16_t thyst;                 // registros de 16 bits tal como se leen
+    uint16_t tos;
+    uint8_t ptr;                    // puntero de registro (persistente)
+    uint8_t index;                  // byte dentro del registro
+    bool first_write;               // el primer byte escrito es el puntero
+    uint32_t pointer_writes;        // escrituras del puntero (coste evitable)
+} I2CSim_Lm75_t;
+
+void I2CSim_Lm75Init(I2CSim_Lm75_t *t, uint8_t address);
+
+// =============================================================================
+// MAPA DE REGISTROS
+// =============================================================================
+
+typedef struct {
+    I2CSim_Device_t dev;
+    uint8_t regs[256];
+    uint8_t ptr;
+    bool first_write;
+} I2CSim_RegMap_t;
+
+void I2CSim_RegMapInit(I2CSim_RegMap_t *r, uint8_t address);
+
+// =============================================================================
+// FUENTE PMBUS
+// =============================================================================
+
+#define I2CSIM_PMBUS_BLOCK      0xFFu   // size[]: comando de bloque
+#define I2CSIM_PMBUS_PCALL      0xD0u   // process call: responde ~dato
+#define I2CSIM_PMBUS_BUF        40u
+
+typedef struct {
+    I2CSim_Device_t dev;
+    bool pec;                       // exige PEC en escrituras y lo añade
+    uint8_t size[256];              // bytes de datos por comando: 1, 2 o bloque
+    uint16_t word[256];
+    uint8_t block[32];              // contenido común de los comandos de bloque
+    uint8_t block_len;
+    uint8_t in[I2CSIM_PMBUS_BUF];   // bytes escritos en la transacción
+    uint8_t in_len;
+    uint8_t out[I2CSIM_PMBUS_BUF];  // respuesta preparada al direccionar en lectura
+    uint8_t out_len, out_pos;
+    bool reading;
+    bool corrupt_next_read;         // invierte un bit del próximo dato leído
+    uint32_t writes;                // escrituras aceptadas
+    uint32_t pec_errors;            // escrituras descartadas por PEC
+} I2CSim_Pmbus_t;
+
+void I2CSim_PmbusInit(I2CSim_Pmbus_t *p, uint8_t address, bool pec);
+
+#endif /* I2C_SIM_DEV_H */
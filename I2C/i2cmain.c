@@ -7,6 +7,11 @@
  ******************************************************************************/
 
 #include "i2c.h"
+#include "i2c_isr.h"
+#include "tempsensor.h"
+#include "boot.h"       // BOOT_Defer: escaneo fuera del camino de arranque
+#include "board.h"
+#include "adc.h"        // ruido del ADC: semilla del backoff por placa
 #include <stdio.h>
 #include <string.h>
 
@@ -14,6 +19,24 @@
 // EJEMPLO 1: CONFIGURACIÓN BÁSICA
 // =============================================================================
 
+// Semilla del backoff distinta en cada placa: el dsPIC33F no tiene número de
+// serie, así que se acumula el bit menos significativo de 32 conversiones de
+// AN0 (ruido térmico y de referencia, distinto en cada placa y arranque).
+// Con un número de serie grabado en producción, usarlo en su lugar.
+static uint16_t semilla_por_placa(void) {
+    uint16_t semilla = 0;
+    uint16_t valor;
+    uint8_t i;
+
+    BOARD_PinsInit(BOARD_GROUP_POT);
+    ADC_Init();
+    for (i = 0; i < 32; i++) {
+        if (ADC_ReadSingleBlocking(0, &valor) != ADC_OK) continue;
+        semilla = (uint16_t)((semilla << 1) | (semilla >> 15)) ^ valor;
+    }
+    return semilla;
+}
+
 void ejemplo_configuracion_basica(void) {
     printf("=== Ejemplo 1: Configuración Básica ===\n");
     
@@ -25,6 +48,9 @@ void ejemplo_configuracion_basica(void) {
     // Inicializar I2C
     I2C_Init(&config);
     
+    // Multi-maestro: sin semilla propia, dos placas iguales chocan siempre
+    I2C_SetBackoffSeed(I2C_MODULE_1, semilla_por_placa());
+    
     // Imprimir configuración
     I2C_PrintConfig(I2C_MODULE_1);
     
@@ -110,24 +136,32 @@ void ejemplo_eeprom_24lc256(void) {
 // =============================================================================
 
 #define LM75_ADDRESS 0x48  // Dirección por defecto del LM75
-#define LM75_REG_TEMP 0x00 // Registro de temperatura
+
+// Sensores de la placa: se leen todos en una sola transacción
+static TSENS_Sensor_t sensores[] = {
+    { .address = LM75_ADDRESS, .type = TSENS_LM75 },
+    { .address = 0x49,         .type = TSENS_TMP102 },
+};
 
 void ejemplo_sensor_lm75(void) {
     printf("\n=== Ejemplo 4: Sensor LM75 ===\n");
     
-    // Leer temperatura del LM75
-    uint8_t buffer_temp[2];
+    TSENS_Init(I2C_MODULE_1, sensores, sizeof(sensores) / sizeof(sensores[0]));
     
-    if (I2C_ReadData(I2C_MODULE_1, LM75_ADDRESS, buffer_temp, 2)) {
-        // Convertir a temperatura (LM75: 11-bit, 0.125°C/LSB)
-        int16_t raw_temp = (buffer_temp[0] << 8) | buffer_temp[1];
-        raw_temp >>= 5;  // Desplazar bits de relleno
-        
-        float temperatura = (float)raw_temp * 0.125;
-        
-        printf("Temperatura LM75: %.2f°C\n", temperatura);
-    } else {
-        printf("Error al leer sensor LM75\n");
+    // El primer lote escribe el puntero; los siguientes ya no
+    TSENS_PollAll();
+    
+    for (uint8_t i = 0; i < sizeof(sensores) / sizeof(sensores[0]); i++) {
+        if (sensores[i].valid) {
+            // Q8.8 a centésimas sin float
+            int16_t c = TSENS_TO_CENTI(sensores[i].temp);
+            int16_t ent = c / 100;
+            int16_t dec = (c < 0) ? -(c % 100) : (c % 100);
+            printf("Sensor 0x%02X: %s%d.%02d°C\n", sensores[i].address,
+                   (c < 0 && ent == 0) ? "-" : "", ent, dec);
+        } else {
+            printf("Error al leer sensor 0x%02X\n", sensores[i].address);
+        }
     }
 }
 
@@ -146,17 +180,27 @@ void esclavo_callback(I2C_Event_t evento, uint8_t dato) {
             index = 0;
             break;
             
+        case I2C_EVENT_GENERAL_CALL:
+            // Difusión: todas las placas lo ven en el mismo byte del bus
+            printf("Esclavo: general call\n");
+            index = 0;
+            break;
+            
         case I2C_EVENT_DATA_RECEIVED:
             printf("Esclavo: Dato recibido: 0x%02X\n", dato);
             if (index < 32) {
                 buffer[index++] = dato;
             }
+            // Primer byte = comando: dejar preparada la respuesta por si el
+            // maestro lee a continuación
+            if (index == 1) I2C_PutByte(I2C_MODULE_1, (uint8_t)~dato);
             break;
             
         case I2C_EVENT_DATA_REQUESTED:
-            printf("Esclavo: Solicitado dato\n");
-            // Enviar respuesta
-            I2C_PutByte(I2C_MODULE_2, 0xAA);
+            // Preparar el byte siguiente: el actual ya salió si se preparó
+            // antes (I2C_PutByte al recibir el dato), sin retener SCL. Aquí
+            // nada de printf: SCL puede estar retenido mientras tanto.
+            I2C_PutByte(I2C_MODULE_1, 0xAA);
             break;
             
         case I2C_EVENT_STOP:
@@ -174,7 +218,7 @@ void ejemplo_modo_esclavo(void) {
     
     // Configurar como esclavo
     I2C_Config_t config = I2C_CONFIG_DEFAULT_SLAVE;
-    config.module = I2C_MODULE_2;  // Usar módulo 2 como esclavo
+    config.module = I2C_MODULE_1;  // Único módulo I2C del dispositivo
     config.slave_address = 0x40;   // Dirección del esclavo
     config.callback = esclavo_callback;
     
@@ -217,6 +261,13 @@ void ejemplo_avanzado(void) {
         }
         printf("\n");
     }
+    
+    // 3. Disparo sincronizado: un general call a todas las placas en lugar
+    //    de una escritura a cada una (registro 0x10 = arrancar muestreo)
+    uint8_t disparo[] = {0x10, 0x01};
+    if (I2C_BroadcastWrite(I2C_MODULE_1, disparo, sizeof(disparo))) {
+        printf("Muestreo disparado por general call\n");
+    }
 }
 
 // =============================================================================
@@ -224,6 +275,8 @@ void ejemplo_avanzado(void) {
 // =============================================================================
 
 int main(void) {
+    BOOT_Start();
+
     // Inicializar sistema
     // ... (configuración de clock, etc.)
     
@@ -231,11 +284,14 @@ int main(void) {
     
     // Ejecutar ejemplos
     ejemplo_configuracion_basica();
+    BOOT_Mark("i2c");
     
     // Esperar un momento
     __delay_ms(1000);
     
-    ejemplo_escanear_bus();
+    // El escaneo (126 direcciones, cada una con su timeout) no hace falta para
+    // arrancar: se difiere al bucle principal y solo tras power-on
+    BOOT_Defer(ejemplo_escanear_bus, "scan", BOOT_DEFER_COLD_ONLY);
     
     // Solo ejecutar si hay dispositivos conectados
     ejemplo_eeprom_24lc256();
@@ -249,7 +305,8 @@ int main(void) {
     printf("\n========== FIN DE DEMO ==========\n");
     
     while(1) {
-        // Mantener programa activo
+        // Tareas diferidas del arranque (escaneo del bus)
+        BOOT_RunDeferred();
     }
     
     return 0;
@@ -259,12 +316,8 @@ int main(void) {
 // INTERRUPCIONES (si se usan)
 // =============================================================================
 
-// Interrupción I2C1
-void __attribute__((interrupt, no_auto_psv)) _I2C1Interrupt(void) {
-    I2C_ISR_Handler(I2C_MODULE_1);
-}
-
-// Interrupción I2C2
-void __attribute__((interrupt, no_auto_psv)) _I2C2Interrupt(void) {
-    I2C_ISR_Handler(I2C_MODULE_2);
-}
\ No newline at end of file
+// Vectores MI2C1/SI2C1 con el manejador en línea (i2c_isr.h).
+// Un esclavo que solo sirve registros usaría I2C1_VECTOR_SLAVE_MAP()
+// junto con I2C_SlaveAttachMap().
+I2C1_VECTOR_MASTER()
+I2C1_VECTOR_SLAVE_CALLBACK()
\ No newline at end of file
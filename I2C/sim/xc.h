@@ -0,0 +1,106 @@
+/*******************************************************************************
+ * sim/xc.h - Registros I2C1 simulados para compilar el driver en el PC
+ *
+ * Descripción: Sustituye al xc.h de XC16 cuando i2c.c se compila con
+ *              -II2C/sim (ver i2c_sim.c). Los registros de I2C1 están en el
+ *              mismo orden que en el dispositivo (RCV, TRN, BRG, CON, STAT,
+ *              ADD, MSK), así que los desplazamientos del driver apuntan al
+ *              mismo registro que en el hardware. El modelo del bus
+ *              (i2c_bus_sim.c) los lee y escribe como lo haría el periférico.
+ *
+ * Nota:
+ * - Solo declara lo que usan i2c.c e i2c_isr.h; no es un xc.h completo.
+ * - Los campos de bits siguen el orden LSB primero, igual que XC16.
+ *
+ ******************************************************************************/
+
+#ifndef I2C_SIM_XC_H
+#define I2C_SIM_XC_H
+
+#include <stdint.h>
+
+// =============================================================================
+// I2C1
+// =============================================================================
+
+extern volatile uint16_t I2CSIM_Regs[7];
+extern volatile uint16_t I2CSIM_I2C2[7];   // I2C2 no existe: solo para compilar
+
+// Accesos con efecto lateral, como en el periférico: leer I2C1RCV borra
+// RBF y I2C1STAT refleja en TBF si I2C1TRN tiene un byte pendiente. El
+// driver usa desplazamientos sobre I2C1CON y no pasa por aquí.
+volatile uint16_t *I2CSim_RcvReg(void);
+volatile uint16_t *I2CSim_StatReg(void);
+
+#define I2C1RCV     (*I2CSim_RcvReg())
+#define I2C1TRN     I2CSIM_Regs[1]
+#define I2C1BRG     I2CSIM_Regs[2]
+#define I2C1CON     I2CSIM_Regs[3]
+#define I2C1STAT    (*I2CSim_StatReg())
+#define I2C1ADD     I2CSIM_Regs[5]
+#define I2C1MSK     I2CSIM_Regs[6]
+#define I2C2CON     I2CSIM_I2C2[3]
+
+typedef struct {
+    uint16_t SEN:1;
+    uint16_t RSEN:1;
+    uint16_t PEN:1;
+    uint16_t RCEN:1;
+    uint16_t ACKEN:1;
+    uint16_t ACKDT:1;
+    uint16_t STREN:1;
+    uint16_t GCEN:1;
+    uint16_t SMEN:1;
+    uint16_t DISSLW:1;
+    uint16_t A10M:1;
+    uint16_t IPMIEN:1;
+    uint16_t SCLREL:1;
+    uint16_t I2CSIDL:1;
+    uint16_t :1;
+    uint16_t I2CEN:1;
+} I2CSIM_CONbits_t;
+
+typedef struct {
+    uint16_t TBF:1;
+    uint16_t RBF:1;
+    uint16_t R_W:1;
+    uint16_t S:1;
+    uint16_t P:1;
+    uint16_t D_A:1;
+    uint16_t I2COV:1;
+    uint16_t IWCOL:1;
+    uint16_t ADD10:1;
+    uint16_t GCSTAT:1;
+    uint16_t BCL:1;
+    uint16_t :3;
+    uint16_t TRSTAT:1;
+    uint16_t ACKSTAT:1;
+} I2CSIM_STATbits_t;
+
+#define I2C1CONbits     (*(volatile I2CSIM_CONbits_t *)&I2C1CON)
+#define I2C1STATbits    (*(volatile I2CSIM_STATbits_t *)&I2C1STAT)
+
+// =============================================================================
+// INTERRUPCIONES Y TIMER2 (perfilado)
+// =============================================================================
+
+extern volatile uint16_t IFS1;
+
+typedef struct {
+    uint16_t SI2C1IF:1;
+    uint16_t MI2C1IF:1;
+    uint16_t :14;
+} I2CSIM_IFS1bits_t;
+
+#define IFS1bits        (*(volatile I2CSIM_IFS1bits_t *)&IFS1)
+
+extern volatile uint16_t TMR2, PR2, T2CON;
+
+typedef struct {
+    uint16_t :15;
+    uint16_t TON:1;
+} I2CSIM_T2CONbits_t;
+
+#define T2CONbits       (*(volatile I2CSIM_T2CONbits_t *)&T2CON)
+
+#endif /* I2C_SIM_XC_H */
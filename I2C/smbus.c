@@ -0,0 +1,331 @@
+/*******************************************************************************
+ * smbus.c - Implementación del protocolo SMBus/PMBus (ver smbus.h)
+ *
+ ******************************************************************************/
+
+#include "smbus.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// CRC-8 SMBus, polinomio 0x07, sin reflexión, valor inicial 0
+const uint8_t SMBUS_CrcTable[256] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65,
+    0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5,
+    0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85,
+    0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2,
+    0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2,
+    0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32,
+    0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42,
+    0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C,
+    0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC,
+    0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C,
+    0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C,
+    0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B,
+    0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B,
+    0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB,
+    0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB,
+    0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+
+// =============================================================================
+// MOTOR DE TRANSACCIONES
+// =============================================================================
+
+// Una transacción SMBus: escritura de comando + datos y, opcionalmente,
+// RESTART + lectura. El PEC se acumula sobre cada byte del bus.
+typedef struct {
+    const SMBUS_Device_t *dev;
+    uint8_t pec;
+    SMBUS_Status_t status;
+} SMBUS_Xfer_t;
+
+static SMBUS_Status_t _SMBUS_Fault(I2C_Module_t module) {
+    I2C_State_t state = I2C_GetLastError(module);
+    if (state == I2C_STATE_TIMEOUT || state == I2C_STATE_BUS_COLLISION ||
+        state == I2C_STATE_ARB_LOST || state == I2C_STATE_OVERRUN) {
+        return SMBUS_ERR_BUS;
+    }
+    return SMBUS_ERR_NACK;
+}
+
+/**
+ * @brief Envía un byte y lo añade al PEC
+ */
+static bool _SMBUS_Tx(SMBUS_Xfer_t *x, uint8_t data) {
+    if (x->status != SMBUS_OK) return false;
+    if (!I2C_WriteByte(x->dev->module, data)) {
+        x->status = _SMBUS_Fault(x->dev->module);
+        return false;
+    }
+    x->pec = SMBUS_PEC_UPDATE(x->pec, data);
+    return true;
+}
+
+/**
+ * @brief Recibe un byte y lo añade al PEC
+ */
+static uint8_t _SMBUS_Rx(SMBUS_Xfer_t *x, bool ack) {
+    uint8_t data;
+
+    if (x->status != SMBUS_OK) return 0xFF;
+    data = I2C_ReadByte(x->dev->module, ack);
+    if (_SMBUS_Fault(x->dev->module) == SMBUS_ERR_BUS) {
+        x->status = SMBUS_ERR_BUS;
+        return 0xFF;
+    }
+    x->pec = SMBUS_PEC_UPDATE(x->pec, data);
+    return data;
+}
+
+/**
+ * @brief START + dirección de escritura + comando
+ */
+static bool _SMBUS_Begin(SMBUS_Xfer_t *x, const SMBUS_Device_t *dev, uint8_t cmd) {
+    x->dev = dev;
+    x->pec = 0;
+    x->status = SMBUS_OK;
+
+    if (!I2C_Start(dev->module)) {
+        x->status = SMBUS_ERR_BUS;
+        return false;
+    }
+    return _SMBUS_Tx(x, (uint8_t)(dev->address << 1)) && _SMBUS_Tx(x, cmd);
+}
+
+/**
+ * @brief RESTART + dirección de lectura
+ */
+static bool _SMBUS_Turnaround(SMBUS_Xfer_t *x) {
+    if (x->status != SMBUS_OK) return false;
+    if (!I2C_Restart(x->dev->module)) {
+        x->status = SMBUS_ERR_BUS;
+        return false;
+    }
+    return _SMBUS_Tx(x, (uint8_t)((x->dev->address << 1) | 0x01));
+}
+
+/**
+ * @brief Cierra una escritura: PEC (si procede) y STOP
+ */
+static SMBUS_Status_t _SMBUS_EndWrite(SMBUS_Xfer_t *x) {
+    if (x->dev->pec) _SMBUS_Tx(x, x->pec);
+    if (!I2C_Stop(x->dev->module) && x->status == SMBUS_OK) x->status = SMBUS_ERR_BUS;
+    return x->status;
+}
+
+/**
+ * @brief Lee 'length' bytes, el PEC si procede, y cierra con STOP
+ *
+ * El último byte del bus (dato o PEC) va con NACK.
+ */
+static SMBUS_Status_t _SMBUS_EndRead(SMBUS_Xfer_t *x, uint8_t *data, uint8_t length) {
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        bool last = (i == length - 1u) && !x->dev->pec;
+        data[i] = _SMBUS_Rx(x, !last);
+    }
+    if (x->dev->pec) {
+        // El PEC recibido se añade al CRC: si es correcto el resultado es 0
+        _SMBUS_Rx(x, false);
+        if (x->status == SMBUS_OK && x->pec != 0) x->status = SMBUS_ERR_PEC;
+    }
+    if (!I2C_Stop(x->dev->module) && x->status == SMBUS_OK) x->status = SMBUS_ERR_BUS;
+    return x->status;
+}
+
+static void _SMBUS_Abort(SMBUS_Xfer_t *x) {
+    I2C_Stop(x->dev->module);
+}
+
+// =============================================================================
+// FUNCIONES PÚBLICAS
+// =============================================================================
+
+/**
+ * @brief Send byte: solo el comando (p. ej. PMBUS_CLEAR_FAULTS)
+ */
+SMBUS_Status_t SMBUS_SendByte(const SMBUS_Device_t *dev, uint8_t cmd) {
+    SMBUS_Xfer_t x;
+
+    if (dev == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    return _SMBUS_EndWrite(&x);
+}
+
+SMBUS_Status_t SMBUS_WriteByte(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t data) {
+    SMBUS_Xfer_t x;
+
+    if (dev == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Tx(&x, data)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    return _SMBUS_EndWrite(&x);
+}
+
+/**
+ * @brief Write word: byte bajo primero
+ */
+SMBUS_Status_t SMBUS_WriteWord(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t data) {
+    SMBUS_Xfer_t x;
+
+    if (dev == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Tx(&x, (uint8_t)data) ||
+        !_SMBUS_Tx(&x, (uint8_t)(data >> 8))) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    return _SMBUS_EndWrite(&x);
+}
+
+SMBUS_Status_t SMBUS_ReadByte(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t *data) {
+    SMBUS_Xfer_t x;
+    uint8_t b;
+
+    if (dev == NULL || data == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Turnaround(&x)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    if (_SMBUS_EndRead(&x, &b, 1) == SMBUS_OK) *data = b;
+    return x.status;
+}
+
+SMBUS_Status_t SMBUS_ReadWord(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t *data) {
+    SMBUS_Xfer_t x;
+    uint8_t b[2];
+
+    if (dev == NULL || data == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Turnaround(&x)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    if (_SMBUS_EndRead(&x, b, 2) == SMBUS_OK) *data = (uint16_t)(b[0] | (b[1] << 8));
+    return x.status;
+}
+
+/**
+ * @brief Block write: comando, contador y 1..SMBUS_BLOCK_MAX bytes
+ */
+SMBUS_Status_t SMBUS_BlockWrite(const SMBUS_Device_t *dev, uint8_t cmd, const uint8_t *data, uint8_t length) {
+    SMBUS_Xfer_t x;
+    uint8_t i;
+
+    if (dev == NULL || data == NULL) return SMBUS_ERR_INVALID;
+    if (length == 0 || length > SMBUS_BLOCK_MAX) return SMBUS_ERR_LENGTH;
+
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Tx(&x, length)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    for (i = 0; i < length; i++) {
+        if (!_SMBUS_Tx(&x, data[i])) {
+            _SMBUS_Abort(&x);
+            return x.status;
+        }
+    }
+    return _SMBUS_EndWrite(&x);
+}
+
+/**
+ * @brief Block read: el esclavo envía el contador y luego los datos
+ *
+ * Si el contador supera max_length, la lectura se corta con NACK y se
+ * devuelve SMBUS_ERR_LENGTH.
+ */
+SMBUS_Status_t SMBUS_BlockRead(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t *buffer, uint8_t *length, uint8_t max_length) {
+    SMBUS_Xfer_t x;
+    uint8_t tmp[SMBUS_BLOCK_MAX];
+    uint8_t count;
+
+    if (dev == NULL || buffer == NULL || length == NULL) return SMBUS_ERR_INVALID;
+    if (max_length > SMBUS_BLOCK_MAX) max_length = SMBUS_BLOCK_MAX;
+
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Turnaround(&x)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+
+    count = _SMBUS_Rx(&x, true);
+    if (x.status != SMBUS_OK) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    if (count == 0 || count > max_length) {
+        (void)I2C_ReadByte(dev->module, false);  // terminar la lectura
+        I2C_Stop(dev->module);
+        return SMBUS_ERR_LENGTH;
+    }
+    if (_SMBUS_EndRead(&x, tmp, count) == SMBUS_OK) {
+        memcpy(buffer, tmp, count);  // solo datos con PEC correcto
+        *length = count;
+    }
+    return x.status;
+}
+
+/**
+ * @brief Process call: escribe una palabra y lee la respuesta
+ */
+SMBUS_Status_t SMBUS_ProcessCall(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t data, uint16_t *reply) {
+    SMBUS_Xfer_t x;
+    uint8_t b[2];
+
+    if (dev == NULL || reply == NULL) return SMBUS_ERR_INVALID;
+    if (!_SMBUS_Begin(&x, dev, cmd) || !_SMBUS_Tx(&x, (uint8_t)data) ||
+        !_SMBUS_Tx(&x, (uint8_t)(data >> 8)) || !_SMBUS_Turnaround(&x)) {
+        _SMBUS_Abort(&x);
+        return x.status;
+    }
+    if (_SMBUS_EndRead(&x, b, 2) == SMBUS_OK) *reply = (uint16_t)(b[0] | (b[1] << 8));
+    return x.status;
+}
+
+/**
+ * @brief PEC de un buffer completo (mensajes preparados de antemano)
+ */
+uint8_t SMBUS_Pec(uint8_t pec, const uint8_t *data, uint8_t length) {
+    while (length--) pec = SMBUS_PEC_UPDATE(pec, *data++);
+    return pec;
+}
+
+/**
+ * @brief PMBus LINEAR11 (exponente de 5 bits, mantisa de 11, con signo)
+ *        a milésimas de la unidad (mV, mA, m°C)
+ *
+ * Con exponente positivo el resultado puede pasar de 32 bits
+ * (1023 * 1000 * 2^15): se escala en 64 bits multiplicando y se satura.
+ */
+int32_t PMBUS_Linear11ToMilli(uint16_t value) {
+    int8_t exp = (int8_t)((int16_t)value >> 11);
+    int32_t mant = (int16_t)(value << 5) >> 5;
+    int32_t milli = mant * 1000;
+    int64_t scaled;
+
+    if (exp < 0) return milli >> -exp;  // redondeo hacia -inf, como el desplazamiento
+
+    scaled = (int64_t)milli * ((int64_t)1 << exp);
+    if (scaled > INT32_MAX) return INT32_MAX;
+    if (scaled < INT32_MIN) return INT32_MIN;
+    return (int32_t)scaled;
+}
@@ -0,0 +1,86 @@
+/*******************************************************************************
+ * smbus.h - Protocolo SMBus/PMBus sobre la librería I2C (maestro)
+ *
+ * Descripción: Transacciones SMBus 3.x con PEC opcional por dispositivo:
+ *              send byte, write/read byte, write/read word, block write/read
+ *              y process call. Ayudas PMBus para el formato LINEAR11.
+ *
+ * Características:
+ * - PEC (CRC-8, x^8 + x^2 + x + 1) calculado byte a byte a medida que los
+ *   bytes pasan por el bus, con una tabla de 256 bytes en flash: una
+ *   búsqueda y un XOR por byte, sin recorrer el mensaje al final.
+ * - SMBUS_PEC_UPDATE() es una macro: sirve también desde una ISR.
+ * - Un PEC erróneo en una lectura se informa (SMBUS_ERR_PEC) y los datos
+ *   no se copian al llamador.
+ *
+ * Nota:
+ * - Los umbrales SMBus de SDA/SCL (SMEN) se activan con smbus_enable en
+ *   I2C_Config_t.
+ * - Con otro maestro en el bus, perder el arbitraje da SMBUS_ERR_BUS sin
+ *   repetir la transacción (se arman con I2C_Start/WriteByte, no con
+ *   I2C_WriteData): repetirla es decisión del llamador.
+ * - Bloques de 1..SMBUS_BLOCK_MAX bytes (32 en SMBus 2.0, 255 en 3.x;
+ *   aquí se limita para no reservar pila de más).
+ *
+ ******************************************************************************/
+
+#ifndef SMBUS_H
+#define SMBUS_H
+
+#include "i2c.h"
+
+// =============================================================================
+// DEFINICIONES DE CONFIGURACIÓN
+// =============================================================================
+
+#define SMBUS_BLOCK_MAX         32u
+
+// Comandos PMBus habituales
+#define PMBUS_OPERATION         0x01u
+#define PMBUS_CLEAR_FAULTS      0x03u
+#define PMBUS_VOUT_MODE         0x20u
+#define PMBUS_STATUS_WORD       0x79u
+#define PMBUS_READ_VIN          0x88u
+#define PMBUS_READ_VOUT         0x8Bu
+#define PMBUS_READ_IOUT         0x8Cu
+#define PMBUS_READ_TEMPERATURE_1 0x8Du
+#define PMBUS_MFR_ID            0x99u
+#define PMBUS_MFR_MODEL         0x9Au
+
+typedef enum {
+    SMBUS_OK = 0,
+    SMBUS_ERR_NACK,         // dirección, comando o dato sin ACK
+    SMBUS_ERR_BUS,          // timeout, colisión, arbitraje perdido u overrun
+    SMBUS_ERR_PEC,          // PEC recibido no coincide
+    SMBUS_ERR_LENGTH,       // bloque vacío o mayor que el buffer
+    SMBUS_ERR_INVALID       // parámetros no válidos
+} SMBUS_Status_t;
+
+// Dispositivo SMBus/PMBus
+typedef struct {
+    I2C_Module_t module;
+    uint8_t address;        // 7 bits
+    bool pec;               // el dispositivo usa PEC
+} SMBUS_Device_t;
+
+// PEC incremental: pec = SMBUS_PEC_UPDATE(pec, byte), empezando en 0
+extern const uint8_t SMBUS_CrcTable[256];
+#define SMBUS_PEC_UPDATE(pec, b)    (SMBUS_CrcTable[(uint8_t)((pec) ^ (b))])
+
+// =============================================================================
+// PROTOTIPOS DE FUNCIONES
+// =============================================================================
+
+SMBUS_Status_t SMBUS_SendByte(const SMBUS_Device_t *dev, uint8_t cmd);
+SMBUS_Status_t SMBUS_WriteByte(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t data);
+SMBUS_Status_t SMBUS_WriteWord(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t data);
+SMBUS_Status_t SMBUS_ReadByte(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t *data);
+SMBUS_Status_t SMBUS_ReadWord(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t *data);
+SMBUS_Status_t SMBUS_BlockWrite(const SMBUS_Device_t *dev, uint8_t cmd, const uint8_t *data, uint8_t length);
+SMBUS_Status_t SMBUS_BlockRead(const SMBUS_Device_t *dev, uint8_t cmd, uint8_t *buffer, uint8_t *length, uint8_t max_length);
+SMBUS_Status_t SMBUS_ProcessCall(const SMBUS_Device_t *dev, uint8_t cmd, uint16_t data, uint16_t *reply);
+
+uint8_t SMBUS_Pec(uint8_t pec, const uint8_t *data, uint8_t length);
+int32_t PMBUS_Linear11ToMilli(uint16_t value);
+
+#endif /* SMBUS_H */
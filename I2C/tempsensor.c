@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * tempsensor.c - Implementación de los sensores de temperatura (ver tempsensor.h)
+ *
+ ******************************************************************************/
+
+#include "tempsensor.h"
+#include <stddef.h>
+
+// =============================================================================
+// TABLA DE MODELOS
+// =============================================================================
+
+// Q8.8 = (int16_t)((raw << shift) & mask)
+typedef struct {
+    uint8_t temp_reg;
+    uint8_t shift;
+    uint16_t mask;
+} TSENS_Model_t;
+
+static const TSENS_Model_t tsens_models[TSENS_TYPE_COUNT] = {
+    [TSENS_LM75]    = { 0x00, 0, 0xFFE0 },  // ya en Q8.8, 5 bits de relleno
+    [TSENS_TMP102]  = { 0x00, 0, 0xFFF0 },  // ya en Q8.8, 4 bits de relleno
+    [TSENS_MCP9808] = { 0x05, 4, 0xFFFF },  // 1/16 °C: bits 15..13 son alertas
+};
+
+static I2C_Module_t tsens_module = I2C_MODULE_1;
+static TSENS_Sensor_t *tsens_table = NULL;
+static uint8_t tsens_count = 0;
+
+// =============================================================================
+// FUNCIONES PRIVADAS
+// =============================================================================
+
+/**
+ * @brief Fallo que impide seguir usando el bus en este lote
+ */
+static bool _TSENS_BusFault(void) {
+    I2C_State_t state = I2C_GetLastError(tsens_module);
+    return state == I2C_STATE_TIMEOUT || state == I2C_STATE_BUS_COLLISION ||
+           state == I2C_STATE_ARB_LOST || state == I2C_STATE_OVERRUN;
+}
+
+static void _TSENS_Fail(TSENS_Sensor_t *s) {
+    s->valid = false;
+    s->ptr = TSENS_PTR_UNKNOWN;
+    s->errors++;
+}
+
+/**
+ * @brief Lee un sensor dentro del lote; el bus ya tiene START/RESTART
+ * @return false si el sensor no respondió
+ */
+static bool _TSENS_ReadOne(TSENS_Sensor_t *s) {
+    const TSENS_Model_t *m = &tsens_models[s->type];
+    uint16_t raw;
+
+    if (s->ptr != m->temp_reg) {
+        if (!I2C_WriteByte(tsens_module, (uint8_t)(s->address << 1)) ||
+            !I2C_WriteByte(tsens_module, m->temp_reg)) {
+            return false;
+        }
+        s->ptr = m->temp_reg;
+        if (!I2C_Restart(tsens_module)) return false;
+    }
+
+    if (!I2C_WriteByte(tsens_module, (uint8_t)((s->address << 1) | 0x01))) return false;
+    raw = (uint16_t)I2C_ReadByte(tsens_module, true) << 8;
+    raw |= I2C_ReadByte(tsens_module, false);
+    if (_TSENS_BusFault()) return false;
+
+    s->temp = (TSENS_Temp_t)((uint16_t)(raw << m->shift) & m->mask);
+    return true;
+}
+
+// =============================================================================
+// FUNCIONES PÚBLICAS
+// =============================================================================
+
+/**
+ * @brief Registra la tabla de sensores (el bus debe estar inicializado)
+ */
+void TSENS_Init(I2C_Module_t module, TSENS_Sensor_t *sensors, uint8_t count) {
+    uint8_t i;
+
+    tsens_module = module;
+    tsens_table = sensors;
+    tsens_count = (sensors != NULL) ? count : 0;
+
+    for (i = 0; i < tsens_count; i++) {
+        sensors[i].temp = 0;
+        sensors[i].valid = false;
+        sensors[i].ptr = TSENS_PTR_UNKNOWN;  // el MCU puede reiniciarse solo
+        sensors[i].errors = 0;
+    }
+}
+
+/**
+ * @brief Lee todos los sensores en una sola transacción
+ * @return Número de sensores con lectura válida
+ */
+uint8_t TSENS_PollAll(void) {
+    uint8_t i, ok = 0;
+
+    if (tsens_count == 0) return 0;
+    if (!I2C_Start(tsens_module)) {
+        for (i = 0; i < tsens_count; i++) _TSENS_Fail(&tsens_table[i]);
+        return 0;
+    }
+
+    for (i = 0; i < tsens_count; i++) {
+        TSENS_Sensor_t *s = &tsens_table[i];
+
+        if (i > 0 && !I2C_Restart(tsens_module)) break;
+        if (_TSENS_ReadOne(s)) {
+            s->valid = true;
+            ok++;
+        } else {
+            _TSENS_Fail(s);
+            if (_TSENS_BusFault()) {
+                i++;
+                break;
+            }
+        }
+    }
+
+    // Con el bus caído, el resto del lote no se ha leído
+    for (; i < tsens_count; i++) _TSENS_Fail(&tsens_table[i]);
+
+    I2C_Stop(tsens_module);
+    return ok;
+}
+
+/**
+ * @brief Olvida el puntero del sensor: la próxima lectura lo reescribe
+ */
+void TSENS_Invalidate(TSENS_Sensor_t *sensor) {
+    if (sensor != NULL) sensor->ptr = TSENS_PTR_UNKNOWN;
+}
+
+/**
+ * @brief Lee un registro de 16 bits (límites, histéresis...) fuera del lote
+ *
+ * Deja el puntero en ese registro; el siguiente lote lo devuelve a la
+ * temperatura con una sola escritura.
+ */
+bool TSENS_ReadRegister(TSENS_Sensor_t *sensor, uint8_t reg, uint16_t *value) {
+    uint8_t buf[2];
+
+    if (sensor == NULL || value == NULL) return false;
+
+    sensor->ptr = TSENS_PTR_UNKNOWN;
+    if (!I2C_WriteData(tsens_module, sensor->address, &reg, 1)) return false;
+    sensor->ptr = reg;
+    if (!I2C_ReadData(tsens_module, sensor->address, buf, 2)) return false;
+
+    *value = (uint16_t)((buf[0] << 8) | buf[1]);
+    return true;
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * tempsensor.h - Sensores de temperatura I2C (LM75 y compatibles)
+ *
+ * Descripción: Lectura por lotes de varios sensores de temperatura sobre la
+ *              librería I2C. Todos los sensores de la tabla se leen en una
+ *              sola transacción (START ... RESTART ... STOP), sin soltar el
+ *              bus entre uno y otro.
+ *
+ * Características:
+ * - Puntero de registro persistente: el sensor conserva el último puntero
+ *   escrito, así que solo se escribe cuando no apunta ya a la temperatura.
+ *   En régimen cada sensor cuesta dirección + 2 bytes.
+ * - Resultado en coma fija Q8.8 (1 LSB = 1/256 °C): el registro del
+ *   LM75/TMP102 ya tiene ese formato, la conversión es una máscara. Sin
+ *   float: la emulación cuesta cientos de ciclos por conversión.
+ * - Un sensor que no responde se marca como no válido y el lote sigue.
+ *
+ * Nota:
+ * - Cualquier acceso al sensor fuera de este módulo puede mover el
+ *   puntero: llamar después a TSENS_Invalidate().
+ * - Q8.8 cubre -128..+127.996 °C, el rango de los tres modelos.
+ * - Si otro maestro gana el bus a mitad de lote, el resto queda no válido
+ *   hasta el próximo TSENS_PollAll (no se repite dentro del lote).
+ *
+ ******************************************************************************/
+
+#ifndef TEMPSENSOR_H
+#define TEMPSENSOR_H
+
+#include "i2c.h"
+
+// =============================================================================
+// DEFINICIONES DE CONFIGURACIÓN
+// =============================================================================
+
+typedef enum {
+    TSENS_LM75 = 0,     // 11 bits (LM75A), 0.125 °C
+    TSENS_TMP102,       // 12 bits, 0.0625 °C
+    TSENS_MCP9808,      // 13 bits con signo, 0.0625 °C, registro 0x05
+    TSENS_TYPE_COUNT
+} TSENS_Type_t;
+
+// Temperatura en Q8.8
+typedef int16_t TSENS_Temp_t;
+
+#define TSENS_Q8(celsius)       ((TSENS_Temp_t)((celsius) * 256))
+#define TSENS_TO_CENTI(t)       ((int16_t)(((int32_t)(t) * 100) >> 8))
+
+// Puntero desconocido (arranque, error o acceso externo)
+#define TSENS_PTR_UNKNOWN       0xFFu
+
+typedef struct {
+    uint8_t address;            // 7 bits
+    TSENS_Type_t type;
+    TSENS_Temp_t temp;          // última lectura válida
+    bool valid;                 // la última lectura del lote fue correcta
+    uint8_t ptr;                // puntero del sensor según el driver
+    uint16_t errors;
+} TSENS_Sensor_t;
+
+// =============================================================================
+// PROTOTIPOS DE FUNCIONES
+// =============================================================================
+
+void TSENS_Init(I2C_Module_t module, TSENS_Sensor_t *sensors, uint8_t count);
+uint8_t TSENS_PollAll(void);
+void TSENS_Invalidate(TSENS_Sensor_t *sensor);
+bool TSENS_ReadRegister(TSENS_Sensor_t *sensor, uint8_t reg, uint16_t *value);
+
+#endif /* TEMPSENSOR_H */
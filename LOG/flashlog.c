@@ -0,0 +1,300 @@
+/*
+ * flashlog.c - Implementación del registro circular en flash SPI (ver flashlog.h)
+ *
+ *  Posiciones: el log es un flujo de bytes con posición 'pos' creciente;
+ *  la dirección en flash es FLOG_BASE_ADDR + (pos % tamaño de la región) y
+ *  el índice en el buffer RAM es pos % FLOG_RAM_SIZE. Ambos tamaños son
+ *  potencias de 2 y múltiplos de página, así que una página nunca se parte
+ *  ni en el buffer ni entre sectores.
+ *
+ ******************************************************************************/
+
+#include "flashlog.h"
+#include "spiflash.h"
+#include <string.h>
+
+#define FLOG_REGION_SIZE    ((uint32_t)FLOG_SECTOR_COUNT * FLOG_SECTOR_SIZE)
+#define FLOG_REGION_MASK    (FLOG_REGION_SIZE - 1UL)
+#define FLOG_PAGE_SIZE      SFLASH_PAGE_SIZE
+#define FLOG_READ_CHUNK     32u
+
+#if (FLOG_SECTOR_COUNT & (FLOG_SECTOR_COUNT - 1u)) != 0
+#error "FLOG_SECTOR_COUNT debe ser potencia de 2"
+#endif
+#if (FLOG_RAM_SIZE & (FLOG_RAM_SIZE - 1u)) != 0 || (FLOG_RAM_SIZE % SFLASH_PAGE_SIZE) != 0
+#error "FLOG_RAM_SIZE debe ser potencia de 2 y múltiplo de página"
+#endif
+
+typedef enum {
+    FLOG_ERASE_IDLE = 0,    /* sector siguiente ya borrado              */
+    FLOG_ERASE_QUEUED,      /* pendiente de lanzar desde FLOG_Service   */
+    FLOG_ERASE_RUNNING      /* borrado en curso en la flash             */
+} FLOG_EraseState_t;
+
+/* Internals */
+static uint8_t flog_ram[FLOG_RAM_SIZE];
+static uint32_t flog_wr = 0;        /* siguiente byte a encolar             */
+static uint32_t flog_prog = 0;      /* siguiente byte a programar           */
+static bool flog_mounted = false;
+static bool flog_flush = false;     /* programar también páginas parciales  */
+
+static uint32_t flog_seq = 0;
+static uint32_t flog_erase_count = 0;       /* del sector actual            */
+static uint32_t flog_ready_count = 0;       /* del sector ya borrado        */
+static uint32_t flog_erase_pos = 0;         /* sector a borrar (posición)   */
+static FLOG_EraseState_t flog_erase_state = FLOG_ERASE_IDLE;
+
+static uint32_t flog_records = 0;
+static uint32_t flog_dropped = 0;
+
+static uint32_t flog_addr(uint32_t pos)
+{
+    return FLOG_BASE_ADDR + (pos & FLOG_REGION_MASK);
+}
+
+static uint32_t flog_sector_start(uint32_t pos)
+{
+    return pos & ~(FLOG_SECTOR_SIZE - 1UL);
+}
+
+/* Copia al buffer circular (el llamador ya comprobó el espacio) */
+static void flog_put(const uint8_t *data, uint16_t length)
+{
+    while (length--) {
+        flog_ram[flog_wr & (FLOG_RAM_SIZE - 1u)] = data ? *data++ : 0xFFu;
+        flog_wr++;
+    }
+}
+
+/* Escribe la cabecera de un sector nuevo y encola el borrado del siguiente */
+static void flog_open_sector(void)
+{
+    FLOG_SectorHdr_t hdr;
+    uint8_t raw[FLOG_SECTOR_HDR_SIZE];
+
+    flog_seq++;
+    flog_erase_count = flog_ready_count;
+    hdr.seq = flog_seq;
+    hdr.erase_count = flog_erase_count;
+    FLOG_EncodeSectorHdr(raw, &hdr);
+    flog_put(raw, FLOG_SECTOR_HDR_SIZE);
+
+    flog_erase_pos = flog_sector_start(flog_wr) + FLOG_SECTOR_SIZE;
+    flog_erase_state = FLOG_ERASE_QUEUED;
+}
+
+/* Recorre los registros de un sector; devuelve el offset tras el último
+ * válido, o FLOG_SECTOR_SIZE si encuentra uno cortado */
+static uint32_t flog_scan_sector(uint32_t base)
+{
+    uint32_t off = FLOG_SECTOR_HDR_SIZE;
+    uint8_t buf[FLOG_READ_CHUNK];
+
+    while (off + FLOG_REC_OVERHEAD <= FLOG_SECTOR_SIZE) {
+        FLOG_RecHdr_t rec;
+        uint16_t crc, left;
+        uint32_t p;
+
+        if (SFLASH_Read(base + off, buf, FLOG_REC_HDR_SIZE) != SPI_OK) return FLOG_SECTOR_SIZE;
+        FLOG_DecodeRecHdr(buf, &rec);
+        if (rec.len == FLOG_REC_END) return off;
+        if (rec.len > FLOG_MAX_PAYLOAD ||
+            off + FLOG_REC_OVERHEAD + rec.len > FLOG_SECTOR_SIZE) {
+            return FLOG_SECTOR_SIZE;
+        }
+
+        crc = FLOG_Crc16(FLOG_CRC_INIT, buf, FLOG_REC_HDR_SIZE);
+        p = base + off + FLOG_REC_HDR_SIZE;
+        left = rec.len;
+        while (left > 0) {
+            uint16_t n = left < FLOG_READ_CHUNK ? left : FLOG_READ_CHUNK;
+            if (SFLASH_Read(p, buf, n) != SPI_OK) return FLOG_SECTOR_SIZE;
+            crc = FLOG_Crc16(crc, buf, n);
+            p += n;
+            left = (uint16_t)(left - n);
+        }
+        if (SFLASH_Read(p, buf, FLOG_REC_CRC_SIZE) != SPI_OK) return FLOG_SECTOR_SIZE;
+        if (crc != (uint16_t)(buf[0] | ((uint16_t)buf[1] << 8))) return FLOG_SECTOR_SIZE;
+
+        off += FLOG_REC_OVERHEAD + rec.len;
+    }
+    return off;
+}
+
+FLOG_Status_t FLOG_Mount(void)
+{
+    uint8_t raw[FLOG_SECTOR_HDR_SIZE];
+    FLOG_SectorHdr_t hdr, best_hdr = { 0, 0 };
+    uint16_t best = 0, i;
+    bool found = false;
+
+    flog_mounted = false;
+    flog_records = 0;
+    flog_dropped = 0;
+    flog_flush = false;
+
+    for (i = 0; i < FLOG_SECTOR_COUNT; i++) {
+        if (SFLASH_Read(FLOG_BASE_ADDR + (uint32_t)i * FLOG_SECTOR_SIZE, raw,
+                        FLOG_SECTOR_HDR_SIZE) != SPI_OK) {
+            return FLOG_ERR_FLASH;
+        }
+        if (!FLOG_DecodeSectorHdr(raw, &hdr)) continue;
+        if (!found || hdr.seq > best_hdr.seq) {
+            best_hdr = hdr;     /* sin volver a leerla: la lectura podría fallar */
+            best = i;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        /* Flash nueva o de otro uso: empezar en el sector 0 */
+        if (SFLASH_EraseSector(FLOG_BASE_ADDR) != SPI_OK || !SFLASH_WaitReady(1000)) {
+            return FLOG_ERR_FLASH;
+        }
+        flog_seq = 0;
+        flog_ready_count = 1;
+        flog_wr = flog_prog = 0;
+        flog_open_sector();
+    } else {
+        uint32_t base = (uint32_t)best * FLOG_SECTOR_SIZE;
+        uint32_t off = flog_scan_sector(FLOG_BASE_ADDR + base);
+
+        flog_seq = best_hdr.seq;
+        flog_erase_count = best_hdr.erase_count;
+
+        /* Tras un registro cortado el resto del sector queda inservible:
+         * off = FLOG_SECTOR_SIZE y FLOG_Append pasará al siguiente sector
+         * en cuanto esté borrado */
+        flog_wr = flog_prog = base + off;
+        flog_erase_pos = base + FLOG_SECTOR_SIZE;
+        flog_erase_state = FLOG_ERASE_QUEUED;
+    }
+
+    flog_mounted = true;
+    return FLOG_OK;
+}
+
+FLOG_Status_t FLOG_Append(uint8_t type, uint32_t stamp, const void *data, uint16_t length)
+{
+    FLOG_RecHdr_t rec;
+    uint8_t raw[FLOG_REC_HDR_SIZE];
+    uint8_t crc_raw[FLOG_REC_CRC_SIZE];
+    uint32_t total = FLOG_REC_OVERHEAD + (uint32_t)length;
+    uint32_t next = flog_sector_start(flog_wr) + FLOG_SECTOR_SIZE;
+    uint32_t need = total;
+    uint32_t gap = 0;
+    uint16_t crc;
+    bool open;
+
+    if (!flog_mounted || length > FLOG_MAX_PAYLOAD) return FLOG_ERR_INVALID;
+
+    /* Sector nuevo si el registro no cabe o si el actual ya está cerrado
+     * (posición justo en el límite: lleno o cortado al montar) */
+    open = ((flog_wr & (FLOG_SECTOR_SIZE - 1UL)) == 0) || (flog_wr + total > next);
+    if (open) {
+        /* Cambio de sector: el siguiente debe estar ya borrado */
+        if (flog_erase_state != FLOG_ERASE_IDLE) {
+            flog_dropped++;
+            return FLOG_ERR_FULL;
+        }
+        gap = ((flog_wr & (FLOG_SECTOR_SIZE - 1UL)) == 0) ? 0u : next - flog_wr;
+        need = gap + FLOG_SECTOR_HDR_SIZE + total;
+    }
+    if (FLOG_RAM_SIZE - (flog_wr - flog_prog) < need) {
+        flog_dropped++;
+        return FLOG_ERR_FULL;
+    }
+
+    if (open) {
+        /* Relleno a 0xFF (no cambia la flash borrada) hasta el sector nuevo */
+        flog_put(NULL, (uint16_t)gap);
+        flog_open_sector();
+    }
+
+    rec.len = length;
+    rec.type = type;
+    rec.stamp = stamp;
+    FLOG_EncodeRecHdr(raw, &rec);
+    crc = FLOG_Crc16(FLOG_CRC_INIT, raw, FLOG_REC_HDR_SIZE);
+    crc = FLOG_Crc16(crc, (const uint8_t *)data, length);
+    crc_raw[0] = (uint8_t)crc;
+    crc_raw[1] = (uint8_t)(crc >> 8);
+
+    flog_put(raw, FLOG_REC_HDR_SIZE);
+    flog_put((const uint8_t *)data, length);
+    flog_put(crc_raw, FLOG_REC_CRC_SIZE);
+    flog_records++;
+    return FLOG_OK;
+}
+
+FLOG_Status_t FLOG_Service(void)
+{
+    uint32_t avail, page_end, n;
+
+    if (!flog_mounted) return FLOG_ERR_INVALID;
+    if (SFLASH_IsBusy()) return FLOG_OK;
+
+    if (flog_erase_state == FLOG_ERASE_RUNNING) {
+        flog_erase_state = FLOG_ERASE_IDLE;
+    }
+    if (flog_erase_state == FLOG_ERASE_QUEUED) {
+        /* Borrado adelantado: conservar el contador de desgaste del sector */
+        uint8_t raw[FLOG_SECTOR_HDR_SIZE];
+        FLOG_SectorHdr_t hdr;
+
+        if (SFLASH_Read(flog_addr(flog_erase_pos), raw, FLOG_SECTOR_HDR_SIZE) == SPI_OK &&
+            FLOG_DecodeSectorHdr(raw, &hdr)) {
+            flog_ready_count = hdr.erase_count + 1u;
+        } else {
+            flog_ready_count = flog_erase_count;   /* sin cabecera: estimar */
+        }
+        if (SFLASH_EraseSector(flog_addr(flog_erase_pos)) != SPI_OK) return FLOG_ERR_FLASH;
+        flog_erase_state = FLOG_ERASE_RUNNING;
+        return FLOG_OK;
+    }
+
+    avail = flog_wr - flog_prog;
+    if (avail == 0) {
+        flog_flush = false;
+        return FLOG_OK;
+    }
+
+    /* Una página (o el trozo que falte de ella) por llamada */
+    page_end = (flog_prog | (FLOG_PAGE_SIZE - 1u)) + 1u;
+    n = page_end - flog_prog;
+    if (avail < n) {
+        if (!flog_flush) return FLOG_OK;
+        n = avail;
+    }
+    if (SFLASH_ProgramPage(flog_addr(flog_prog),
+                           &flog_ram[flog_prog & (FLOG_RAM_SIZE - 1u)],
+                           (uint16_t)n) != SPI_OK) {
+        return FLOG_ERR_FLASH;
+    }
+    flog_prog += n;
+    return FLOG_OK;
+}
+
+FLOG_Status_t FLOG_Flush(void)
+{
+    FLOG_Status_t st = FLOG_OK;
+
+    if (!flog_mounted) return FLOG_ERR_INVALID;
+    flog_flush = true;
+    while (st == FLOG_OK && flog_wr != flog_prog) {
+        st = FLOG_Service();
+    }
+    if (st == FLOG_OK && !SFLASH_WaitReady(1000)) st = FLOG_ERR_FLASH;
+    flog_flush = false;
+    return st;
+}
+
+void FLOG_GetStats(FLOG_Stats_t *stats)
+{
+    stats->records = flog_records;
+    stats->dropped = flog_dropped;
+    stats->seq = flog_seq;
+    stats->erase_count = flog_erase_count;
+    stats->sector = (uint16_t)((flog_wr & FLOG_REGION_MASK) / FLOG_SECTOR_SIZE);
+    stats->buffered = (uint16_t)(flog_wr - flog_prog);
+}
@@ -0,0 +1,86 @@
+/*
+ * flashlog.h - Registro circular de bloques de datos en flash SPI externa
+ *
+ * Descripción:
+ *  Log de solo-añadir sobre una flash NOR SPI (spiflash.h) para capturar
+ *  bloques ADC / FIR en placas sin enlace. Formato en flashlog_format.h.
+ *
+ *  - FLOG_Append() solo copia el registro a un buffer circular en RAM
+ *    (coste de memcpy en el camino crítico; sin SPI).
+ *  - FLOG_Service(), desde el bucle principal, programa páginas completas
+ *    y lanza los borrados; una operación SPI por llamada.
+ *  - Borrado adelantado: al empezar un sector se borra el siguiente, de
+ *    modo que el cambio de sector no espera al borrado.
+ *  - Desgaste: los sectores se usan en anillo (todos se borran igual) y
+ *    cada cabecera guarda su contador de borrados.
+ *  - Tolerante a cortes: FLOG_Mount() busca el sector con mayor secuencia
+ *    y el último registro con CRC válido; tras un registro cortado se
+ *    continúa en el sector siguiente.
+ *
+ * Uso:
+ *   SFLASH_Init(&flash_dev);
+ *   FLOG_Mount();
+ *   ... productor:      FLOG_Append(FLOG_TYPE_ADC, n_bloque, datos, bytes);
+ *   ... bucle principal: FLOG_Service();
+ *   ... antes de apagar: FLOG_Flush();
+ *
+ *  Para extraer los datos, volcar la flash (flashrom, programador...) y
+ *  usar flashlog_extract en el PC.
+ *
+ * Nota:
+ *  - Mientras la flash borra (50..400 ms) los registros se acumulan en RAM;
+ *    si no caben, FLOG_Append devuelve FLOG_ERR_FULL y se cuentan como
+ *    descartados. Dimensiona FLOG_RAM_SIZE con la tasa de datos.
+ *  - Registros de hasta FLOG_MAX_PAYLOAD bytes (238 con el buffer por
+ *    defecto): un bloque de FilterOut de 256 muestras se registra en
+ *    cuatro llamadas de 64 muestras.
+ *
+ ******************************************************************************/
+
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flashlog_format.h"
+
+/* Región de la flash usada por el log */
+#ifndef FLOG_BASE_ADDR
+#define FLOG_BASE_ADDR          0x000000UL
+#endif
+#ifndef FLOG_SECTOR_COUNT
+#define FLOG_SECTOR_COUNT       256u        /* 1 MB; potencia de 2 */
+#endif
+
+/* Buffer RAM (múltiplo de página, potencia de 2) */
+#ifndef FLOG_RAM_SIZE
+#define FLOG_RAM_SIZE           512u
+#endif
+
+/* Mayor registro que cabe en el buffer junto a un cambio de sector
+ * (relleno del sector anterior + cabecera nueva + registro) */
+#define FLOG_MAX_PAYLOAD        (((FLOG_RAM_SIZE - FLOG_SECTOR_HDR_SIZE) / 2u) - FLOG_REC_OVERHEAD)
+
+typedef enum {
+    FLOG_OK = 0,
+    FLOG_ERR_FULL,          /* no cabe en RAM ahora: registro descartado */
+    FLOG_ERR_INVALID,       /* longitud fuera de rango o log sin montar  */
+    FLOG_ERR_FLASH          /* error de la flash / SPI                   */
+} FLOG_Status_t;
+
+typedef struct {
+    uint32_t records;       /* registros aceptados desde el montaje      */
+    uint32_t dropped;       /* registros descartados (FLOG_ERR_FULL)     */
+    uint32_t seq;           /* secuencia del sector actual               */
+    uint32_t erase_count;   /* borrados del sector actual                */
+    uint16_t sector;        /* sector actual (0..FLOG_SECTOR_COUNT-1)    */
+    uint16_t buffered;      /* bytes pendientes de programar             */
+} FLOG_Stats_t;
+
+FLOG_Status_t FLOG_Mount(void);
+FLOG_Status_t FLOG_Append(uint8_t type, uint32_t stamp, const void *data, uint16_t length);
+FLOG_Status_t FLOG_Service(void);
+FLOG_Status_t FLOG_Flush(void);
+void FLOG_GetStats(FLOG_Stats_t *stats);
+
+#endif /* FLASHLOG_H */
@@ -0,0 +1,154 @@
+/*
+ * flashlog_extract.c - Extrae los registros de un volcado de la flash (PC/Linux)
+ *
+ * Descripción:
+ *  Lee una imagen binaria de la flash SPI (p. ej. "flashrom -r dump.bin"),
+ *  ordena los sectores del log por secuencia y lista los registros válidos.
+ *  No forma parte del firmware.
+ *
+ * Compilar:
+ *   gcc -O2 -o flashlog_extract flashlog_extract.c flashlog_format.c
+ *
+ * Uso:
+ *   flashlog_extract [-b base] [-n sectores] [-t tipo] [-r] dump.bin
+ *     -b base      dirección de la región del log (defecto 0)
+ *     -n sectores  sectores de la región (defecto 256)
+ *     -t tipo      solo registros de ese tipo (1 = ADC, 2 = Q15, ...)
+ *     -r           escribe los datos en binario por stdout (sin cabeceras)
+ *
+ *  Sin -r imprime una línea por registro (secuencia, sector, marca, tipo,
+ *  longitud) seguida de las muestras si el tipo es ADC o Q15.
+ *
+ ******************************************************************************/
+
+#include "flashlog_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    uint32_t index;
+    FLOG_SectorHdr_t hdr;
+} Sector_t;
+
+static int cmp_seq(const void *a, const void *b)
+{
+    const Sector_t *x = a, *y = b;
+    return (x->hdr.seq > y->hdr.seq) - (x->hdr.seq < y->hdr.seq);
+}
+
+static void print_samples(const uint8_t *p, uint16_t len, int is_signed)
+{
+    uint16_t i;
+    for (i = 0; i + 1u < len; i += 2u) {
+        uint16_t v = (uint16_t)(p[i] | (p[i + 1] << 8));
+        if (is_signed) printf("%s%d", i ? " " : "  ", (int16_t)v);
+        else printf("%s%u", i ? " " : "  ", v);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long base = 0, sectors = 256;
+    int type = -1, raw = 0, opt;
+    FILE *f;
+    uint8_t *img;
+    long size;
+    Sector_t *list;
+    uint32_t nvalid = 0, i, total = 0, bad = 0;
+
+    while ((opt = getopt(argc, argv, "b:n:t:r")) != -1) {
+        switch (opt) {
+            case 'b': base = strtoul(optarg, NULL, 0); break;
+            case 'n': sectors = strtoul(optarg, NULL, 0); break;
+            case 't': type = (int)strtol(optarg, NULL, 0); break;
+            case 'r': raw = 1; break;
+            default:
+                fprintf(stderr, "uso: %s [-b base] [-n sectores] [-t tipo] [-r] dump.bin\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "falta el fichero de volcado\n");
+        return 2;
+    }
+
+    f = fopen(argv[optind], "rb");
+    if (f == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0 || (unsigned long)size < base + sectors * FLOG_SECTOR_SIZE) {
+        fprintf(stderr, "el volcado (%ld bytes) no cubre la región del log\n", size);
+        fclose(f);
+        return 1;
+    }
+    img = malloc((size_t)size);
+    list = calloc(sectors, sizeof(Sector_t));
+    if (img == NULL || list == NULL || fread(img, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "error leyendo el volcado\n");
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    for (i = 0; i < sectors; i++) {
+        if (FLOG_DecodeSectorHdr(img + base + i * FLOG_SECTOR_SIZE, &list[nvalid].hdr)) {
+            list[nvalid].index = i;
+            nvalid++;
+        }
+    }
+    qsort(list, nvalid, sizeof(Sector_t), cmp_seq);
+
+    for (i = 0; i < nvalid; i++) {
+        const uint8_t *sec = img + base + list[i].index * FLOG_SECTOR_SIZE;
+        uint32_t off = FLOG_SECTOR_HDR_SIZE;
+
+        if (!raw) {
+            printf("# sector %u seq %u borrados %u\n", list[i].index,
+                   list[i].hdr.seq, list[i].hdr.erase_count);
+        }
+        while (off + FLOG_REC_OVERHEAD <= FLOG_SECTOR_SIZE) {
+            FLOG_RecHdr_t rec;
+            const uint8_t *data;
+            uint16_t crc;
+
+            FLOG_DecodeRecHdr(sec + off, &rec);
+            if (rec.len == FLOG_REC_END) break;
+            if (off + FLOG_REC_OVERHEAD + rec.len > FLOG_SECTOR_SIZE) {
+                bad++;
+                break;
+            }
+            data = sec + off + FLOG_REC_HDR_SIZE;
+            crc = FLOG_Crc16(FLOG_CRC_INIT, sec + off, (uint16_t)(FLOG_REC_HDR_SIZE + rec.len));
+            if (crc != (uint16_t)(data[rec.len] | (data[rec.len + 1] << 8))) {
+                bad++;      /* registro cortado: fin de este sector */
+                break;
+            }
+
+            if (type < 0 || type == rec.type) {
+                total++;
+                if (raw) {
+                    fwrite(data, 1, rec.len, stdout);
+                } else {
+                    printf("%u %u %u %u %u\n", list[i].hdr.seq, list[i].index,
+                           rec.stamp, rec.type, rec.len);
+                    if (rec.type == FLOG_TYPE_ADC || rec.type == FLOG_TYPE_Q15) {
+                        print_samples(data, rec.len, rec.type == FLOG_TYPE_Q15);
+                    }
+                }
+            }
+            off += FLOG_REC_OVERHEAD + rec.len;
+        }
+    }
+
+    fprintf(stderr, "%u sectores, %u registros, %u cortados\n", nvalid, total, bad);
+    free(list);
+    free(img);
+    return 0;
+}
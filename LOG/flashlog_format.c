@@ -0,0 +1,80 @@
+/*
+ * flashlog_format.c - Cabeceras y CRC del registro en flash (ver flashlog_format.h)
+ *
+ *  Compila igual en el firmware y en el PC (flashlog_extract.c).
+ *
+ ******************************************************************************/
+
+#include "flashlog_format.h"
+
+/* CRC-16/CCITT (polinomio 0x1021) por nibbles: 16 entradas de tabla */
+static const uint16_t flog_crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t FLOG_Crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length--) {
+        uint8_t b = *data++;
+        crc = (uint16_t)((crc << 4) ^ flog_crc_nibble[((crc >> 12) ^ (b >> 4)) & 0x0F]);
+        crc = (uint16_t)((crc << 4) ^ flog_crc_nibble[((crc >> 12) ^ b) & 0x0F]);
+    }
+    return crc;
+}
+
+static void flog_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void flog_put32(uint8_t *p, uint32_t v)
+{
+    flog_put16(p, (uint16_t)v);
+    flog_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t flog_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t flog_get32(const uint8_t *p)
+{
+    return flog_get16(p) | ((uint32_t)flog_get16(p + 2) << 16);
+}
+
+void FLOG_EncodeSectorHdr(uint8_t *out, const FLOG_SectorHdr_t *hdr)
+{
+    flog_put32(out, FLOG_SECTOR_MAGIC);
+    flog_put32(out + 4, hdr->seq);
+    flog_put32(out + 8, hdr->erase_count);
+    out[12] = FLOG_VERSION;
+    out[13] = 0xFF;
+    flog_put16(out + 14, FLOG_Crc16(FLOG_CRC_INIT, out, 14));
+}
+
+int FLOG_DecodeSectorHdr(const uint8_t *in, FLOG_SectorHdr_t *hdr)
+{
+    if (flog_get32(in) != FLOG_SECTOR_MAGIC || in[12] != FLOG_VERSION) return 0;
+    if (flog_get16(in + 14) != FLOG_Crc16(FLOG_CRC_INIT, in, 14)) return 0;
+    hdr->seq = flog_get32(in + 4);
+    hdr->erase_count = flog_get32(in + 8);
+    return 1;
+}
+
+void FLOG_EncodeRecHdr(uint8_t *out, const FLOG_RecHdr_t *hdr)
+{
+    flog_put16(out, hdr->len);
+    out[2] = hdr->type;
+    out[3] = 0xFF;
+    flog_put32(out + 4, hdr->stamp);
+}
+
+void FLOG_DecodeRecHdr(const uint8_t *in, FLOG_RecHdr_t *hdr)
+{
+    hdr->len = flog_get16(in);
+    hdr->type = in[2];
+    hdr->stamp = flog_get32(in + 4);
+}
@@ -0,0 +1,70 @@
+/*
+ * flashlog_format.h - Formato en flash del registro de datos (firmware y PC)
+ *
+ * Descripción:
+ *  Región de FLOG_SECTOR_COUNT sectores de 4 KB usada como log circular.
+ *  Cada sector empieza con una cabecera y contiene registros consecutivos
+ *  hasta encontrar una longitud 0xFFFF (flash borrada).
+ *
+ *  Cabecera de sector (16 bytes, little-endian):
+ *    0  magic        uint32  FLOG_SECTOR_MAGIC ("FLOG")
+ *    4  seq          uint32  número de secuencia creciente
+ *    8  erase_count  uint32  borrados de este sector (desgaste)
+ *   12  version      uint8   FLOG_VERSION
+ *   13  reserved     uint8   0xFF
+ *   14  crc          uint16  CRC-16/CCITT de los bytes 0..13
+ *
+ *  Registro (8 + len + 2 bytes):
+ *    0  len          uint16  bytes de datos
+ *    2  type         uint8   FLOG_TYPE_xxx
+ *    3  flags        uint8   0xFF (reservado)
+ *    4  stamp        uint32  marca del llamador (nº de bloque, ms...)
+ *    8  data[len]
+ *  8+len crc         uint16  CRC-16/CCITT de cabecera + datos
+ *
+ *  Un registro con CRC erróneo (corte de alimentación a mitad de escritura)
+ *  marca el final de los datos válidos de ese sector.
+ *
+ ******************************************************************************/
+
+#ifndef FLASHLOG_FORMAT_H
+#define FLASHLOG_FORMAT_H
+
+#include <stdint.h>
+
+#define FLOG_SECTOR_MAGIC       0x474F4C46UL    /* "FLOG" en little-endian */
+#define FLOG_VERSION            1u
+#define FLOG_SECTOR_SIZE        4096UL
+#define FLOG_SECTOR_HDR_SIZE    16u
+#define FLOG_REC_HDR_SIZE       8u
+#define FLOG_REC_CRC_SIZE       2u
+#define FLOG_REC_OVERHEAD       (FLOG_REC_HDR_SIZE + FLOG_REC_CRC_SIZE)
+#define FLOG_REC_END            0xFFFFu
+#define FLOG_CRC_INIT           0xFFFFu
+
+/* Tipos de registro */
+#define FLOG_TYPE_ADC           0x01u   /* uint16 LE, cuentas ADC           */
+#define FLOG_TYPE_Q15           0x02u   /* int16 LE, salida FIR (FilterOut) */
+#define FLOG_TYPE_TEXT          0x03u   /* texto ASCII                      */
+#define FLOG_TYPE_USER          0x80u   /* 0x80..0xFE libres para la app    */
+
+typedef struct {
+    uint32_t seq;
+    uint32_t erase_count;
+} FLOG_SectorHdr_t;
+
+typedef struct {
+    uint16_t len;
+    uint8_t type;
+    uint32_t stamp;
+} FLOG_RecHdr_t;
+
+uint16_t FLOG_Crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+
+/* Codifican/decodifican las cabeceras; decode devuelve 0 si no son válidas */
+void FLOG_EncodeSectorHdr(uint8_t *out, const FLOG_SectorHdr_t *hdr);
+int FLOG_DecodeSectorHdr(const uint8_t *in, FLOG_SectorHdr_t *hdr);
+void FLOG_EncodeRecHdr(uint8_t *out, const FLOG_RecHdr_t *hdr);
+void FLOG_DecodeRecHdr(const uint8_t *in, FLOG_RecHdr_t *hdr);
+
+#endif /* FLASHLOG_FORMAT_H */
@@ -0,0 +1,346 @@
+/*
+ * flashlog_powercut.c - Cortes de alimentación contra un modelo de flash NOR (PC/Linux)
+ *
+ * Descripción:
+ *  Ejecuta flashlog.c en el PC sobre una flash NOR simulada (sustituye a
+ *  spiflash.c) y corta la alimentación en una operación de escritura o
+ *  borrado elegida al azar. La operación cortada queda a medias: una página
+ *  programada hasta un byte con algunos bits, o un sector con bits sueltos
+ *  sin borrar. Tras cada corte se vuelve a montar el log y se comprueba:
+ *   - los registros confirmados (anteriores a un FLOG_Flush correcto) están
+ *     todos, desde el más antiguo que queda en la región;
+ *   - se recuperan en orden y sin duplicados, con su tipo y contenido;
+ *   - nunca se programa sobre bytes sin borrar.
+ *  Al final muestra el reparto de borrados entre sectores (desgaste).
+ *  No forma parte del firmware.
+ *
+ * Compilar (desde LOG/):
+ *   gcc -O2 -Wall -Wextra -DFLOG_SECTOR_COUNT=16u -Isim -I. -I../SPI \
+ *       -o flashlog_powercut flashlog_powercut.c flashlog.c flashlog_format.c
+ *
+ *  Con 16 sectores (64 KB) el log da muchas vueltas a la región.
+ *
+ * Uso:
+ *   flashlog_powercut [ciclos] [semilla]
+ *
+ *  Devuelve 0 si todas las comprobaciones pasan.
+ *
+ ******************************************************************************/
+
+#include "flashlog.h"
+#include "spiflash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_SIZE     ((uint32_t)FLOG_SECTOR_COUNT * FLOG_SECTOR_SIZE)
+#define MAX_STAMPS      (1UL << 20)
+#define CUT_MAX_OPS     400u        /* escrituras/borrados hasta el corte  */
+#define ERASE_POLLS     32u         /* consultas de BUSY por borrado (máx.) */
+
+/* ------------------------------------------------------------------------- */
+/* Modelo de flash NOR                                                        */
+/* ------------------------------------------------------------------------- */
+
+static uint8_t nor[REGION_SIZE];
+static uint32_t nor_erases[FLOG_SECTOR_COUNT];
+static unsigned nor_busy = 0;       /* consultas de BUSY pendientes         */
+static unsigned nor_cut_in = 0;     /* operaciones hasta el corte           */
+static bool nor_dead = false;       /* sin alimentación hasta el reinicio   */
+static unsigned nor_overwrites = 0; /* programaciones sobre bytes sin borrar */
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+/* true si esta operación es la del corte: queda a medias y la flash muere */
+static bool nor_cut(void)
+{
+    if (--nor_cut_in != 0u) return false;
+    nor_dead = true;
+    return true;
+}
+
+void SFLASH_Init(const SPI_Device_t *device)
+{
+    (void)device;
+}
+
+bool SFLASH_IsBusy(void)
+{
+    if (nor_busy == 0u) return false;
+    nor_busy--;
+    return true;
+}
+
+bool SFLASH_WaitReady(uint16_t timeout_ms)
+{
+    (void)timeout_ms;
+    if (nor_dead) return false;
+    nor_busy = 0;
+    return true;
+}
+
+SPI_Status_t SFLASH_Read(uint32_t address, uint8_t *buffer, uint16_t length)
+{
+    if (nor_dead) return SPI_ERR_TIMEOUT;
+    if (address + length > REGION_SIZE) return SPI_ERR_INVALID;
+    memcpy(buffer, &nor[address], length);
+    return SPI_OK;
+}
+
+SPI_Status_t SFLASH_ProgramPage(uint32_t address, const uint8_t *data, uint16_t length)
+{
+    uint16_t i, n = length;
+    bool cut;
+
+    if (nor_dead || nor_busy) return SPI_ERR_TIMEOUT;
+    if (length == 0u || address + length > REGION_SIZE ||
+        (address / SFLASH_PAGE_SIZE) != ((address + length - 1u) / SFLASH_PAGE_SIZE)) {
+        return SPI_ERR_INVALID;
+    }
+    for (i = 0; i < length; i++) {
+        if ((nor[address + i] & data[i]) != data[i]) nor_overwrites++;
+    }
+
+    /* Corte: los bytes se programan en orden; el del corte, solo en parte */
+    cut = nor_cut();
+    if (cut) n = (uint16_t)(rng() % length);
+    for (i = 0; i < n; i++) {
+        nor[address + i] &= data[i];
+    }
+    if (cut) {
+        nor[address + n] &= (uint8_t)(data[n] | rng());
+        return SPI_ERR_TIMEOUT;
+    }
+    nor_busy = 1u + rng() % 2u;
+    return SPI_OK;
+}
+
+SPI_Status_t SFLASH_EraseSector(uint32_t address)
+{
+    uint32_t base = address & ~(FLOG_SECTOR_SIZE - 1UL);
+    uint32_t i;
+
+    if (nor_dead || nor_busy) return SPI_ERR_TIMEOUT;
+    if (base >= REGION_SIZE) return SPI_ERR_INVALID;
+
+    /* Corte: cada byte queda con una mezcla de bits borrados y sin borrar */
+    if (nor_cut()) {
+        for (i = 0; i < FLOG_SECTOR_SIZE; i++) {
+            nor[base + i] |= (uint8_t)rng();
+        }
+        return SPI_ERR_TIMEOUT;
+    }
+    memset(&nor[base], 0xFF, FLOG_SECTOR_SIZE);
+    nor_erases[base / FLOG_SECTOR_SIZE]++;
+    nor_busy = 1u + rng() % ERASE_POLLS;
+    return SPI_OK;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Registros de prueba: longitud, tipo y datos se deducen de la marca          */
+/* ------------------------------------------------------------------------- */
+
+static uint8_t *acked;      /* marca confirmada por un FLOG_Flush correcto */
+static uint8_t *seen;       /* veces recuperada en la última comprobación  */
+
+static uint32_t mix(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DUL;
+    x ^= x >> 15;
+    x *= 0x846CA68BUL;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint16_t rec_len(uint32_t stamp)
+{
+    return (uint16_t)(1u + mix(stamp) % FLOG_MAX_PAYLOAD);
+}
+
+static uint8_t rec_type(uint32_t stamp)
+{
+    return (stamp & 1u) ? FLOG_TYPE_Q15 : FLOG_TYPE_ADC;
+}
+
+static void rec_data(uint32_t stamp, uint8_t *out, uint16_t len)
+{
+    uint16_t i;
+    for (i = 0; i < len; i++) {
+        out[i] = (uint8_t)mix(stamp * 251u + i);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Comprobación de la imagen (mismo recorrido que flashlog_extract.c)         */
+/* ------------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t index;
+    FLOG_SectorHdr_t hdr;
+} Sector_t;
+
+static int cmp_seq(const void *a, const void *b)
+{
+    const Sector_t *x = a, *y = b;
+    return (x->hdr.seq > y->hdr.seq) - (x->hdr.seq < y->hdr.seq);
+}
+
+/* Devuelve el número de errores. El sector más antiguo es el que se borra
+ * por adelantado: un corte puede dejarlo a medias, así que lo confirmado se
+ * exige desde el primer registro del siguiente sector */
+static int check_image(uint32_t next_stamp, uint32_t *recovered)
+{
+    Sector_t list[FLOG_SECTOR_COUNT];
+    uint8_t expect[FLOG_MAX_PAYLOAD];
+    uint32_t nvalid = 0, i, s, first = next_stamp, count = 0;
+    int64_t last = -1;
+    int errors = 0;
+
+    memset(seen, 0, MAX_STAMPS);
+    for (i = 0; i < FLOG_SECTOR_COUNT; i++) {
+        if (FLOG_DecodeSectorHdr(&nor[i * FLOG_SECTOR_SIZE], &list[nvalid].hdr)) {
+            list[nvalid].index = i;
+            nvalid++;
+        }
+    }
+    qsort(list, nvalid, sizeof(Sector_t), cmp_seq);
+
+    for (i = 0; i < nvalid; i++) {
+        const uint8_t *sec = &nor[list[i].index * FLOG_SECTOR_SIZE];
+        uint32_t off = FLOG_SECTOR_HDR_SIZE;
+
+        while (off + FLOG_REC_OVERHEAD <= FLOG_SECTOR_SIZE) {
+            FLOG_RecHdr_t rec;
+            const uint8_t *data;
+            uint16_t crc;
+
+            FLOG_DecodeRecHdr(sec + off, &rec);
+            if (rec.len == FLOG_REC_END) break;
+            if (off + FLOG_REC_OVERHEAD + rec.len > FLOG_SECTOR_SIZE) break;
+            data = sec + off + FLOG_REC_HDR_SIZE;
+            crc = FLOG_Crc16(FLOG_CRC_INIT, sec + off, (uint16_t)(FLOG_REC_HDR_SIZE + rec.len));
+            if (crc != (uint16_t)(data[rec.len] | (data[rec.len + 1] << 8))) break;
+
+            if (rec.stamp >= next_stamp || (int64_t)rec.stamp <= last) {
+                printf("  FALLO: marca %u fuera de orden (anterior %lld)\n",
+                       rec.stamp, (long long)last);
+                errors++;
+            } else {
+                rec_data(rec.stamp, expect, rec.len);
+                if (rec.len != rec_len(rec.stamp) || rec.type != rec_type(rec.stamp) ||
+                    memcmp(data, expect, rec.len) != 0) {
+                    printf("  FALLO: registro %u con contenido distinto\n", rec.stamp);
+                    errors++;
+                }
+                seen[rec.stamp]++;
+                if ((i > 0u || nvalid == 1u) && rec.stamp < first) first = rec.stamp;
+                last = rec.stamp;
+                count++;
+            }
+            off += FLOG_REC_OVERHEAD + rec.len;
+        }
+    }
+
+    /* Todo lo confirmado desde el registro más antiguo que se garantiza */
+    for (s = first; s < next_stamp; s++) {
+        if (acked[s] && seen[s] != 1u) {
+            printf("  FALLO: registro confirmado %u recuperado %u veces\n", s, seen[s]);
+            errors++;
+        }
+    }
+    *recovered = count;
+    return errors;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Ciclos: montar, escribir hasta el corte, comprobar                          */
+/* ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+    unsigned cycles = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 500u;
+    uint8_t buf[FLOG_MAX_PAYLOAD];
+    uint32_t next_stamp = 0, ack_mark = 0, total_acked = 0, recovered = 0;
+    uint32_t emin = UINT32_MAX, emax = 0;
+    unsigned c, cuts_mount = 0, i;
+    int errors = 0;
+
+    rng_state = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0x1234567u;
+    if (rng_state == 0u) rng_state = 1u;
+    acked = calloc(MAX_STAMPS, 1);
+    seen = calloc(MAX_STAMPS, 1);
+    if (acked == NULL || seen == NULL) return 1;
+
+    /* Flash recién salida de fábrica */
+    memset(nor, 0xFF, sizeof(nor));
+
+    for (c = 0; c < cycles && next_stamp + 4096u < MAX_STAMPS; c++) {
+        int e;
+
+        nor_dead = false;
+        nor_busy = 0;
+        nor_cut_in = 1u + rng() % CUT_MAX_OPS;
+
+        if (FLOG_Mount() != FLOG_OK) {
+            if (!nor_dead) {
+                printf("ciclo %u: FALLO: FLOG_Mount sin corte\n", c);
+                errors++;
+            }
+            cuts_mount++;
+        } else {
+            while (!nor_dead) {
+                uint32_t stamp = next_stamp;
+                uint16_t len = rec_len(stamp);
+                unsigned k;
+
+                rec_data(stamp, buf, len);
+                if (FLOG_Append(rec_type(stamp), stamp, buf, len) == FLOG_OK) {
+                    next_stamp++;
+                }
+                for (k = rng() % 4u; k > 0u; k--) {
+                    (void)FLOG_Service();
+                }
+                if ((rng() % 64u) == 0u && FLOG_Flush() == FLOG_OK) {
+                    for (; ack_mark < next_stamp; ack_mark++) {
+                        acked[ack_mark] = 1u;
+                        total_acked++;
+                    }
+                }
+            }
+        }
+        ack_mark = next_stamp;      /* lo no confirmado ya no se espera */
+
+        e = check_image(next_stamp, &recovered);
+        if (e != 0) printf("ciclo %u: %d fallos\n", c, e);
+        errors += e;
+    }
+
+    if (nor_overwrites != 0u) {
+        printf("FALLO: %u bytes programados sin borrar\n", nor_overwrites);
+        errors++;
+    }
+    for (i = 0; i < FLOG_SECTOR_COUNT; i++) {
+        if (nor_erases[i] < emin) emin = nor_erases[i];
+        if (nor_erases[i] > emax) emax = nor_erases[i];
+    }
+
+    printf("%u ciclos (%u cortes durante el montaje), %u registros, %u confirmados\n",
+           c, cuts_mount, next_stamp, total_acked);
+    printf("recuperados en la imagen final: %u\n", recovered);
+    printf("borrados por sector: min %u max %u\n", emin, emax);
+    printf("%s (%d fallos)\n", errors ? "ERROR" : "OK", errors);
+
+    free(acked);
+    free(seen);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * main.c - Registro de bloques ADC en flash SPI externa
+ *
+ * Descripción:
+ *  - Timer3 dispara el ADC cada SAMPLE_PERIOD_US; la ISR copia cada bloque
+ *    de 16 muestras de AN0 a un doble buffer.
+ *  - El bucle principal pasa el bloque a Q15, lo filtra con el FIR pasabajo
+ *    de FILTROFIR (lowpassexample.s) en FilterOut y añade al log el bloque
+ *    crudo (FLOG_TYPE_ADC) y el filtrado (FLOG_TYPE_Q15) con la misma marca;
+ *    solo memcpy. FLOG_Service() programa páginas y borra por adelantado.
+ *  - Un corte de alimentación pierde como mucho lo que queda en RAM
+ *    (FLOG_RAM_SIZE = 6 pares de bloques); FLOG_Flush() lo vacía antes de
+ *    apagar. Un borrado más largo que esos ~100 ms descarta bloques
+ *    (FLOG_GetStats().dropped).
+ *
+ * Requisitos:
+ *  - Añade config, irq, pins, pps, board, adc, spi, spiflash, flashlog y
+ *    flashlog_format (.h/.c) y critical.h al proyecto, FILTROFIR/lowpassexample.s y la
+ *    librería DSP (libdsp, dsp.h).
+ *  - Flash NOR SPI (W25Q80 o similar, 1 MB) con CS en RC3.
+ *
+ * Extracción en el PC:
+ *   flashrom -p ch341a_spi -r dump.bin
+ *   flashlog_extract -t 1 dump.bin     (ADC crudo)
+ *   flashlog_extract -t 2 dump.bin     (salida del FIR)
+ */
+
+#include "config.h"
+#include "board.h"
+#include "adc.h"
+#include "spi.h"
+#include "spiflash.h"
+#include "flashlog.h"
+#include <xc.h>
+#include "dsp.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Periodo de muestreo por Timer3 (us) */
+#define SAMPLE_PERIOD_US 1000u
+
+/* Flash de registro: modo 0 a la máxima velocidad del SPI */
+static const SPI_Device_t flash_dev = {
+    .speed = SPI_MAX_CLOCK_HZ,
+    .mode = SPI_MODE_0,
+    .word16 = false,
+    .sample_end = false,
+    .cs_port = BOARD_FLASH_CS_PORT,
+    .cs_bit = BOARD_FLASH_CS_BIT
+};
+
+/* FIR pasabajo de FILTROFIR: coeficientes en X, línea de retardo en Y */
+extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowpassexample.s */
+
+static fractional FilterIn[ADC_BLOCK_LEN];
+static fractional FilterOut[ADC_BLOCK_LEN];
+
+/* Doble buffer ISR -> bucle principal */
+static uint16_t block_buf[2][ADC_BLOCK_LEN];
+static volatile uint8_t block_ready = 0;     /* bit i: buffer i lleno */
+static volatile uint8_t block_write = 0;
+static volatile uint16_t block_lost = 0;
+
+/* Cuentas ADC sin signo -> Q15 centrado en media escala */
+static void block_to_q15(const uint16_t *raw, fractional *out, uint8_t bits)
+{
+    uint8_t i;
+
+    for (i = 0; i < ADC_BLOCK_LEN; i++) {
+        out[i] = (fractional)((uint16_t)(raw[i] << (16u - bits)) ^ 0x8000u);
+    }
+}
+
+/* Bloque de 16 muestras de AN0 (contexto ISR) */
+static void adc_block(const uint16_t *results, uint8_t count)
+{
+    uint8_t i = block_write;
+
+    if (block_ready & (1u << i)) {
+        block_lost++;           /* el bucle principal no dio abasto */
+        return;
+    }
+    memcpy(block_buf[i], results, (size_t)count * sizeof(uint16_t));
+    block_ready |= (uint8_t)(1u << i);
+    block_write = (uint8_t)(i ^ 1u);
+}
+
+int main(void)
+{
+    uint32_t block = 0;
+    uint8_t next = 0;
+
+    SYSTEM_Initialize();
+    BOARD_PinsInit(BOARD_GROUP_POT);
+
+    SPI_Init();
+    SFLASH_Init(&flash_dev);
+    if (FLOG_Mount() != FLOG_OK) {
+        while (1) { Idle(); }   /* sin flash no hay nada que hacer */
+    }
+
+    FIRDelayInit(&lowpassexampleFilter);
+
+    ADC_Init();
+    ADC_EnableTimerTrigger(0, SAMPLE_PERIOD_US, adc_block);
+
+    while (1)
+    {
+        if (block_ready & (1u << next)) {
+            /* El FIR conserva su estado entre bloques: salida continua */
+            block_to_q15(block_buf[next], FilterIn, ADC_GetResolutionBits());
+            FIR(ADC_BLOCK_LEN, FilterOut, FilterIn, &lowpassexampleFilter);
+
+            FLOG_Append(FLOG_TYPE_ADC, block, block_buf[next],
+                        ADC_BLOCK_LEN * sizeof(uint16_t));
+            FLOG_Append(FLOG_TYPE_Q15, block, FilterOut,
+                        ADC_BLOCK_LEN * sizeof(fractional));
+            IEC0bits.AD1IE = 0;
+            block_ready &= (uint8_t)~(1u << next);
+            IEC0bits.AD1IE = 1;
+            next ^= 1u;
+            block++;
+        }
+
+        /* Una operación de flash por vuelta (página o borrado) */
+        FLOG_Service();
+    }
+
+    return 0;
+}
+
+/* Interrupción del ADC: fin de bloque disparado por Timer3 */
+void __attribute__((interrupt, no_auto_psv)) _ADC1Interrupt(void)
+{
+    ADC_ISR_Handler();
+}
+
+/* Interrupción SPI1 (cola de transacciones; el log usa transferencias por sondeo) */
+void __attribute__((interrupt, no_auto_psv)) _SPI1Interrupt(void)
+{
+    SPI_ISR_Handler();
+}
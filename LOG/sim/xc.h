@@ -0,0 +1,19 @@
+/*******************************************************************************
+ * sim/xc.h - Sustituto de xc.h para compilar el log en el PC
+ *
+ * Descripción: flashlog.c solo usa los tipos y prototipos de spi.h y
+ *              spiflash.h, que incluyen <xc.h>. Con -ILOG/sim este fichero
+ *              ocupa su lugar y el modelo de flash (flashlog_powercut.c)
+ *              implementa las funciones SFLASH_*.
+ *
+ * Nota:
+ * - No declara ningún registro: spi.c y spiflash.c no se compilan en el PC.
+ *
+ ******************************************************************************/
+
+#ifndef LOG_SIM_XC_H
+#define LOG_SIM_XC_H
+
+#include <stdint.h>
+
+#endif /* LOG_SIM_XC_H */
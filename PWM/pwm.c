@@ -0,0 +1,208 @@
+/*
+ * pwm.c
+ *
+ * Implementación del driver MCPWM1 para dsPIC33FJ32MC204 (XC16).
+ *
+ * Uso:
+ *  - PWM_Config_t cfg = PWM_CONFIG_DEFAULT; PWM_Init(&cfg);
+ *  - ADC_EnablePwmTrigger(...) para muestrear en el evento especial.
+ *  - PWM_Start() y, en cada periodo, PWM_SetDuties(...) desde el lazo de control.
+ */
+
+#include "pwm.h"
+#include "config.h" /* FCY */
+#include <xc.h>
+
+/* Límites de los registros MCPWM */
+#define PWM_PTPER_MAX      0x7FFFu  /* PTPER<14:0> */
+#define PWM_DTA_MAX        63u      /* DTA<5:0>    */
+
+/* Internals */
+static uint16_t pwm_period = 0;
+static PWM_Trigger_t pwm_trigger = PWM_TRIGGER_NONE;
+
+/* Programa P1SECMP para el punto de disparo y el desplazamiento pedidos */
+static void pwm_write_trigger(int16_t offset)
+{
+    uint16_t cmp = 0;
+    uint16_t dir = 0;   /* SEVTDIR: 0 = coincide contando hacia arriba */
+
+    if (offset > (int16_t)pwm_period)  offset = (int16_t)pwm_period;
+    if (offset < -(int16_t)pwm_period) offset = -(int16_t)pwm_period;
+
+    if (pwm_trigger == PWM_TRIGGER_CENTER_HIGH) {
+        /* Valle de PTMR: antes del centro se cuenta hacia abajo */
+        if (offset >= 0) { cmp = (uint16_t)offset;  dir = 0; }
+        else             { cmp = (uint16_t)-offset; dir = 1; }
+    } else if (pwm_trigger == PWM_TRIGGER_CENTER_LOW) {
+        /* Pico de PTMR: antes del centro se cuenta hacia arriba */
+        if (offset <= 0) { cmp = (uint16_t)(pwm_period + offset); dir = 0; }
+        else             { cmp = (uint16_t)(pwm_period - offset); dir = 1; }
+    }
+
+    #ifdef P1SECMP
+    P1SECMP = (uint16_t)(dir << 15) | (cmp & PWM_PTPER_MAX);
+    #else
+    (void)cmp; (void)dir;
+    #endif
+}
+
+bool PWM_Init(const PWM_Config_t *cfg)
+{
+    static const uint8_t prescalers[4] = { 1u, 4u, 16u, 64u };
+    uint32_t fcy_khz = FCY / 1000UL;
+    uint32_t per = 0, dt = 0;
+    uint8_t ptckps, dtaps;
+    bool ok = true;
+
+    if (cfg == 0 || cfg->freq_hz == 0) return false;
+
+    /* Prescaler más pequeño que deja PTPER en 15 bits (máxima resolución) */
+    for (ptckps = 0; ptckps < 4u; ptckps++) {
+        /* Arriba/abajo: Fpwm = FCY / (2 * (PTPER + 1) * prescaler) */
+        per = FCY / (2UL * cfg->freq_hz * prescalers[ptckps]);
+        per = (per > 0u) ? per - 1u : 0u;
+        if (per <= PWM_PTPER_MAX) break;
+    }
+    if (ptckps == 4u) { ptckps = 3u; per = PWM_PTPER_MAX; ok = false; }
+    if (per < 2u) { per = 2u; ok = false; }
+    pwm_period = (uint16_t)per;
+
+    /* Tiempo muerto: DTA cuentas de (1 << DTAPS) Tcy */
+    for (dtaps = 0; dtaps < 4u; dtaps++) {
+        dt = ((uint32_t)cfg->deadtime_ns * fcy_khz + 999999UL) / 1000000UL;
+        dt = (dt + (1UL << dtaps) - 1u) >> dtaps;
+        if (dt <= PWM_DTA_MAX) break;
+    }
+    if (dtaps == 4u) { dtaps = 3u; dt = PWM_DTA_MAX; ok = false; }
+
+    /* Base de tiempos parada durante la configuración */
+    #ifdef P1TCON
+    P1TCON = 0;
+    P1TCONbits.PTCKPS = ptckps;
+    P1TCONbits.PTMOD = 2;       /* continuo arriba/abajo: PWM centrado */
+    P1TMR = 0;
+    P1TPER = pwm_period;
+    #endif
+
+    /* PWM1CON1: pares habilitados, modo complementario o independiente */
+    #ifdef PWM1CON1
+    {
+        uint16_t con1 = 0;
+        uint8_t pairs = cfg->pairs & PWM_PAIRS_ALL;
+        con1 |= (uint16_t)pairs << 4;       /* PEN1H..PEN3H */
+        con1 |= (uint16_t)pairs;            /* PEN1L..PEN3L */
+        if (!cfg->complementary) {
+            con1 |= (uint16_t)pairs << 8;   /* PMOD1..PMOD3: independiente */
+        }
+        PWM1CON1 = con1;
+    }
+    #endif
+
+    /* PWM1CON2: postescalado del evento especial, actualización al final
+       del periodo (IUE=0) y salidas sincronizadas con PTMR (OSYNC) */
+    #ifdef PWM1CON2
+    PWM1CON2 = 0;
+    PWM1CON2bits.SEVOPS = (cfg->trigger_postscale > 0u && cfg->trigger_postscale <= 16u)
+                          ? (cfg->trigger_postscale - 1u) : 0u;
+    PWM1CON2bits.OSYNC = 1;
+    #endif
+
+    #ifdef P1DTCON1
+    P1DTCON1 = 0;
+    P1DTCON1bits.DTAPS = dtaps;
+    P1DTCON1bits.DTA = (uint8_t)dt;
+    #endif
+
+    /* Fallos deshabilitados: actívalos si el hardware cablea FLTA1 */
+    #ifdef P1FLTACON
+    P1FLTACON = 0;
+    #endif
+
+    /* Salidas controladas por el generador PWM (sin override) */
+    #ifdef P1OVDCON
+    P1OVDCON = 0x3F00;
+    #endif
+
+    #ifdef P1DC1
+    P1DC1 = pwm_period;  /* 50 % */
+    P1DC2 = pwm_period;
+    P1DC3 = pwm_period;
+    #endif
+
+    pwm_trigger = cfg->adc_trigger;
+    pwm_write_trigger(0);
+
+    return ok;
+}
+
+void PWM_Start(void)
+{
+    #ifdef P1TCON
+    P1TCONbits.PTEN = 1;
+    #endif
+}
+
+void PWM_Stop(void)
+{
+    #ifdef P1TCON
+    P1TCONbits.PTEN = 0;
+    #endif
+}
+
+void PWM_SetDuty(uint8_t pair, uint16_t duty)
+{
+    uint32_t max = PWM_GetDutyMax();
+    if (duty > max) duty = (uint16_t)max;
+
+    #ifdef P1DC1
+    switch (pair) {
+        case 1: P1DC1 = duty; break;
+        case 2: P1DC2 = duty; break;
+        case 3: P1DC3 = duty; break;
+        default: break;
+    }
+    #else
+    (void)pair;
+    #endif
+}
+
+/* Actualiza los tres pares con UDIS para que el hardware los aplique
+   juntos en el siguiente límite de periodo */
+void PWM_SetDuties(uint16_t d1, uint16_t d2, uint16_t d3)
+{
+    uint32_t max = PWM_GetDutyMax();
+    if (d1 > max) d1 = (uint16_t)max;
+    if (d2 > max) d2 = (uint16_t)max;
+    if (d3 > max) d3 = (uint16_t)max;
+
+    #ifdef PWM1CON2
+    PWM1CON2bits.UDIS = 1;
+    #endif
+    #ifdef P1DC1
+    P1DC1 = d1;
+    P1DC2 = d2;
+    P1DC3 = d3;
+    #endif
+    #ifdef PWM1CON2
+    PWM1CON2bits.UDIS = 0;
+    #endif
+}
+
+void PWM_SetTriggerOffset(int16_t offset)
+{
+    pwm_write_trigger(offset);
+}
+
+uint16_t PWM_GetPeriod(void)
+{
+    return pwm_period;
+}
+
+/* En modo centrado el periodo son 2 * (PTPER + 1) medios ciclos de Tcy:
+   duty = 2 * (PTPER + 1) mantiene la salida activa todo el periodo.
+   Con PTPER = 0x7FFF vale 65536 y P1DCx (16 bits) se queda en 0xFFFF */
+uint32_t PWM_GetDutyMax(void)
+{
+    return 2u * ((uint32_t)pwm_period + 1u);
+}
@@ -0,0 +1,85 @@
+/*
+ * pwm.h
+ *
+ * Driver del PWM de control de motores (MCPWM1) para dsPIC33FJ32MC204 con XC16
+ *
+ * API:
+ *   bool PWM_Init(const PWM_Config_t *cfg);         // configura periodo, dead-time, pares y disparo ADC
+ *   void PWM_Start(void) / PWM_Stop(void);          // arranca / para la base de tiempos
+ *   void PWM_SetDuty(uint8_t pair, uint16_t duty);  // duty de un par (1..3) en cuentas
+ *   void PWM_SetDuties(d1, d2, d3);                 // los tres pares en el mismo periodo
+ *   uint32_t PWM_GetDutyMax(void);                  // duty 100 % (resolución Tcy/2)
+ *
+ * Nota:
+ * - Modo centrado (PTMOD=10, cuenta arriba/abajo): Fpwm = FCY / (2 * (PTPER + 1) * prescaler).
+ * - El evento especial (SEVTCMP) dispara el ADC sin intervención de la CPU
+ *   (ver ADC_EnablePwmTrigger en adc.h).
+ * - Los pragmas LPOL/HPOL/PWMPIN (FPOR) fijan la polaridad y que los pines
+ *   arranquen controlados por PORT: PWM_Init los cede al módulo (PENxH/L).
+ */
+
+#ifndef PWM_H
+#define PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Punto del periodo en que se genera el evento especial para el ADC */
+typedef enum {
+    PWM_TRIGGER_NONE = 0,     /* sin disparo ADC                               */
+    PWM_TRIGGER_CENTER_HIGH,  /* PTMR = 0: centro del pulso de lado alto        */
+    PWM_TRIGGER_CENTER_LOW    /* PTMR = PTPER: centro del pulso de lado bajo
+                                 (todas las ramas bajas ON: shunts de corriente) */
+} PWM_Trigger_t;
+
+/* Pares de salida (PWM1H/L1..3) */
+#define PWM_PAIR1   0x01u
+#define PWM_PAIR2   0x02u
+#define PWM_PAIR3   0x04u
+#define PWM_PAIRS_ALL (PWM_PAIR1 | PWM_PAIR2 | PWM_PAIR3)
+
+typedef struct {
+    uint32_t freq_hz;          /* frecuencia PWM (centrada)                     */
+    uint16_t deadtime_ns;      /* tiempo muerto entre H y L                      */
+    uint8_t  pairs;            /* máscara PWM_PAIRx habilitada                   */
+    bool     complementary;    /* true: H/L complementarios; false: independientes */
+    PWM_Trigger_t adc_trigger; /* punto de disparo del ADC                       */
+    uint8_t  trigger_postscale;/* disparo cada N periodos (1..16, SEVOPS)        */
+} PWM_Config_t;
+
+/* Configuración por defecto: 20 kHz, 1 us de tiempo muerto, inversor trifásico,
+   disparo del ADC en el centro del pulso bajo */
+#define PWM_CONFIG_DEFAULT { \
+    .freq_hz = 20000UL, \
+    .deadtime_ns = 1000u, \
+    .pairs = PWM_PAIRS_ALL, \
+    .complementary = true, \
+    .adc_trigger = PWM_TRIGGER_CENTER_LOW, \
+    .trigger_postscale = 1u \
+}
+
+/* Devuelve false si la frecuencia o el tiempo muerto no son alcanzables */
+bool PWM_Init(const PWM_Config_t *cfg);
+void PWM_Start(void);
+void PWM_Stop(void);
+
+/* Duty en cuentas 0..PWM_GetDutyMax() */
+void PWM_SetDuty(uint8_t pair, uint16_t duty);
+void PWM_SetDuties(uint16_t d1, uint16_t d2, uint16_t d3);
+
+/* Desplaza el disparo del ADC 'offset' cuentas de PTMR respecto al centro
+   (compensa retardos del driver de puerta / filtro de la medida) */
+void PWM_SetTriggerOffset(int16_t offset);
+
+uint16_t PWM_GetPeriod(void);  /* PTPER */
+uint32_t PWM_GetDutyMax(void); /* 2 * (PTPER + 1) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_H */
@@ -0,0 +1,72 @@
+/*
+ * main.c - Ejemplo de PWM de control de motores con muestreo ADC sincronizado
+ *
+ * Descripción:
+ *  - MCPWM1 a 20 kHz centrado, tres pares complementarios con 1 us de tiempo muerto.
+ *  - ADC en 10-bit con CH1..CH3 = AN0..AN2 (corrientes de fase) y CH0 = AN3
+ *    (potenciómetro de consigna), muestreados en el mismo instante.
+ *  - El evento especial del PWM (centro del pulso bajo) lanza la conversión;
+ *    la ISR del ADC aplica el nuevo duty en el mismo periodo.
+ *
+ * Requisitos:
+ *  - Añade config.h/config.c, irq.h/irq.c, critical.h, adc.h/adc.c,
+ *    pwm.h/pwm.c, pins.h/pins.c, pps.h/pps.c y board.h/board.c al
+ *    proyecto (SYSTEM_Initialize aplica la tabla PPS de board.c).
+ */
+
+#include "config.h"
+#include "adc.h"
+#include "pwm.h"
+#include "board.h"
+#include <xc.h>
+#include <stdint.h>
+
+/* Últimas corrientes de fase (cuentas ADC, 10-bit) */
+static volatile uint16_t phase_current[3];
+
+/* Lazo de control: se ejecuta en la ISR del ADC, una vez por periodo PWM */
+static void control_loop(const uint16_t *results, uint8_t count)
+{
+    uint32_t duty;
+
+    if (count < ADC_SIM_CHANNELS) return;
+
+    phase_current[0] = results[1];   /* CH1 = AN0 */
+    phase_current[1] = results[2];   /* CH2 = AN1 */
+    phase_current[2] = results[3];   /* CH3 = AN2 */
+
+    /* Consigna de duty proporcional al potenciómetro (CH0 = AN3) */
+    duty = ((uint32_t)results[0] * PWM_GetDutyMax()) / ADC_MAX_VALUE_10BIT;
+    if (duty > 0xFFFFu) duty = 0xFFFFu;     /* PTPER = 0x7FFF: 100 % = 65536 */
+    PWM_SetDuties((uint16_t)duty, (uint16_t)duty, (uint16_t)duty);
+}
+
+int main(void)
+{
+    PWM_Config_t pwm_cfg = PWM_CONFIG_DEFAULT;
+
+    SYSTEM_Initialize();
+    BOARD_PinsInit(BOARD_VARIANT_MOTOR);    /* AN0..AN3 analógicos */
+
+    /* ADC: 4 S&H simultáneos, disparo desde el PWM */
+    ADC_Init();
+    ADC_SetMode(ADC_MODE_10BIT_SIM4);
+    ADC_EnablePwmTrigger(3, ADC_CH123_AN0_AN2, control_loop);
+
+    /* PWM: el evento especial queda programado por PWM_Init */
+    PWM_Init(&pwm_cfg);
+    PWM_Start();
+
+    while (1)
+    {
+        /* Todo el trabajo ocurre en la ISR del ADC */
+    }
+
+    return 0;
+}
+
+/* Interrupción del ADC: fin de la secuencia disparada por el PWM */
+void __attribute__((interrupt, no_auto_psv)) _ADC1Interrupt(void)
+{
+    ADC_ISR_Handler();
+}
@@ -0,0 +1,427 @@
+/*******************************************************************************
+ * spi.c - Implementación de la librería SPI (maestro) para dsPIC33FJ32MC204
+ * 
+ * Transferencias bloqueantes por sondeo y cola de transacciones servida
+ * por la interrupción SPI1 (una interrupción por palabra).
+ * 
+ ******************************************************************************/
+
+#include "spi.h"
+#include "config.h"
+#include "board.h"
+#include "irq.h"
+#include <string.h>
+
+// Bits de SPI1STAT
+#define SPI_STAT_SPIEN     (1u << 15)
+#define SPI_STAT_SPIROV    (1u << 6)
+#define SPI_STAT_SPIRBF    (1u << 0)
+
+// Bits de SPI1CON1
+#define SPI_CON1_MODE16    (1u << 10)
+#define SPI_CON1_SMP       (1u << 9)
+#define SPI_CON1_CKE       (1u << 8)
+#define SPI_CON1_CKP       (1u << 6)
+#define SPI_CON1_MSTEN     (1u << 5)
+
+// =============================================================================
+// VARIABLES GLOBALES
+// =============================================================================
+
+static const SPI_Device_t *spi_current = NULL;   // Dispositivo configurado
+static uint32_t spi_clock = 0;                   // SCK real del dispositivo actual
+static uint16_t spi_word_spins = 0;              // Límite de espera por palabra
+
+// Cola de transacciones (punteros a memoria del llamador)
+static SPI_Transaction_t *spi_queue[SPI_QUEUE_LEN];
+static uint8_t spi_queue_head = 0;
+static uint8_t spi_queue_count = 0;
+
+// Transacción en curso (ISR)
+static SPI_Transaction_t *volatile spi_active = NULL;
+static uint16_t spi_index = 0;
+
+// Dispositivo con el CS retenido por SPI_TransferHold (release = false):
+// la cola no arranca nada hasta que se libere
+static const SPI_Device_t *volatile spi_held = NULL;
+
+static volatile uint16_t spi_overruns = 0;
+
+// =============================================================================
+// FUNCIONES PRIVADAS
+// =============================================================================
+
+/**
+ * @brief Puntero al LATx del chip select
+ */
+static volatile uint16_t* _SPI_GetLat(uint8_t port) {
+    switch(port) {
+        #ifdef LATA
+        case PIN_PORT_A: return &LATA;
+        #endif
+        #ifdef LATB
+        case PIN_PORT_B: return &LATB;
+        #endif
+        #ifdef LATC
+        case PIN_PORT_C: return &LATC;
+        #endif
+        default: return NULL;
+    }
+}
+
+/**
+ * @brief Aplica modo, tamaño de palabra y reloj del dispositivo
+ */
+static void _SPI_Configure(const SPI_Device_t *device) {
+    uint8_t ppre, spre;
+    uint16_t con1 = SPI_CON1_MSTEN;
+
+    if (device == spi_current) return;
+
+    spi_clock = SPI_CalculateClock(FCY, device->speed, &ppre, &spre);
+    con1 |= (uint16_t)((spre << 2) | ppre);
+
+    // CKP = CPOL; CKE = !CPHA (el dato cambia al pasar de activo a reposo)
+    if (device->mode == SPI_MODE_2 || device->mode == SPI_MODE_3) con1 |= SPI_CON1_CKP;
+    if (device->mode == SPI_MODE_0 || device->mode == SPI_MODE_2) con1 |= SPI_CON1_CKE;
+    if (device->word16) con1 |= SPI_CON1_MODE16;
+    if (device->sample_end) con1 |= SPI_CON1_SMP;
+
+    // Espera máxima por palabra: ciclos de SCK * bits, con margen
+    spi_word_spins = (uint16_t)((FCY / spi_clock) * (device->word16 ? 16u : 8u) + 64u);
+
+    // Los bits de CON1 solo se pueden cambiar con el módulo parado
+    SPI1STAT = 0;
+    SPI1CON1 = con1;
+    SPI1CON2 = 0;
+    SPI1STAT = SPI_STAT_SPIEN;
+
+    spi_current = device;
+}
+
+/**
+ * @brief Palabra a transmitir en la posición 'index'
+ */
+static uint16_t _SPI_TxWord(const uint8_t *tx, uint16_t index, bool word16) {
+    if (tx == NULL) {
+        return word16 ? (uint16_t)((SPI_DUMMY_BYTE << 8) | SPI_DUMMY_BYTE) : SPI_DUMMY_BYTE;
+    }
+    // En 16 bits se transmite primero el MSB: mismo orden de bytes en el bus
+    return word16 ? (uint16_t)(((uint16_t)tx[index] << 8) | tx[index + 1]) : tx[index];
+}
+
+/**
+ * @brief Guarda la palabra recibida en la posición 'index'
+ */
+static void _SPI_RxWord(uint8_t *rx, uint16_t index, uint16_t word, bool word16) {
+    if (rx == NULL) return;
+    if (word16) {
+        rx[index] = (uint8_t)(word >> 8);
+        rx[index + 1] = (uint8_t)word;
+    } else {
+        rx[index] = (uint8_t)word;
+    }
+}
+
+/**
+ * @brief Comprueba parámetros de una transferencia
+ */
+static bool _SPI_Valid(const SPI_Device_t *device, uint16_t length) {
+    if (device == NULL || length == 0) return false;
+    if (device->word16 && (length & 1u)) return false;
+    return _SPI_GetLat(device->cs_port) != NULL;
+}
+
+/**
+ * @brief Arranca la siguiente transacción de la cola (contexto ISR o SPI1IE = 0)
+ */
+static void _SPI_StartNext(void) {
+    SPI_Transaction_t *t;
+
+    if (spi_queue_count == 0 || spi_held != NULL) {
+        spi_active = NULL;
+        return;
+    }
+    t = spi_queue[spi_queue_head];
+    spi_queue_head = (uint8_t)((spi_queue_head + 1u) % SPI_QUEUE_LEN);
+    spi_queue_count--;
+
+    _SPI_Configure(t->device);
+    SPI_Select(t->device);
+    spi_index = 0;
+    spi_active = t;
+    SPI1BUF = _SPI_TxWord(t->tx, 0, t->device->word16);
+}
+
+/**
+ * @brief Cierra la transacción activa y lanza la siguiente
+ */
+static void _SPI_Finish(SPI_Transaction_t *t, SPI_Status_t status) {
+    if (!t->keep_cs) SPI_Deselect(t->device);
+    t->status = status;
+    spi_active = NULL;
+    if (t->callback != NULL) t->callback(t);
+    if (spi_active == NULL) _SPI_StartNext();   // el callback pudo encolar
+}
+
+// =============================================================================
+// FUNCIONES PÚBLICAS
+// =============================================================================
+
+/**
+ * @brief Inicializa SPI1 como maestro (requiere los remapeos PPS de SYSTEM_Initialize)
+ */
+void SPI_Init(void) {
+    // Pines: SCK/SDO salidas, SDI entrada, CS a nivel alto
+    BOARD_PinsInit(BOARD_VARIANT_SPI);
+
+    SPI1STAT = 0;
+    spi_current = NULL;
+    spi_active = NULL;
+    spi_queue_head = 0;
+    spi_queue_count = 0;
+    spi_overruns = 0;
+
+    // Interrupción: fin de palabra (SPIRBF)
+    IFS0bits.SPI1IF = 0;
+    IRQ_SetPriority(IRQ_SRC_SPI1);
+    IEC0bits.SPI1IE = 1;
+}
+
+/**
+ * @brief Detiene el módulo y descarta la cola
+ */
+void SPI_Deinit(void) {
+    IEC0bits.SPI1IE = 0;
+    if (spi_active != NULL) SPI_Deselect(spi_active->device);
+    while (spi_queue_count > 0) {
+        spi_queue[spi_queue_head]->status = SPI_ERR_INVALID;
+        spi_queue_head = (uint8_t)((spi_queue_head + 1u) % SPI_QUEUE_LEN);
+        spi_queue_count--;
+    }
+    if (spi_active != NULL) spi_active->status = SPI_ERR_INVALID;
+    spi_active = NULL;
+    if (spi_held != NULL) SPI_Deselect(spi_held);
+    spi_held = NULL;
+    SPI1STAT = 0;
+    spi_current = NULL;
+}
+
+/**
+ * @brief Calcula los preescaladores para el SCK más rápido <= desired_speed
+ * @return Frecuencia SCK resultante (Hz)
+ */
+uint32_t SPI_CalculateClock(uint32_t fcy, uint32_t desired_speed, uint8_t *ppre, uint8_t *spre) {
+    // PPRE: 3 -> 1:1, 2 -> 4:1, 1 -> 16:1, 0 -> 64:1; SPRE: 7 -> 1:1 ... 0 -> 8:1
+    static const uint8_t primary[4] = { 64, 16, 4, 1 };
+    uint32_t limit = desired_speed < SPI_MAX_CLOCK_HZ ? desired_speed : SPI_MAX_CLOCK_HZ;
+    uint32_t best = 0;
+    uint8_t best_p = 0, best_s = 0;   // 64:1 * 8:1, el más lento
+    uint8_t p, s;
+
+    for (p = 0; p < 4; p++) {
+        for (s = 0; s < 8; s++) {
+            uint16_t div = (uint16_t)(primary[p] * (8u - s));
+            uint32_t f = fcy / div;
+            if (div == 1) continue;              // 1:1 y 1:1 no está permitido
+            if (f <= limit && f > best) {
+                best = f;
+                best_p = p;
+                best_s = s;
+            }
+        }
+    }
+    if (best == 0) best = fcy / 512u;
+
+    *ppre = best_p;
+    *spre = best_s;
+    return best;
+}
+
+/**
+ * @brief Transferencia full-duplex bloqueante con gestión de CS
+ */
+SPI_Status_t SPI_Transfer(const SPI_Device_t *device, const uint8_t *tx, uint8_t *rx, uint16_t length) {
+    return SPI_TransferHold(device, tx, rx, length, true);
+}
+
+/**
+ * @brief Transferencia bloqueante; con release = false el CS queda activo
+ *        para continuar la trama con otra llamada (comando + datos)
+ *
+ * Mientras el CS está retenido la cola no arranca transacciones (se
+ * encolan y esperan) y solo el mismo dispositivo puede continuar la trama.
+ */
+SPI_Status_t SPI_TransferHold(const SPI_Device_t *device, const uint8_t *tx, uint8_t *rx,
+                              uint16_t length, bool release) {
+    SPI_Status_t status = SPI_OK;
+    bool word16, ie;
+    uint16_t step, i;
+
+    if (!_SPI_Valid(device, length)) return SPI_ERR_INVALID;
+
+    // Sin interrupción durante el sondeo: la ISR no debe leer SPI1BUF
+    ie = IEC0bits.SPI1IE;
+    IEC0bits.SPI1IE = 0;
+
+    // Continuación de una trama retenida, o bus libre
+    if (spi_held != NULL ? spi_held != device : !SPI_IsIdle()) {
+        IEC0bits.SPI1IE = ie;
+        return SPI_ERR_BUSY;
+    }
+
+    _SPI_Configure(device);
+    word16 = device->word16;
+    step = word16 ? 2u : 1u;
+
+    SPI_Select(device);
+    for (i = 0; i < length; i += step) {
+        uint16_t spins = spi_word_spins;
+
+        SPI1BUF = _SPI_TxWord(tx, i, word16);
+        while (!(SPI1STAT & SPI_STAT_SPIRBF) && --spins) {
+            // Esperar fin de palabra
+        }
+        if (spins == 0) {
+            status = SPI_ERR_TIMEOUT;
+            break;
+        }
+        _SPI_RxWord(rx, i, SPI1BUF, word16);
+    }
+    if (SPI1STAT & SPI_STAT_SPIROV) {
+        SPI1STAT &= (uint16_t)~SPI_STAT_SPIROV;
+        spi_overruns++;
+        status = SPI_ERR_OVERRUN;
+    }
+    if (release || status != SPI_OK) {
+        SPI_Deselect(device);
+        spi_held = NULL;
+    } else {
+        spi_held = device;
+    }
+
+    // En sondeo la bandera de interrupción también se activa: descartarla
+    IFS0bits.SPI1IF = 0;
+
+    // Lo encolado mientras el CS estaba retenido arranca ahora
+    if (spi_held == NULL && spi_active == NULL) _SPI_StartNext();
+    IEC0bits.SPI1IE = ie;
+    return status;
+}
+
+/**
+ * @brief Escritura bloqueante (lo recibido se descarta)
+ */
+SPI_Status_t SPI_Write(const SPI_Device_t *device, const uint8_t *data, uint16_t length) {
+    return SPI_Transfer(device, data, NULL, length);
+}
+
+/**
+ * @brief Lectura bloqueante (transmite SPI_DUMMY_BYTE)
+ */
+SPI_Status_t SPI_Read(const SPI_Device_t *device, uint8_t *buffer, uint16_t length) {
+    return SPI_Transfer(device, NULL, buffer, length);
+}
+
+/**
+ * @brief Encola una transacción asíncrona
+ */
+SPI_Status_t SPI_Submit(SPI_Transaction_t *t) {
+    SPI_Status_t status = SPI_PENDING;
+    bool ie;
+
+    if (t == NULL || !_SPI_Valid(t->device, t->length)) return SPI_ERR_INVALID;
+
+    ie = IEC0bits.SPI1IE;
+    IEC0bits.SPI1IE = 0;
+    if (spi_queue_count >= SPI_QUEUE_LEN) {
+        status = SPI_ERR_BUSY;
+    } else {
+        t->status = SPI_PENDING;
+        spi_queue[(spi_queue_head + spi_queue_count) % SPI_QUEUE_LEN] = t;
+        spi_queue_count++;
+        if (spi_active == NULL) _SPI_StartNext();
+    }
+    IEC0bits.SPI1IE = ie;
+    return status;
+}
+
+/**
+ * @brief true si no hay transacciones en curso ni en cola ni CS retenido
+ */
+bool SPI_IsIdle(void) {
+    return spi_active == NULL && spi_queue_count == 0 && spi_held == NULL;
+}
+
+/**
+ * @brief Espera a que termine una transacción encolada
+ */
+SPI_Status_t SPI_WaitTransaction(SPI_Transaction_t *t, uint16_t timeout_ms) {
+    uint32_t timeout_counter = (uint32_t)timeout_ms * 1000;  // Aproximado
+
+    while (t->status == SPI_PENDING && timeout_counter--) {
+        // Esperar activamente
+    }
+    return (t->status == SPI_PENDING) ? SPI_ERR_TIMEOUT : t->status;
+}
+
+/**
+ * @brief Activa el chip select (nivel bajo)
+ */
+void SPI_Select(const SPI_Device_t *device) {
+    volatile uint16_t* lat = _SPI_GetLat(device->cs_port);
+    if (lat != NULL) *lat &= (uint16_t)~(1u << device->cs_bit);
+}
+
+/**
+ * @brief Libera el chip select (nivel alto)
+ */
+void SPI_Deselect(const SPI_Device_t *device) {
+    volatile uint16_t* lat = _SPI_GetLat(device->cs_port);
+    if (lat != NULL) *lat |= (uint16_t)(1u << device->cs_bit);
+}
+
+/**
+ * @brief Número de overruns (SPIROV) detectados
+ */
+uint16_t SPI_GetOverrunCount(void) {
+    return spi_overruns;
+}
+
+/**
+ * @brief SCK real del último dispositivo configurado (Hz)
+ */
+uint32_t SPI_GetClock(void) {
+    return spi_clock;
+}
+
+/**
+ * @brief Handler de interrupción SPI1: una palabra completada
+ */
+void SPI_ISR_Handler(void) {
+    SPI_Transaction_t *t = spi_active;
+    uint16_t word;
+    bool word16;
+
+    IFS0bits.SPI1IF = 0;  // Limpiar flag
+    word = SPI1BUF;       // Leer siempre: libera SPIRBF
+
+    if (t == NULL) return;
+    word16 = t->device->word16;
+
+    if (SPI1STAT & SPI_STAT_SPIROV) {
+        SPI1STAT &= (uint16_t)~SPI_STAT_SPIROV;
+        spi_overruns++;
+        _SPI_Finish(t, SPI_ERR_OVERRUN);
+        return;
+    }
+
+    _SPI_RxWord(t->rx, spi_index, word, word16);
+    spi_index += word16 ? 2u : 1u;
+
+    if (spi_index < t->length) {
+        SPI1BUF = _SPI_TxWord(t->tx, spi_index, word16);
+    } else {
+        _SPI_Finish(t, SPI_OK);
+    }
+}
@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * spi.h - Librería SPI (maestro) para dsPIC33FJ32MC204
+ * 
+ * Descripción: Driver del módulo SPI1 en modo maestro para convertidores
+ *              externos (ADC/DAC) y memorias flash, con transferencias
+ *              bloqueantes y una cola de transacciones servida por la ISR.
+ * 
+ * Características:
+ * - Maestro, modos SPI 0..3, palabras de 8 o 16 bits
+ * - Reloj hasta SPI_MAX_CLOCK_HZ (10 MHz a 40 MIPS)
+ * - Chip select por GPIO gestionado por el driver (por dispositivo)
+ * - Transferencias bloqueantes (sondeo) y asíncronas (cola + ISR)
+ * - Detección de overrun (SPIROV)
+ * 
+ * Nota:
+ * - Esta familia no tiene DMA ni el buffer mejorado (FIFO de 8 niveles) de
+ *   los dsPIC33E/EP: el módulo tiene un único buffer. Por eso:
+ *     * bloques cortos o a 10 MHz -> SPI_Transfer (sondeo, sin sobrecoste
+ *       de interrupción por palabra);
+ *     * bloques largos a menor velocidad -> SPI_Submit (una interrupción
+ *       por palabra; el modo de 16 bits reduce las interrupciones a la mitad).
+ * - Pines (board.c): SCK1 RP22/RC6, SDO1 RP23/RC7, SDI1 RP24/RC8, CS RC9.
+ * 
+ ******************************************************************************/
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// =============================================================================
+// DEFINICIONES DE CONFIGURACIÓN
+// =============================================================================
+
+// Reloj SCK máximo en modo maestro (parámetro SP10 del datasheet)
+#define SPI_MAX_CLOCK_HZ        10000000UL
+
+// Transacciones pendientes admitidas en la cola
+#define SPI_QUEUE_LEN           8u
+
+// Byte transmitido cuando no hay buffer de transmisión
+#define SPI_DUMMY_BYTE          0xFFu
+
+// Modos SPI (CPOL, CPHA)
+typedef enum {
+    SPI_MODE_0 = 0,   // CPOL = 0, CPHA = 0
+    SPI_MODE_1 = 1,   // CPOL = 0, CPHA = 1
+    SPI_MODE_2 = 2,   // CPOL = 1, CPHA = 0
+    SPI_MODE_3 = 3    // CPOL = 1, CPHA = 1
+} SPI_Mode_t;
+
+// Estado de una transferencia
+typedef enum {
+    SPI_OK = 0,           // Completada
+    SPI_PENDING,          // En cola o en curso
+    SPI_ERR_BUSY,         // Cola llena o bus ocupado por la cola
+    SPI_ERR_TIMEOUT,      // Timeout en transferencia bloqueante
+    SPI_ERR_OVERRUN,      // SPIROV: se perdió una palabra recibida
+    SPI_ERR_INVALID       // Parámetros no válidos
+} SPI_Status_t;
+
+// Descripción de un dispositivo esclavo
+typedef struct {
+    uint32_t speed;       // Reloj SCK deseado (Hz), se redondea hacia abajo (mín. FCY/512)
+    SPI_Mode_t mode;      // Modo SPI
+    bool word16;          // Palabras de 16 bits (longitudes pares)
+    bool sample_end;      // SMP = 1: muestrear al final del bit
+    uint8_t cs_port;      // Puerto del chip select (PIN_Port_t de pins.h)
+    uint8_t cs_bit;       // Bit del chip select (activo a nivel bajo)
+} SPI_Device_t;
+
+struct SPI_Transaction;
+typedef void (*SPI_Callback_t)(struct SPI_Transaction *t);
+
+// Transacción asíncrona (memoria del llamador hasta que termina)
+typedef struct SPI_Transaction {
+    const SPI_Device_t *device;       // Dispositivo destino
+    const uint8_t *tx;                // Datos a enviar (NULL -> SPI_DUMMY_BYTE)
+    uint8_t *rx;                      // Datos recibidos (NULL -> se descartan)
+    uint16_t length;                  // Longitud en bytes
+    bool keep_cs;                     // No liberar CS al terminar (encadenar)
+    SPI_Callback_t callback;          // Llamado desde la ISR al terminar
+    volatile SPI_Status_t status;     // SPI_PENDING hasta que termina
+} SPI_Transaction_t;
+
+// =============================================================================
+// PROTOTIPOS DE FUNCIONES
+// =============================================================================
+
+// Inicialización y configuración
+void SPI_Init(void);
+void SPI_Deinit(void);
+uint32_t SPI_CalculateClock(uint32_t fcy, uint32_t desired_speed, uint8_t *ppre, uint8_t *spre);
+
+// Transferencias bloqueantes (fallan con SPI_ERR_BUSY si la cola está activa).
+// Con release = false el CS queda retenido: la cola no arranca nada y solo
+// ese dispositivo puede continuar hasta una llamada con release = true.
+SPI_Status_t SPI_Transfer(const SPI_Device_t *device, const uint8_t *tx, uint8_t *rx, uint16_t length);
+SPI_Status_t SPI_TransferHold(const SPI_Device_t *device, const uint8_t *tx, uint8_t *rx,
+                              uint16_t length, bool release);
+SPI_Status_t SPI_Write(const SPI_Device_t *device, const uint8_t *data, uint16_t length);
+SPI_Status_t SPI_Read(const SPI_Device_t *device, uint8_t *buffer, uint16_t length);
+
+// Cola de transacciones
+SPI_Status_t SPI_Submit(SPI_Transaction_t *t);
+bool SPI_IsIdle(void);
+SPI_Status_t SPI_WaitTransaction(SPI_Transaction_t *t, uint16_t timeout_ms);
+
+// Chip select manual (para secuencias comando + datos con keep_cs)
+void SPI_Select(const SPI_Device_t *device);
+void SPI_Deselect(const SPI_Device_t *device);
+
+// Errores y diagnóstico
+uint16_t SPI_GetOverrunCount(void);
+uint32_t SPI_GetClock(void);
+
+// Interrupción
+void SPI_ISR_Handler(void);
+
+#endif /* SPI_H */
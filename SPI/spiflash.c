@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * spiflash.c - Implementación de la memoria flash NOR SPI (ver spiflash.h)
+ * 
+ ******************************************************************************/
+
+#include "spiflash.h"
+#include <stddef.h>
+
+static const SPI_Device_t *sflash_dev = NULL;
+
+// =============================================================================
+// FUNCIONES PRIVADAS
+// =============================================================================
+
+/**
+ * @brief Envía un comando con dirección de 24 bits y deja el CS activo
+ */
+static SPI_Status_t _SFLASH_Command(uint8_t cmd, uint32_t address) {
+    uint8_t hdr[4];
+
+    hdr[0] = cmd;
+    hdr[1] = (uint8_t)(address >> 16);
+    hdr[2] = (uint8_t)(address >> 8);
+    hdr[3] = (uint8_t)address;
+    return SPI_TransferHold(sflash_dev, hdr, NULL, 4, false);
+}
+
+/**
+ * @brief Write enable (necesario antes de programar o borrar)
+ */
+static SPI_Status_t _SFLASH_WriteEnable(void) {
+    uint8_t cmd = SFLASH_CMD_WREN;
+    return SPI_Transfer(sflash_dev, &cmd, NULL, 1);
+}
+
+// =============================================================================
+// FUNCIONES PÚBLICAS
+// =============================================================================
+
+/**
+ * @brief Asocia la flash a un dispositivo SPI (modo 0, 8 bits)
+ */
+void SFLASH_Init(const SPI_Device_t *device) {
+    sflash_dev = device;
+}
+
+/**
+ * @brief Identificador JEDEC (fabricante << 16 | tipo << 8 | capacidad)
+ */
+uint32_t SFLASH_ReadId(void) {
+    uint8_t tx[4] = { SFLASH_CMD_JEDEC_ID, 0, 0, 0 };
+    uint8_t rx[4];
+
+    if (SPI_Transfer(sflash_dev, tx, rx, 4) != SPI_OK) return 0;
+    return ((uint32_t)rx[1] << 16) | ((uint32_t)rx[2] << 8) | rx[3];
+}
+
+/**
+ * @brief Registro de estado 1
+ */
+uint8_t SFLASH_ReadStatus(void) {
+    uint8_t tx[2] = { SFLASH_CMD_RDSR, 0 };
+    uint8_t rx[2] = { 0, SFLASH_SR_BUSY };
+
+    SPI_Transfer(sflash_dev, tx, rx, 2);
+    return rx[1];
+}
+
+/**
+ * @brief true mientras hay una programación o borrado en curso
+ */
+bool SFLASH_IsBusy(void) {
+    return (SFLASH_ReadStatus() & SFLASH_SR_BUSY) != 0;
+}
+
+/**
+ * @brief Espera a que termine la operación en curso
+ */
+bool SFLASH_WaitReady(uint16_t timeout_ms) {
+    uint32_t timeout_counter = (uint32_t)timeout_ms * 100;  // Aproximado (~10 us por consulta)
+
+    while (SFLASH_IsBusy()) {
+        if (timeout_counter-- == 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lectura continua desde 'address'
+ */
+SPI_Status_t SFLASH_Read(uint32_t address, uint8_t *buffer, uint16_t length) {
+    SPI_Status_t st = _SFLASH_Command(SFLASH_CMD_READ, address);
+
+    if (st != SPI_OK) return st;
+    return SPI_TransferHold(sflash_dev, NULL, buffer, length, true);
+}
+
+/**
+ * @brief Lanza la programación de hasta una página (no espera a que termine)
+ */
+SPI_Status_t SFLASH_ProgramPage(uint32_t address, const uint8_t *data, uint16_t length) {
+    SPI_Status_t st;
+
+    if (length == 0 || ((address % SFLASH_PAGE_SIZE) + length) > SFLASH_PAGE_SIZE) {
+        return SPI_ERR_INVALID;
+    }
+    st = _SFLASH_WriteEnable();
+    if (st == SPI_OK) st = _SFLASH_Command(SFLASH_CMD_PP, address);
+    if (st == SPI_OK) st = SPI_TransferHold(sflash_dev, data, NULL, length, true);
+    return st;
+}
+
+/**
+ * @brief Lanza el borrado del sector de 4 KB que contiene 'address'
+ */
+SPI_Status_t SFLASH_EraseSector(uint32_t address) {
+    SPI_Status_t st = _SFLASH_WriteEnable();
+
+    if (st == SPI_OK) st = _SFLASH_Command(SFLASH_CMD_SE, address & ~(SFLASH_SECTOR_SIZE - 1u));
+    if (st == SPI_OK) SPI_Deselect(sflash_dev);
+    return st;
+}
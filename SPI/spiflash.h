@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * spiflash.h - Memoria flash NOR SPI (serie 25xx) sobre la librería SPI
+ * 
+ * Descripción: Comandos básicos de las flash NOR SPI habituales (W25Qxx,
+ *              SST26, AT25SF, MX25...): lectura, programación de página,
+ *              borrado de sector de 4 KB y estado.
+ * 
+ * Características:
+ * - Programación y borrado no bloqueantes: el comando se lanza y el
+ *   llamador consulta SFLASH_IsBusy() antes del siguiente
+ * - Lectura continua de cualquier longitud
+ * - Identificación JEDEC
+ * 
+ * Nota:
+ * - Una programación no debe cruzar el límite de página (SFLASH_PAGE_SIZE).
+ * - Los tiempos típicos: página ~0.7 ms, sector 4 KB ~50..400 ms.
+ * 
+ ******************************************************************************/
+
+#ifndef SPIFLASH_H
+#define SPIFLASH_H
+
+#include "spi.h"
+
+// =============================================================================
+// DEFINICIONES DE CONFIGURACIÓN
+// =============================================================================
+
+#define SFLASH_PAGE_SIZE        256u
+#define SFLASH_SECTOR_SIZE      4096UL
+
+// Comandos
+#define SFLASH_CMD_WREN         0x06u
+#define SFLASH_CMD_RDSR         0x05u
+#define SFLASH_CMD_READ         0x03u
+#define SFLASH_CMD_PP           0x02u
+#define SFLASH_CMD_SE           0x20u
+#define SFLASH_CMD_JEDEC_ID     0x9Fu
+
+// Bits del registro de estado
+#define SFLASH_SR_BUSY          0x01u
+#define SFLASH_SR_WEL           0x02u
+
+// =============================================================================
+// PROTOTIPOS DE FUNCIONES
+// =============================================================================
+
+void SFLASH_Init(const SPI_Device_t *device);
+uint32_t SFLASH_ReadId(void);
+uint8_t SFLASH_ReadStatus(void);
+bool SFLASH_IsBusy(void);
+bool SFLASH_WaitReady(uint16_t timeout_ms);
+
+SPI_Status_t SFLASH_Read(uint32_t address, uint8_t *buffer, uint16_t length);
+SPI_Status_t SFLASH_ProgramPage(uint32_t address, const uint8_t *data, uint16_t length);
+SPI_Status_t SFLASH_EraseSector(uint32_t address);
+
+#endif /* SPIFLASH_H */
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * spimain.c - Ejemplos de uso de la librería SPI
+ * 
+ * Ejemplos con un ADC externo de 12 bits (MCP3201), un DAC de 12 bits
+ * (MCP4921, palabras de 16 bits) y la cola de transacciones para mover
+ * bloques de muestras sin bloquear el bucle principal.
+ * 
+ * Requisitos:
+ *  - Añade config.h/config.c, irq.h/irq.c, critical.h, pins.h/pins.c,
+ *    pps.h/pps.c, board.h/board.c y spi.h/spi.c al proyecto.
+ *  - SYSTEM_Initialize() aplica los remapeos PPS de SPI1 (board.c).
+ * 
+ ******************************************************************************/
+
+#include "config.h"
+#include "board.h"
+#include "spi.h"
+#include <stdio.h>
+#include <string.h>
+
+// ADC externo MCP3201: modo 0, hasta 1.6 MHz a 5 V
+static const SPI_Device_t adc_ext = {
+    .speed = 1600000UL,
+    .mode = SPI_MODE_0,
+    .word16 = true,
+    .sample_end = false,
+    .cs_port = BOARD_SPI_CS_PORT,
+    .cs_bit = BOARD_SPI_CS_BIT
+};
+
+// DAC MCP4921: modo 0, hasta 20 MHz (limitado a SPI_MAX_CLOCK_HZ)
+static const SPI_Device_t dac_ext = {
+    .speed = SPI_MAX_CLOCK_HZ,
+    .mode = SPI_MODE_0,
+    .word16 = true,
+    .sample_end = false,
+    .cs_port = BOARD_DAC_CS_PORT,
+    .cs_bit = BOARD_DAC_CS_BIT
+};
+
+// =============================================================================
+// EJEMPLO 1: LECTURA BLOQUEANTE DE UN ADC EXTERNO
+// =============================================================================
+
+void ejemplo_adc_externo(void) {
+    printf("=== Ejemplo 1: ADC externo (MCP3201) ===\n");
+    
+    uint8_t rx[2];
+    
+    if (SPI_Read(&adc_ext, rx, 2) == SPI_OK) {
+        // 2 bits nulos + 12 bits de dato + 1 bit de relleno
+        uint16_t valor = (uint16_t)((((uint16_t)rx[0] << 8) | rx[1]) >> 1) & 0x0FFF;
+        printf("Lectura: %u (SCK %lu Hz)\n", valor, (unsigned long)SPI_GetClock());
+    } else {
+        printf("Error de lectura SPI\n");
+    }
+}
+
+// =============================================================================
+// EJEMPLO 2: ESCRITURA EN DAC CON PALABRAS DE 16 BITS
+// =============================================================================
+
+void ejemplo_dac(uint16_t valor) {
+    printf("\n=== Ejemplo 2: DAC (MCP4921) ===\n");
+    
+    // Comando: canal A, buffer, ganancia 1x, salida activa
+    uint16_t palabra = (uint16_t)(0x3000u | (valor & 0x0FFFu));
+    uint8_t tx[2] = { (uint8_t)(palabra >> 8), (uint8_t)palabra };
+    
+    if (SPI_Write(&dac_ext, tx, 2) == SPI_OK) {
+        printf("DAC = %u\n", valor & 0x0FFFu);
+    }
+}
+
+// =============================================================================
+// EJEMPLO 3: COLA DE TRANSACCIONES (BLOQUE DE MUESTRAS)
+// =============================================================================
+
+#define BLOQUE_MUESTRAS 32
+
+static uint8_t bloque_rx[2 * BLOQUE_MUESTRAS];
+static SPI_Transaction_t muestras[BLOQUE_MUESTRAS];
+static volatile uint8_t completadas = 0;
+
+// Llamado desde la ISR al terminar cada transacción
+static void muestra_lista(SPI_Transaction_t *t) {
+    (void)t;
+    completadas++;
+}
+
+void ejemplo_cola(void) {
+    printf("\n=== Ejemplo 3: Cola de transacciones ===\n");
+    
+    uint8_t encoladas = 0;
+    completadas = 0;
+    
+    // Una transacción por muestra (cada una con su flanco de CS)
+    while (encoladas < BLOQUE_MUESTRAS) {
+        SPI_Transaction_t *t = &muestras[encoladas];
+        t->device = &adc_ext;
+        t->tx = NULL;
+        t->rx = &bloque_rx[2 * encoladas];
+        t->length = 2;
+        t->keep_cs = false;
+        t->callback = muestra_lista;
+        
+        if (SPI_Submit(t) == SPI_PENDING) {
+            encoladas++;
+        }
+        // Cola llena: aquí el bucle principal podría hacer otro trabajo
+    }
+    
+    if (SPI_WaitTransaction(&muestras[BLOQUE_MUESTRAS - 1], 100) == SPI_OK) {
+        printf("%u muestras recibidas, overruns: %u\n",
+               completadas, SPI_GetOverrunCount());
+    } else {
+        printf("Timeout esperando la cola SPI\n");
+    }
+}
+
+int main(void) {
+    // Inicializar sistema (incluye los remapeos PPS de la placa)
+    SYSTEM_Initialize();
+    SPI_Init();
+    
+    printf("\n========== DEMO LIBRERÍA SPI ==========\n");
+    
+    ejemplo_adc_externo();
+    ejemplo_dac(2048);
+    ejemplo_cola();
+    
+    printf("\n========== FIN DE DEMO ==========\n");
+    
+    while(1) {
+        // Mantener programa activo
+    }
+    
+    return 0;
+}
+
+// =============================================================================
+// INTERRUPCIONES
+// =============================================================================
+
+// Interrupción SPI1: fin de palabra
+void __attribute__((interrupt, no_auto_psv)) _SPI1Interrupt(void) {
+    SPI_ISR_Handler();
+}